@@ -22,6 +22,8 @@
 #define need_val_residual {true, true}
 #define need_grad_residual {true, true}
 
+#define need_q_point_loc false
+
 // =================================================================================
 // Define the model parameters and the residual equations
 // =================================================================================
@@ -46,25 +48,15 @@
 //anisotropy parameters
 #define epsilonM 0.06
 
-//current anisotropy has 4-fold or octahedral symmetry
-#if problemDIM==1
-#define gamma 1.0
-#elif problemDIM==2
-//writing out powers instead of using std::pow(double,double) for performance reasons
-#define gamma (1.0+epsilonM*(4.0*(normal[0]*normal[0]*normal[0]*normal[0]+normal[1]*normal[1]*normal[1]*normal[1])-3.0))
-#else
-#define gamma (1.0+epsilonM*(4.0*(normal[0]*normal[0]*normal[0]*normal[0]+normal[1]*normal[1]*normal[1]*normal[1]+normal[2]*normal[2]*normal[2]*normal[2])-3.0))
-#endif
-
-//derivatives of gamma with respect to the components of the unit normal
-#define gammanx (epsilonM*16.0*normal[0]*normal[0]*normal[0])
-#define gammany (epsilonM*16.0*normal[1]*normal[1]*normal[1])
-#define gammanz (epsilonM*16.0*normal[2]*normal[2]*normal[2])
+//form of the anisotropy of the interfacial energy gamma(normal): 4-fold in 2D and octahedral in 3D
+//(the other forms are listed in src/models/anisotropy/interfacialAnisotropy.h)
+#define anisotropyForm cubicAnisotropy<dim>
+#define anisotropyParameters epsilonM
 
 // Allen-Cahn mobility
 #define MnV 0.1
 // anisotropic Allen-Cahn mobility
-//#define MnV (1.0/(gamma*gamma+1e-10))
+//#define MnV (1.0/(gamma_value*gamma_value+1e-10))
 
 //define required residuals (aniso defined in model)
 #define rcV   ( c )
@@ -96,27 +88,9 @@ scalarvalueType n = modelVariablesList[1].scalarValue;
 scalargradType nx = modelVariablesList[1].scalarGrad;
 
 // anisotropy code
-scalarvalueType normgradn = std::sqrt(nx.norm_square());
-scalargradType normal = nx/(normgradn+constV(1.0e-16));
-scalarvalueType gamma_scl = gamma;
-scalargradType aniso;
-#if problemDIM==1
-      aniso = gamma_scl*gamma_scl*nx
-#else
-      scalargradType dgammadnorm;
-      dgammadnorm[0]=gammanx;
-      dgammadnorm[1]=gammany;
-#if problemDIM>2
-      dgammadnorm[2]=gammanz;
-#endif
-      for (unsigned int i=0; i<problemDIM; ++i){
-	      for (unsigned int j=0; j<problemDIM; ++j){
-		      aniso[i] += -normal[i]*normal[j]*dgammadnorm[j];
-		      if (i==j) aniso[i] +=dgammadnorm[j];
-	      }
-      }
-      aniso = gamma_scl*(aniso*normgradn+gamma_scl*nx);
-#endif
+static const anisotropyForm anisotropy(anisotropyParameters);
+scalarvalueType gamma_value;
+scalargradType aniso = anisotropicGradientFlux(anisotropy, nx, gamma_value);
 // end anisotropy code
 
 modelResidualsList[0].scalarValueResidual = rcV;
@@ -155,14 +129,16 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList,
     const dealii::VectorizedArray<double> & JxW_value,
-    dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+    dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+    std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 scalarvalueType total_energy_density = constV(0.0);
 
@@ -177,20 +153,16 @@ scalargradType nx = modelVarList[1].scalarGrad;
 scalarvalueType f_chem = (constV(1.0)-hV)*faV + hV*fbV;
 
 // anisotropy code
-scalargradType normal = nx/(std::sqrt(nx.norm_square())+constV(1.0e-16));
-scalarvalueType f_grad = constV(0.5)*gamma*gamma*nx*nx;
+static const anisotropyForm anisotropy(anisotropyParameters);
+scalarvalueType f_grad = anisotropicGradientEnergy(anisotropy, nx);
 // end anisotropy code
 total_energy_density = f_chem + f_grad;
 
-// Loop to step through each element of the vectorized arrays. Working with deal.ii
-// developers to see if there is a more elegant way to do this.
-assembler_lock.acquire ();
+// Add the weighted energy densities to their components, only at the points where c > 1.0e-10
 for (unsigned i=0; i<c.n_array_elements;i++){
   if (c[i] > 1.0e-10){
-	  this->energy+=total_energy_density[i]*JxW_value[i];
-	  this->energy_components[0]+= f_chem[i]*JxW_value[i];
-	  this->energy_components[1]+= f_grad[i]*JxW_value[i];
+	  energyComponents[0][i] += f_chem[i]*JxW_value[i];
+	  energyComponents[1][i] += f_grad[i]*JxW_value[i];
   }
 }
-assembler_lock.release ();
 }
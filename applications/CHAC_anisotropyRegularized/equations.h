@@ -22,6 +22,8 @@
 #define need_val_residual {true, true, false}
 #define need_grad_residual {true, true, true}
 
+#define need_q_point_loc false
+
 // =================================================================================
 // Define the model parameters and the residual equations
 // =================================================================================
@@ -47,27 +49,16 @@
 #define epsilonM 0.2
 #define delta2 1.0
 
-//anisotropy gamma as a function of the components of the normal vector
-//current anisotropy has 4-fold or octahedral symmetry
-#if problemDIM==1
-#define gamma 1.0
-#elif problemDIM==2
-//writing out powers instead of using std::pow(double,double) for performance reasons
-#define gamma (1.0+epsilonM*(4.0*(normal[0]*normal[0]*normal[0]*normal[0]+normal[1]*normal[1]*normal[1]*normal[1])-3.0))
-#else
-#define gamma (1.0+epsilonM*(4.0*(normal[0]*normal[0]*normal[0]*normal[0]+normal[1]*normal[1]*normal[1]*normal[1]+normal[2]*normal[2]*normal[2]*normal[2])-3.0))
-#endif
-
-//derivatives of gamma with respect to the components of the unit normal
-#define gammanx (epsilonM*16.0*normal[0]*normal[0]*normal[0])
-#define gammany (epsilonM*16.0*normal[1]*normal[1]*normal[1])
-#define gammanz (epsilonM*16.0*normal[2]*normal[2]*normal[2])
+//form of the anisotropy of the interfacial energy gamma(normal): 4-fold in 2D and octahedral in 3D
+//(the other forms are listed in src/models/anisotropy/interfacialAnisotropy.h)
+#define anisotropyForm cubicAnisotropy<dim>
+#define anisotropyParameters epsilonM
 
 //Allen-Cahn mobility (isotropic)
 #define MnV 0.1
 
 //Allen-Cahn mobility (anisotropic)
-//#define MnV (1.0/(gamma*gamma+1e-10))
+//#define MnV (1.0/(gamma_value*gamma_value+1e-10))
 
 //define required residuals (aniso defined in model)
 #define rbiharmV constV(0.0)
@@ -104,27 +95,9 @@ scalargradType nx = modelVariablesList[1].scalarGrad;
 scalargradType biharmx = modelVariablesList[2].scalarGrad;
 
 // anisotropy code
-scalarvalueType normgradn = std::sqrt(nx.norm_square());
-scalargradType normal = nx/(normgradn+constV(1.0e-16));
-scalarvalueType gamma_scl = gamma;
-scalargradType aniso;
-#if problemDIM==1
-      aniso = gamma_scl*gamma_scl*nx
-#else
-      scalargradType dgammadnorm;
-      dgammadnorm[0]=gammanx;
-      dgammadnorm[1]=gammany;
-#if problemDIM>2
-      dgammadnorm[2]=gammanz;
-#endif
-      for (unsigned int i=0; i<problemDIM; ++i){
-	      for (unsigned int j=0; j<problemDIM; ++j){
-		      aniso[i] += -normal[i]*normal[j]*dgammadnorm[j];
-		      if (i==j) aniso[i] +=dgammadnorm[j];
-	      }
-      }
-      aniso = gamma_scl*(aniso*normgradn+gamma_scl*nx);
-#endif
+static const anisotropyForm anisotropy(anisotropyParameters);
+scalarvalueType gamma_value;
+scalargradType aniso = anisotropicGradientFlux(anisotropy, nx, gamma_value);
 // end anisotropy code
 
 modelResidualsList[0].scalarValueResidual = rcV;
@@ -164,14 +137,16 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList,
     const dealii::VectorizedArray<double> & JxW_value,
-    dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+    dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+    std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 scalarvalueType total_energy_density = constV(0.0);
 
@@ -188,21 +163,18 @@ scalarvalueType biharm = modelVarList[2].scalarValue;
 
 scalarvalueType f_chem = (constV(1.0)-hV)*faV + hV*fbV;
 
-scalargradType normal = nx/(std::sqrt(nx.norm_square())+constV(1.0e-16));
-scalarvalueType f_grad = constV(0.5)*gamma*gamma*nx*nx;
+static const anisotropyForm anisotropy(anisotropyParameters);
+scalarvalueType f_grad = anisotropicGradientEnergy(anisotropy, nx);
 scalarvalueType f_reg = constV(0.5)*delta2*biharm*biharm;
 
 total_energy_density = f_chem + f_grad + f_reg;
 
-assembler_lock.acquire ();
+// Add the weighted energy densities to their components, only at the points where c > 1.0e-10
 for (unsigned i=0; i<c.n_array_elements;i++){
-  // For some reason, some of the values in this loop
   if (c[i] > 1.0e-10){
-	  this->energy+=total_energy_density[i]*JxW_value[i];
-	  this->energy_components[0]+= f_chem[i]*JxW_value[i];
-	  this->energy_components[1]+= f_grad[i]*JxW_value[i];
-	  this->energy_components[2]+= f_reg[i]*JxW_value[i];
+	  energyComponents[0][i] += f_chem[i]*JxW_value[i];
+	  energyComponents[1][i] += f_grad[i]*JxW_value[i];
+	  energyComponents[2][i] += f_reg[i]*JxW_value[i];
   }
 }
-assembler_lock.release ();
 }
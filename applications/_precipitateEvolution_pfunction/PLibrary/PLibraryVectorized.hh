@@ -0,0 +1,224 @@
+// Vectorized PLibrary generated by createPLib.py (see createPLibVectorized.py)
+// Do not edit by hand, regenerate instead.
+
+#ifndef PLIBRARY_VECTORIZED_HH
+#define PLIBRARY_VECTORIZED_HH
+
+#include <cmath>
+#include <string>
+#include <stdexcept>
+#include <deal.II/base/vectorization.h>
+
+namespace PRISMS
+{
+    namespace PLibraryVectorized
+    {
+        typedef dealii::VectorizedArray<double> vdouble;
+
+        // Function checked out by name at setup, as direct pointers to the evaluation functions
+        struct PVectorizedFunction
+        {
+            std::string name;
+            unsigned int size;
+            vdouble (*value)(const vdouble var[]);
+            void (*eval)(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[]);
+        };
+
+        // pfunct_faV(c) = 1.3687*c**4 - 2.7375*c**3 + 5.1622*c**2 - 4.776*c - 1.6704
+        struct pfunct_faV
+        {
+            static const unsigned int size = 1;
+
+            static inline vdouble value(const vdouble var[])
+            {
+                const vdouble &c = var[0];
+                return ((1.3687*(c*c*c*c)) + (-2.7375*(c*c*c)) + (5.1622*(c*c)) + (-4.776*c) + -1.6704);
+            }
+
+            static inline vdouble grad_0(const vdouble var[])
+            {
+                const vdouble &c = var[0];
+                return ((5.4748*(c*c*c)) + (-8.212499999999999*(c*c)) + (10.3244*c) + -4.776);
+            }
+
+            static inline vdouble hess_0_0(const vdouble var[])
+            {
+                const vdouble &c = var[0];
+                return ((16.4244*(c*c)) + (-16.424999999999997*c) + 10.3244);
+            }
+
+            // value, gradient and Hessian (row major) in one evaluation
+            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])
+            {
+                const vdouble &c = var[0];
+                const vdouble tmp0 = (c*c);
+                const vdouble tmp1 = (c*c*c);
+                value = ((1.3687*(c*c*c*c)) + (-4.776*c) + (5.1622*tmp0) + (-2.7375*tmp1) + -1.6704);
+                grad[0] = ((10.3244*c) + (-8.212499999999999*tmp0) + (5.4748*tmp1) + -4.776);
+                hess[0] = ((-16.424999999999997*c) + (16.4244*tmp0) + 10.3244);
+            }
+        };
+
+        // pfunct_fbV(c) = 5.0*c**2 - 5.9746*c - 1.5924
+        struct pfunct_fbV
+        {
+            static const unsigned int size = 1;
+
+            static inline vdouble value(const vdouble var[])
+            {
+                const vdouble &c = var[0];
+                return ((5.0*(c*c)) + (-5.9746*c) + -1.5924);
+            }
+
+            static inline vdouble grad_0(const vdouble var[])
+            {
+                const vdouble &c = var[0];
+                return ((10.0*c) + -5.9746);
+            }
+
+            static inline vdouble hess_0_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(10.0);
+            }
+
+            // value, gradient and Hessian (row major) in one evaluation
+            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])
+            {
+                const vdouble &c = var[0];
+                value = ((5.0*(c*c)) + (-5.9746*c) + -1.5924);
+                grad[0] = ((10.0*c) + -5.9746);
+                hess[0] = dealii::make_vectorized_array(10.0);
+            }
+        };
+
+        // pfunct_McV(c) = 1.00000000000000
+        struct pfunct_McV
+        {
+            static const unsigned int size = 1;
+
+            static inline vdouble value(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(1.0);
+            }
+
+            static inline vdouble grad_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            static inline vdouble hess_0_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            // value, gradient and Hessian (row major) in one evaluation
+            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])
+            {
+                value = dealii::make_vectorized_array(1.0);
+                grad[0] = dealii::make_vectorized_array(0.0);
+                hess[0] = dealii::make_vectorized_array(0.0);
+            }
+        };
+
+        // pfunct_Mn1V(n1) = 100.000000000000
+        struct pfunct_Mn1V
+        {
+            static const unsigned int size = 1;
+
+            static inline vdouble value(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(100.0);
+            }
+
+            static inline vdouble grad_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            static inline vdouble hess_0_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            // value, gradient and Hessian (row major) in one evaluation
+            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])
+            {
+                value = dealii::make_vectorized_array(100.0);
+                grad[0] = dealii::make_vectorized_array(0.0);
+                hess[0] = dealii::make_vectorized_array(0.0);
+            }
+        };
+
+        // pfunct_Mn2V(n2) = 100.000000000000
+        struct pfunct_Mn2V
+        {
+            static const unsigned int size = 1;
+
+            static inline vdouble value(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(100.0);
+            }
+
+            static inline vdouble grad_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            static inline vdouble hess_0_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            // value, gradient and Hessian (row major) in one evaluation
+            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])
+            {
+                value = dealii::make_vectorized_array(100.0);
+                grad[0] = dealii::make_vectorized_array(0.0);
+                hess[0] = dealii::make_vectorized_array(0.0);
+            }
+        };
+
+        // pfunct_Mn3V(n3) = 100.000000000000
+        struct pfunct_Mn3V
+        {
+            static const unsigned int size = 1;
+
+            static inline vdouble value(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(100.0);
+            }
+
+            static inline vdouble grad_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            static inline vdouble hess_0_0(const vdouble var[])
+            {
+                return dealii::make_vectorized_array(0.0);
+            }
+
+            // value, gradient and Hessian (row major) in one evaluation
+            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])
+            {
+                value = dealii::make_vectorized_array(100.0);
+                grad[0] = dealii::make_vectorized_array(0.0);
+                hess[0] = dealii::make_vectorized_array(0.0);
+            }
+        };
+
+        // Resolve a function by name into direct function pointers (once, at setup)
+        inline void checkout(std::string name, PVectorizedFunction &func)
+        {
+            if( name == "pfunct_faV") { func.name = name; func.size = pfunct_faV::size; func.value = &pfunct_faV::value; func.eval = &pfunct_faV::eval; return;}
+            if( name == "pfunct_fbV") { func.name = name; func.size = pfunct_fbV::size; func.value = &pfunct_fbV::value; func.eval = &pfunct_fbV::eval; return;}
+            if( name == "pfunct_McV") { func.name = name; func.size = pfunct_McV::size; func.value = &pfunct_McV::value; func.eval = &pfunct_McV::eval; return;}
+            if( name == "pfunct_Mn1V") { func.name = name; func.size = pfunct_Mn1V::size; func.value = &pfunct_Mn1V::value; func.eval = &pfunct_Mn1V::eval; return;}
+            if( name == "pfunct_Mn2V") { func.name = name; func.size = pfunct_Mn2V::size; func.value = &pfunct_Mn2V::value; func.eval = &pfunct_Mn2V::eval; return;}
+            if( name == "pfunct_Mn3V") { func.name = name; func.size = pfunct_Mn3V::size; func.value = &pfunct_Mn3V::value; func.eval = &pfunct_Mn3V::eval; return;}
+            throw std::runtime_error( "PVectorizedFunction " + name + " was not found in the PLibraryVectorized");
+        }
+    }
+}
+
+#endif
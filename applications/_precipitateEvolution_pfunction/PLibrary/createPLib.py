@@ -39,7 +39,7 @@ def write_pfunction(f_name, var, var_name, expression, need_grad, need_hess, dir
 def write_plibrary(data_type, pfunction_dir, plibrary_dir):
 	l_writer_string = 'lw -d ' + pfunction_dir + ' -v "'+ data_type + '" -l '+ plibrary_dir +' -c --include "<deal.II/base/vectorization.h>"'
 	
-	print l_writer_string
+	print(l_writer_string)
 	
 	subprocess.call([l_writer_string],shell=True)
 
@@ -82,5 +82,38 @@ write_pfunction("pfunct_Mn3V", "n3", "concentration", Mn[2], False, False, dir)
 # Write the PLibrary
 write_plibrary("dealii::VectorizedArray<double>", dir, dir)
 
+# Write the vectorized PLibrary of the same functions, used in the residuals (see createPLibVectorized.py)
+import createPLibVectorized
 
+vectorized_functions = [{'name': 'pfunct_faV', 'var': ['c'], 'expression': fa_coeffs[0]+'*c^4 +'+fa_coeffs[1]+'*c^3 + '+fa_coeffs[2]+'*c^2 +'+fa_coeffs[3]+'*c +'+fa_coeffs[4]},
+						{'name': 'pfunct_fbV', 'var': ['c'], 'expression': fb_coeffs[0]+'*c^2 +'+fb_coeffs[1]+'*c +'+fb_coeffs[2]},
+						{'name': 'pfunct_McV', 'var': ['c'], 'expression': Mc}]
+for i in range(1,4):
+	vectorized_functions.append({'name': 'pfunct_Mn'+str(i)+'V', 'var': ['n'+str(i)], 'expression': Mn[i-1]})
 
+createPLibVectorized.write_vectorized_plibrary(vectorized_functions, 'PLibraryVectorized.hh', dir)
+
+
+
+
+# -----------------------------------------------------------------------------------------
+# Generate the residual equations of the chemical part of the model (optional)
+# -----------------------------------------------------------------------------------------
+# Run as "python createPLib.py --residuals" to also write residuals_generated.h, with the
+# residualRHS, residualLHS and energyDensity functions derived from the free energies and
+# mobilities above (see createResiduals.py, requires sympy)
+
+if '--residuals' in sys.argv:
+	import createResiduals
+
+	fa = fa_coeffs[0]+'*c^4 +'+fa_coeffs[1]+'*c^3 + '+fa_coeffs[2]+'*c^2 +'+fa_coeffs[3]+'*c +'+fa_coeffs[4]
+	fb = fb_coeffs[0]+'*c^2 +'+fb_coeffs[1]+'*c +'+fb_coeffs[2]
+	h = '(10*n^3-15*n^4+6*n^5)'
+	sum_h = '(' + ' + '.join([h.replace('n', 'n'+str(i)) for i in range(1,4)]) + ')'
+	free_energy = '(1-' + sum_h + ')*(' + fa + ') + ' + sum_h + '*(' + fb + ')'
+
+	variables = [{'name': 'c', 'type': 'CONSERVED', 'mobility': Mc}]
+	for i in range(1,4):
+		variables.append({'name': 'n'+str(i), 'type': 'NONCONSERVED', 'mobility': Mn[i-1], 'kappa_tensor': 'Kn'+str(i)})
+
+	createResiduals.write_residuals('residuals_generated.h', variables, free_energy, dir)
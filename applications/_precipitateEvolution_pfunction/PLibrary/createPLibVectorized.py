@@ -0,0 +1,136 @@
+import sympy
+from createResiduals import cxx_code
+
+# -----------------------------------------------------------------------------------------
+# Vectorized PLibrary generator
+# -----------------------------------------------------------------------------------------
+# Writes the functions of the PLibrary as C++ over dealii::VectorizedArray<double>, from
+# the same expressions as the PFunctions written by createPLib.py. The PFunctions of the
+# IntegrationTools return a double and are called through virtual functions after a string
+# based checkout, so they only work for constants in the residuals. Here each function is a
+# struct of static inline functions of a whole VectorizedArray batch (value, gradient and
+# Hessian, separately or in one call with the common subexpressions shared), resolved at
+# compile time, and checkout() gives direct function pointers for functions selected by name
+# at setup.
+
+# -----------------------------------------------------------------------------------------
+# Function that prints the code of a scalar expression returned as a VectorizedArray
+# -----------------------------------------------------------------------------------------
+# Inputs:
+# expr 		= The sympy expression
+# names		= Map from the sympy symbols to the C++ variable names
+
+def vectorized_code(expr, names):
+	if len(expr.free_symbols) == 0:
+		return 'dealii::make_vectorized_array(' + repr(float(expr)) + ')'
+	return cxx_code(expr, names, '%s')
+
+# -----------------------------------------------------------------------------------------
+# Function that writes the vectorized PLibrary
+# -----------------------------------------------------------------------------------------
+# Inputs:
+# functions	= List of the functions, each a dictionary with the entries 'name', 'var' (list
+#			  of the variable names, in input order) and 'expression'
+# file_name	= Name of the generated header
+# dir		= Directory to write the header to
+
+def write_vectorized_plibrary(functions, file_name, dir):
+	out = []
+	out.append('// Vectorized PLibrary generated by createPLib.py (see createPLibVectorized.py)')
+	out.append('// Do not edit by hand, regenerate instead.')
+	out.append('')
+	out.append('#ifndef PLIBRARY_VECTORIZED_HH')
+	out.append('#define PLIBRARY_VECTORIZED_HH')
+	out.append('')
+	out.append('#include <cmath>')
+	out.append('#include <string>')
+	out.append('#include <stdexcept>')
+	out.append('#include <deal.II/base/vectorization.h>')
+	out.append('')
+	out.append('namespace PRISMS')
+	out.append('{')
+	out.append('    namespace PLibraryVectorized')
+	out.append('    {')
+	out.append('        typedef dealii::VectorizedArray<double> vdouble;')
+	out.append('')
+	out.append('        // Function checked out by name at setup, as direct pointers to the evaluation functions')
+	out.append('        struct PVectorizedFunction')
+	out.append('        {')
+	out.append('            std::string name;')
+	out.append('            unsigned int size;')
+	out.append('            vdouble (*value)(const vdouble var[]);')
+	out.append('            void (*eval)(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[]);')
+	out.append('        };')
+
+	for function in functions:
+		symbols = [sympy.Symbol(var) for var in function['var']]
+		local_dict = dict(zip(function['var'], symbols))
+		f = sympy.sympify(str(function['expression']), locals=local_dict, convert_xor=True)
+		n = len(symbols)
+		grad = [sympy.diff(f, symbols[i]) for i in range(n)]
+		hess = [[sympy.diff(grad[i], symbols[j]) for j in range(n)] for i in range(n)]
+
+		names = dict(zip(symbols, function['var']))
+
+		# the variables used in a list of expressions
+		def load_vars(out, exprs):
+			for i, var in enumerate(function['var']):
+				if any([symbols[i] in expr.free_symbols for expr in exprs]):
+					out.append('                const vdouble &' + var + ' = var[' + str(i) + '];')
+
+		def single_function(out, name, expr):
+			out.append('')
+			out.append('            static inline vdouble ' + name + '(const vdouble var[])')
+			out.append('            {')
+			load_vars(out, [expr])
+			out.append('                return ' + vectorized_code(expr, names) + ';')
+			out.append('            }')
+
+		out.append('')
+		out.append('        // ' + function['name'] + '(' + ', '.join(function['var']) + ') = ' + str(f))
+		out.append('        struct ' + function['name'])
+		out.append('        {')
+		out.append('            static const unsigned int size = ' + str(n) + ';')
+		single_function(out, 'value', f)
+		for i in range(n):
+			single_function(out, 'grad_' + str(i), grad[i])
+		for i in range(n):
+			for j in range(n):
+				single_function(out, 'hess_' + str(i) + '_' + str(j), hess[i][j])
+
+		# value, gradient and Hessian (row major) in one call
+		terms = [f] + grad + [hess[i][j] for i in range(n) for j in range(n)]
+		outputs = ['value'] + ['grad[' + str(i) + ']' for i in range(n)] + ['hess[' + str(i*n+j) + ']' for i in range(n) for j in range(n)]
+		replacements, reduced = sympy.cse(terms, symbols=sympy.numbered_symbols('tmp'), optimizations='basic')
+		out.append('')
+		out.append('            // value, gradient and Hessian (row major) in one evaluation')
+		out.append('            static inline void eval(const vdouble var[], vdouble &value, vdouble grad[], vdouble hess[])')
+		out.append('            {')
+		load_vars(out, terms)
+		for sym, expr in replacements:
+			names[sym] = str(sym)
+			out.append('                const vdouble ' + str(sym) + ' = ' + vectorized_code(expr, names) + ';')
+		for output, expr in zip(outputs, reduced):
+			out.append('                ' + output + ' = ' + vectorized_code(expr, names) + ';')
+		out.append('            }')
+		out.append('        };')
+
+	# checkout by name
+	out.append('')
+	out.append('        // Resolve a function by name into direct function pointers (once, at setup)')
+	out.append('        inline void checkout(std::string name, PVectorizedFunction &func)')
+	out.append('        {')
+	for function in functions:
+		out.append('            if( name == "' + function['name'] + '") { func.name = name; func.size = ' + function['name'] + '::size; func.value = &'
+				   + function['name'] + '::value; func.eval = &' + function['name'] + '::eval; return;}')
+	out.append('            throw std::runtime_error( "PVectorizedFunction " + name + " was not found in the PLibraryVectorized");')
+	out.append('        }')
+	out.append('    }')
+	out.append('}')
+	out.append('')
+	out.append('#endif')
+
+	output_file = open(dir + '/' + file_name, 'w')
+	output_file.write('\n'.join(out) + '\n')
+	output_file.close()
+	print('createPLibVectorized: wrote ' + dir + '/' + file_name + ' (' + str(len(functions)) + ' functions)')
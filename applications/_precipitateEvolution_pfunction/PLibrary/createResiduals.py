@@ -0,0 +1,229 @@
+import sys
+try:
+	import sympy
+except ImportError:
+	sys.exit('createResiduals: the symbolic generators require sympy, install it with "pip install sympy"')
+
+# -----------------------------------------------------------------------------------------
+# Symbolic residual generator for generalizedProblem
+# -----------------------------------------------------------------------------------------
+# Generates residualRHS, residualLHS and energyDensity for a model of conserved
+# (Cahn-Hilliard) and non-conserved (Allen-Cahn) scalar fields from the expressions of the
+# homogeneous free energy and the mobilities. The derivatives of the free energy are taken
+# symbolically, common subexpressions of all the scalar terms are eliminated, and the result
+# is written as C++ over dealii::VectorizedArray<double>. The generated file replaces the
+# hand-written residual functions in equations.h (the variable list and the flags are still
+# declared in equations.h).
+#
+# Conserved fields have no gradient energy (as in the precipitate model), so their residual is
+# only the flux -dt*M*grad(df/dc), with grad(df/dc) expanded by the chain rule in the
+# gradients of all the fields. Non-conserved fields evolve as n-dt*M*df/dn, with the gradient
+# term -dt*M*K*grad(n), where K is a scalar expression or the name of a double[3][3] array
+# declared in equations.h (e.g. Kn1).
+#
+# Requirements: sympy (not distributed with PRISMS-PF, install it with "pip install sympy").
+
+# Functions of VectorizedArray<double> provided by deal.II
+vectorized_functions = {'exp': 'std::exp', 'log': 'std::log', 'sqrt': 'std::sqrt',
+						'sin': 'std::sin', 'cos': 'std::cos', 'tan': 'std::tan', 'Abs': 'std::abs'}
+
+# -----------------------------------------------------------------------------------------
+# Function that prints a sympy expression as C++ code over VectorizedArray<double>
+# -----------------------------------------------------------------------------------------
+# Inputs:
+# expr 		= The sympy expression
+# names		= Map from the sympy symbols to the C++ variable names
+# constant	= Format of the numbers (by default constV, plain doubles also work in the
+#			  arithmetic of VectorizedArray<double>)
+
+def cxx_code(expr, names, constant='constV(%s)'):
+	if expr.is_Symbol:
+		return names[expr]
+	if expr.is_Number:
+		return constant % repr(float(expr))
+	if expr.is_Add:
+		terms = [cxx_code(arg, names, constant) for arg in expr.as_ordered_terms()]
+		return '(' + ' + '.join(terms) + ')'
+	if expr.is_Mul:
+		coeff, factors = expr.as_coeff_mul()
+		numerator = []
+		denominator = []
+		for factor in factors:
+			if factor.is_Pow and factor.exp.is_Integer and factor.exp < 0:
+				denominator.append(cxx_code(factor.base**(-factor.exp), names, constant))
+			else:
+				numerator.append(cxx_code(factor, names, constant))
+		if coeff == -1:
+			code = '-'
+		elif coeff != 1:
+			code = cxx_code(coeff, names, constant) + '*'
+		else:
+			code = ''
+		if len(numerator) == 0:
+			numerator.append(constant % '1.0')
+		code += '*'.join(numerator)
+		if len(denominator) > 0:
+			code += '/(' + '*'.join(denominator) + ')'
+		return '(' + code + ')'
+	if expr.is_Pow:
+		base = cxx_code(expr.base, names, constant)
+		if expr.exp.is_Integer and expr.exp > 0:
+			return '(' + '*'.join([base]*int(expr.exp)) + ')'
+		if expr.exp.is_Integer and expr.exp < 0:
+			return '(' + constant % '1.0' + '/(' + '*'.join([base]*int(-expr.exp)) + '))'
+		if expr.exp == sympy.Rational(1,2):
+			return 'std::sqrt(' + base + ')'
+		if expr.exp == sympy.Rational(-1,2):
+			return '(' + constant % '1.0' + '/std::sqrt(' + base + '))'
+		if expr.exp.is_Number:
+			return 'std::pow(' + base + ',' + repr(float(expr.exp)) + ')'
+		return 'std::exp(' + cxx_code(expr.exp*sympy.log(expr.base), names, constant) + ')'
+	if expr.is_Function and expr.func.__name__ in vectorized_functions:
+		return vectorized_functions[expr.func.__name__] + '(' + ', '.join([cxx_code(arg, names, constant) for arg in expr.args]) + ')'
+	raise ValueError('createResiduals: no VectorizedArray implementation for ' + str(expr))
+
+# -----------------------------------------------------------------------------------------
+# Function that writes the residual functions for generalizedProblem
+# -----------------------------------------------------------------------------------------
+# Inputs:
+# file_name		= Name of the generated header, to be included at the end of equations.h
+# variables		= List of the fields, in the order of variable_name in equations.h. Each
+#				  field is a dictionary with the entries 'name', 'type' ('CONSERVED' or
+#				  'NONCONSERVED'), 'mobility' (expression) and, for non-conserved fields,
+#				  'kappa' (expression) or 'kappa_tensor' (name of a double[3][3] array)
+# free_energy	= Expression for the homogeneous free energy density in terms of the fields
+# dir			= Directory to write the header to
+
+def write_residuals(file_name, variables, free_energy, dir):
+	symbols = [sympy.Symbol(var['name']) for var in variables]
+	local_dict = dict([(var['name'], sym) for var, sym in zip(variables, symbols)])
+	parse = lambda expression: sympy.sympify(str(expression), locals=local_dict, convert_xor=True)
+
+	f = parse(free_energy)
+
+	# Scalar terms evaluated at each quadrature point of the RHS: the first and second
+	# derivatives of the free energy and the mobilities
+	rhs_terms = []
+	mobility_index = []
+	for i, var in enumerate(variables):
+		mobility_index.append(len(rhs_terms))
+		rhs_terms.append(parse(var['mobility']))
+	derivative_index = {}
+	for i, var in enumerate(variables):
+		if var['type'] == 'CONSERVED':
+			mu = sympy.diff(f, symbols[i])
+			for j in range(len(variables)):
+				derivative_index[(i,j)] = len(rhs_terms)
+				rhs_terms.append(sympy.diff(mu, symbols[j]))
+		elif var['type'] == 'NONCONSERVED':
+			derivative_index[(i,i)] = len(rhs_terms)
+			rhs_terms.append(sympy.diff(f, symbols[i]))
+		else:
+			raise ValueError('createResiduals: field type must be CONSERVED or NONCONSERVED')
+
+	names = dict([(sym, var['name']) for var, sym in zip(variables, symbols)])
+
+	out = []
+	out.append('// Residual equations generated by createResiduals.py from the free energy')
+	out.append('// f = ' + str(f))
+	out.append('// Do not edit by hand, regenerate instead.')
+	out.append('')
+
+	# Field values and gradients
+	def load_fields(out):
+		for i, var in enumerate(variables):
+			out.append('scalarvalueType ' + var['name'] + ' = modelVariablesList[' + str(i) + '].scalarValue;')
+			out.append('scalargradType ' + var['name'] + 'x = modelVariablesList[' + str(i) + '].scalarGrad;')
+		out.append('')
+
+	# Common subexpressions and final expressions
+	def write_terms(out, terms, prefix):
+		replacements, reduced = sympy.cse(terms, symbols=sympy.numbered_symbols(prefix + '_tmp'), optimizations='basic')
+		for sym, expr in replacements:
+			names[sym] = str(sym)
+			out.append('scalarvalueType ' + str(sym) + ' = ' + cxx_code(expr, names) + ';')
+		for k, expr in enumerate(reduced):
+			out.append('scalarvalueType ' + prefix + '_' + str(k) + ' = ' + cxx_code(expr, names) + ';')
+		out.append('')
+
+	# Gradient energy flux K*grad(n) of a non-conserved field
+	def gradient_flux(out, var):
+		flux = 'K' + var['name'] + 'x'
+		out.append('scalargradType ' + flux + ';')
+		if 'kappa_tensor' in var:
+			out.append('for (unsigned int a=0; a<dim; a++){')
+			out.append('\t' + flux + '[a] = constV(0.0);')
+			out.append('\tfor (unsigned int b=0; b<dim; b++){')
+			out.append('\t\t' + flux + '[a] += constV(' + var['kappa_tensor'] + '[a][b])*' + var['name'] + 'x[b];')
+			out.append('\t}')
+			out.append('}')
+		else:
+			out.append(flux + ' = ' + cxx_code(parse(var['kappa']), names) + '*' + var['name'] + 'x;')
+		return flux
+
+	# residualRHS
+	out.append('template <int dim>')
+	out.append('void generalizedProblem<dim>::residualRHS(const std::vector<modelVariable<dim>> & modelVariablesList,')
+	out.append('\t\t\t\t\t\t\t\t\t\t\t\tstd::vector<modelResidual<dim>> & modelResidualsList,')
+	out.append('\t\t\t\t\t\t\t\t\t\t\t\tdealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) const {')
+	out.append('')
+	load_fields(out)
+	write_terms(out, rhs_terms, 'rhs')
+	for i, var in enumerate(variables):
+		name = var['name']
+		mobility = 'rhs_' + str(mobility_index[i])
+		out.append('// Residuals for ' + name)
+		if var['type'] == 'CONSERVED':
+			grad_mu = ' + '.join(['rhs_' + str(derivative_index[(i,j)]) + '*' + variables[j]['name'] + 'x' for j in range(len(variables))])
+			out.append('modelResidualsList[' + str(i) + '].scalarValueResidual = ' + name + ';')
+			out.append('modelResidualsList[' + str(i) + '].scalarGradResidual = constV(-timeStep)*' + mobility + '*(' + grad_mu + ');')
+		else:
+			flux = gradient_flux(out, var)
+			out.append('modelResidualsList[' + str(i) + '].scalarValueResidual = ' + name + ' - constV(timeStep)*' + mobility + '*rhs_' + str(derivative_index[(i,i)]) + ';')
+			out.append('modelResidualsList[' + str(i) + '].scalarGradResidual = constV(-timeStep)*' + mobility + '*' + flux + ';')
+		out.append('')
+	out.append('}')
+	out.append('')
+
+	# residualLHS (no elliptic fields in these models)
+	out.append('template <int dim>')
+	out.append('void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>> & modelVariablesList,')
+	out.append('\t\tmodelResidual<dim> & modelRes,')
+	out.append('\t\tdealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) const {')
+	out.append('')
+	out.append('}')
+	out.append('')
+
+	# energyDensity
+	out.append('template <int dim>')
+	out.append('void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVariablesList,')
+	out.append('\t\t\t\t\t\t\t\t\t\t\tconst dealii::VectorizedArray<double> & JxW_value,')
+	out.append('\t\t\t\t\t\t\t\t\t\t\tdealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,')
+	out.append('\t\t\t\t\t\t\t\t\t\t\tstd::vector<dealii::VectorizedArray<double> > & energyComponents) const {')
+	out.append('')
+	load_fields(out)
+	write_terms(out, [f], 'energy')
+	out.append('// The homogenous free energy')
+	out.append('scalarvalueType f_chem = energy_0;')
+	out.append('')
+	out.append('// The gradient free energy')
+	out.append('scalarvalueType f_grad = constV(0.0);')
+	for var in variables:
+		if var['type'] == 'NONCONSERVED':
+			flux = gradient_flux(out, var)
+			out.append('f_grad += constV(0.5)*' + var['name'] + 'x*' + flux + ';')
+	out.append('')
+	first = variables[0]['name']
+	out.append('// Add the weighted energy densities to their components, only at the points where ' + first + ' > 1.0e-10')
+	out.append('for (unsigned i=0; i<' + first + '.n_array_elements;i++){')
+	out.append('  if (' + first + '[i] > 1.0e-10){')
+	out.append('\t  energyComponents[0][i] += f_chem[i]*JxW_value[i];')
+	out.append('\t  energyComponents[1][i] += f_grad[i]*JxW_value[i];')
+	out.append('  }')
+	out.append('}')
+	out.append('}')
+
+	output_file = open(dir + '/' + file_name, 'w')
+	output_file.write('\n'.join(out) + '\n')
+	output_file.close()
+	print('createResiduals: wrote ' + dir + '/' + file_name + ' (' + str(len(rhs_terms)) + ' RHS terms)')
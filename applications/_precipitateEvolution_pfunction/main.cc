@@ -5,29 +5,24 @@
 
 //Coupled Cahn-Hilliard+Allen-Cahn+Mechanics problem headers
 
-// PLibrary includes
+// PLibrary includes (the residuals are included before the model, which expands them)
 #include "parameters.h"
+#include "../_precipitateEvolution_pfunction/PLibrary/PLibraryVectorized.hh"
+#include "../_precipitateEvolution_pfunction/residuals.h"
 #include "../../src/models/coupled/coupledCHACMechanics.h"
 #include "../_precipitateEvolution_pfunction/ICs_and_BCs.h"
-#include "../_precipitateEvolution_pfunction/parameters.h"
-#include "../_precipitateEvolution_pfunction/PLibrary/PLibrary.cc"
-#include "../_precipitateEvolution_pfunction/PLibrary/PLibrary.hh"
-#include "../_precipitateEvolution_pfunction/residuals.h"
 
 
 //main
 int main (int argc, char **argv)
 {
 
-	// Load variables from the PLibrary
-	std::string homo_free_energy_funcname = "pfunct_faV";
+	// Load the mobilities from the PLibrary (the free energies are resolved at compile time in residuals.h)
 	std::string mobility_funcname = "pfunct_McV";
-	PRISMS::PLibrary::checkout(homo_free_energy_funcname, pfunct_faV);
-	PRISMS::PLibrary::checkout("pfunct_fbV", pfunct_fbV);
-	PRISMS::PLibrary::checkout(mobility_funcname, pfunct_McV);
-	PRISMS::PLibrary::checkout("pfunct_Mn1V", pfunct_Mn1V);
-	PRISMS::PLibrary::checkout("pfunct_Mn2V", pfunct_Mn2V);
-	PRISMS::PLibrary::checkout("pfunct_Mn3V", pfunct_Mn3V);
+	PRISMS::PLibraryVectorized::checkout(mobility_funcname, pfunct_McV);
+	PRISMS::PLibraryVectorized::checkout("pfunct_Mn1V", pfunct_Mn1V);
+	PRISMS::PLibraryVectorized::checkout("pfunct_Mn2V", pfunct_Mn2V);
+	PRISMS::PLibraryVectorized::checkout("pfunct_Mn3V", pfunct_Mn3V);
 
 	Utilities::MPI::MPI_InitFinalize mpi_initialization(argc, argv,numbers::invalid_unsigned_int);
   try
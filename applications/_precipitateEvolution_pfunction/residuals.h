@@ -1,12 +1,16 @@
+// The free energies and mobilities come from the vectorized PLibrary (PLibrary/PLibraryVectorized.hh, written by
+// createPLib.py), which evaluates whole VectorizedArray batches. The free energies are resolved at compile time and
+// inlined, the mobilities are checked out by name in main() into direct function pointers.
+
 //define Cahn-Hilliard parameters (No Gradient energy)
-#define McV pfunct_McV(c)
-PRISMS::PFunction<dealii::VectorizedArray<double>, double> pfunct_McV;
+#define McV (pfunct_McV.value(&c))
+PRISMS::PLibraryVectorized::PVectorizedFunction pfunct_McV;
 
 //define Allen-Cahn parameters
-#define Mn1V pfunct_Mn1V(n1)
-#define Mn2V pfunct_Mn2V(n2)
-#define Mn3V pfunct_Mn3V(n3)
-PRISMS::PFunction<dealii::VectorizedArray<double>, double> pfunct_Mn1V, pfunct_Mn2V, pfunct_Mn3V;
+#define Mn1V (pfunct_Mn1V.value(&n1))
+#define Mn2V (pfunct_Mn2V.value(&n2))
+#define Mn3V (pfunct_Mn3V.value(&n3))
+PRISMS::PLibraryVectorized::PVectorizedFunction pfunct_Mn1V, pfunct_Mn2V, pfunct_Mn3V;
 
 double Kn1[3][3]={{0.03,0,0},{0,0.007,0},{0,0,1.0}};
 double Kn2[3][3]={{0.01275,-0.009959,0},{-0.009959,0.02425,0},{0,0,1.0}};
@@ -36,21 +40,15 @@ double sfts_const3[3][3]={{0.0225, 0.0069,0},{0.0069,0.0305,0},{0,0,-0.00270}};
 
 //define free energy expressions
 
-//#define faV (pfunct_faV(c))
-//#define facV (pfunct_faV.grad(c,0))
-//#define faccV (pfunct_faV.hess(c,0,0))
-PRISMS::PFunction<dealii::VectorizedArray<double>, double> pfunct_faV; // input order: c
-#define faV (-1.6704-4.776*c+5.1622*c*c-2.7375*c*c*c+1.3687*c*c*c*c)
-#define facV (-4.776 + 10.3244*c - 8.2125*c*c + 5.4748*c*c*c)
-#define faccV (10.3244-16.425*c+16.4244*c*c)
+// input order: c
+#define faV (PRISMS::PLibraryVectorized::pfunct_faV::value(&c))
+#define facV (PRISMS::PLibraryVectorized::pfunct_faV::grad_0(&c))
+#define faccV (PRISMS::PLibraryVectorized::pfunct_faV::hess_0_0(&c))
 
-//#define fbV pfunct_fbV(c)
-//#define fbcV pfunct_fbV.grad(c,0)
-//#define fbccV pfunct_fbV.hess(c,0,0)
-PRISMS::PFunction<dealii::VectorizedArray<double>, double> pfunct_fbV; // input order: c
-#define fbV (5.0*c*c-5.9746*c-1.5924)
-#define fbcV (10.0*c-5.9746)
-#define fbccV (10.0)
+// input order: c
+#define fbV (PRISMS::PLibraryVectorized::pfunct_fbV::value(&c))
+#define fbcV (PRISMS::PLibraryVectorized::pfunct_fbV::grad_0(&c))
+#define fbccV (PRISMS::PLibraryVectorized::pfunct_fbV::hess_0_0(&c))
 
 #define h1V (10.0*n1*n1*n1-15.0*n1*n1*n1*n1+6.0*n1*n1*n1*n1*n1)
 #define h2V (10.0*n2*n2*n2-15.0*n2*n2*n2*n2+6.0*n2*n2*n2*n2*n2)
@@ -62,11 +60,11 @@ PRISMS::PFunction<dealii::VectorizedArray<double>, double> pfunct_fbV; // input
 // Define required residuals
 #define rcV   (c)
 #define rcxTemp ( cx*((1.0-h1V-h2V-h3V)*faccV+(h1V+h2V+h3V)*fbccV) + n1x*((fbcV-facV)*hn1V) + n2x*((fbcV-facV)*hn2V) + n3x*((fbcV-facV)*hn3V) + grad_mu_el)
-#define rcxV  (constV(-timeStep*McV)*rcxTemp)
+#define rcxV  (constV(-timeStep)*McV*rcxTemp)
 
-#define rn1V   (n1-constV(timeStep*Mn1V)*((fbV-faV)*hn1V+nDependentMisfitAC1+heterMechAC1))
-#define rn2V   (n2-constV(timeStep*Mn2V)*((fbV-faV)*hn2V+nDependentMisfitAC2+heterMechAC2))
-#define rn3V   (n3-constV(timeStep*Mn3V)*((fbV-faV)*hn3V+nDependentMisfitAC3+heterMechAC3))
-#define rn1xV  (constV(-timeStep*Mn1V)*Knx1)
-#define rn2xV  (constV(-timeStep*Mn2V)*Knx2)
-#define rn3xV  (constV(-timeStep*Mn3V)*Knx3)
+#define rn1V   (n1-constV(timeStep)*Mn1V*((fbV-faV)*hn1V+nDependentMisfitAC1+heterMechAC1))
+#define rn2V   (n2-constV(timeStep)*Mn2V*((fbV-faV)*hn2V+nDependentMisfitAC2+heterMechAC2))
+#define rn3V   (n3-constV(timeStep)*Mn3V*((fbV-faV)*hn3V+nDependentMisfitAC3+heterMechAC3))
+#define rn1xV  (constV(-timeStep)*Mn1V*Knx1)
+#define rn2xV  (constV(-timeStep)*Mn2V*Knx2)
+#define rn3xV  (constV(-timeStep)*Mn3V*Knx3)
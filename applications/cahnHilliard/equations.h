@@ -22,6 +22,8 @@
 #define need_val_residual {true, true}
 #define need_grad_residual {true, true}
 
+#define need_q_point_loc false
+
 // =================================================================================
 // Define the model parameters and the residual equations
 // =================================================================================
@@ -108,14 +110,16 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVariablesList,
 											const dealii::VectorizedArray<double> & JxW_value,
-											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+											std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 scalarvalueType total_energy_density = constV(0.0);
 
 // The concentration and its derivatives (names here should match those in the macros above)
@@ -141,17 +145,13 @@ for (int i=0; i<dim; i++){
 // The total free energy
 total_energy_density = f_chem + f_grad;
 
-// Loop to step through each element of the vectorized arrays. Working with deal.ii
-// developers to see if there is a more elegant way to do this.
-assembler_lock.acquire ();
+// Add the weighted energy densities to their components, only at the points where c > 1.0e-10
 for (unsigned i=0; i<c.n_array_elements;i++){
   if (c[i] > 1.0e-10){
-	  this->energy+=total_energy_density[i]*JxW_value[i];
-	  this->energy_components[0]+= f_chem[i]*JxW_value[i];
-	  this->energy_components[1]+= f_grad[i]*JxW_value[i];
+	  energyComponents[0][i] += f_chem[i]*JxW_value[i];
+	  energyComponents[1][i] += f_grad[i]*JxW_value[i];
   }
 }
-assembler_lock.release ();
 }
 
 
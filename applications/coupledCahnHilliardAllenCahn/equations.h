@@ -22,6 +22,8 @@
 #define need_val_residual {true, true}
 #define need_grad_residual {true, true}
 
+#define need_q_point_loc false
+
 // =================================================================================
 // Define the model parameters and the residual equations
 // =================================================================================
@@ -39,23 +41,22 @@
 // Allen-Cahn gradient energy coefficient
 #define KnV 0.5
 
-// Free energy for each phase and their first and second derivatives
-#define faV (-1.6704-4.776*c+5.1622*c*c-2.7375*c*c*c+1.3687*c*c*c*c)
-#define facV (-4.776 + 10.3244*c - 8.2125*c*c + 5.4748*c*c*c)
-#define faccV (10.3244-16.425*c+16.4244*c*c)
-#define fbV (5.0*c*c-5.9746*c-1.5924)
-#define fbcV (10.0*c-5.9746)
-#define fbccV (10.0)
+// Free energy for each phase
+#define faV (-1.6704+c*(-4.776+c*(5.1622+c*(-2.7375+1.3687*c))))
+#define fbV (-1.5924+c*(-5.9746+5.0*c))
+
+// Interpolation function
+#define hV (n*n*n*(10.0+n*(-15.0+6.0*n)))
 
-// Interpolation function and its derivative
-#define hV (10.0*n*n*n-15.0*n*n*n*n+6.0*n*n*n*n*n)
-#define hnV (30.0*n*n-60.0*n*n*n+30.0*n*n*n*n)
+// Homogeneous free energy. In residualRHS it is evaluated once with the dual numbers c_d and n_d,
+// which gives its derivatives with respect to c (index 0) and n (index 1) in "f_d"
+#define fV ((1.0-hV)*faV+hV*fbV)
 
 // Residual equations
-#define muxV ( cx*((1.0-hV)*faccV+hV*fbccV) + nx*((fbcV-facV)*hnV) )
+#define muxV ( cx*f_d.hessian(0,0) + nx*f_d.hessian(0,1) )
 #define rcV   (c)
 #define rcxV  (constV(-McV*timeStep)*muxV)
-#define rnV  (n-constV(timeStep*MnV)*(fbV-faV)*hnV)
+#define rnV  (n-constV(timeStep*MnV)*f_d.gradient(1))
 #define rnxV (constV(-timeStep*KnV*MnV)*nx)
 
 // =================================================================================
@@ -81,6 +82,15 @@ scalargradType cx = modelVariablesList[0].scalarGrad;
 scalarvalueType n = modelVariablesList[1].scalarValue;
 scalargradType nx = modelVariablesList[1].scalarGrad;
 
+// The free energy with its first and second derivatives, from the concentration and the order
+// parameter as the independent variables of the dual numbers
+autoDiff::dual2<2> f_d;
+{
+autoDiff::dual2<2> c(modelVariablesList[0].scalarValue, 0);
+autoDiff::dual2<2> n(modelVariablesList[1].scalarValue, 1);
+f_d = fV;
+}
+
 // Residuals for the equation to evolve the concentration (names here should match those in the macros above)
 modelResidualsList[0].scalarValueResidual = rcV;
 modelResidualsList[0].scalarGradResidual = rcxV;
@@ -120,14 +130,16 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVariablesList,
 											const dealii::VectorizedArray<double> & JxW_value,
-											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+											std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 // The concentration and its derivatives (names here should match those in the macros above)
 scalarvalueType c = modelVariablesList[0].scalarValue;
@@ -138,7 +150,7 @@ scalarvalueType n = modelVariablesList[1].scalarValue;
 scalargradType nx = modelVariablesList[1].scalarGrad;
 
 // The homogenous free energy
-scalarvalueType f_chem = (constV(1.0)-hV)*faV + hV*fbV;
+scalarvalueType f_chem = fV;
 
 // The gradient free energy
 scalarvalueType f_grad = constV(0.5*KnV)*nx*nx;
@@ -147,17 +159,13 @@ scalarvalueType f_grad = constV(0.5*KnV)*nx*nx;
 scalarvalueType total_energy_density;
 total_energy_density = f_chem + f_grad;
 
-// Loop to step through each element of the vectorized arrays. Working with deal.ii
-// developers to see if there is a more elegant way to do this.
-assembler_lock.acquire ();
+// Add the weighted energy densities to their components, only at the points where c > 1.0e-10
 for (unsigned i=0; i<c.n_array_elements;i++){
   if (c[i] > 1.0e-10){
-	  this->energy+=total_energy_density[i]*JxW_value[i];
-	  this->energy_components[0]+= f_chem[i]*JxW_value[i];
-	  this->energy_components[1]+= f_grad[i]*JxW_value[i];
+	  energyComponents[0][i] += f_chem[i]*JxW_value[i];
+	  energyComponents[1][i] += f_grad[i]*JxW_value[i];
   }
 }
-assembler_lock.release ();
 }
 
 
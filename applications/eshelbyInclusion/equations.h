@@ -22,6 +22,8 @@
 #define need_val_residual {false}
 #define need_grad_residual {true}
 
+#define need_q_point_loc true
+
 // Flags for whether the value, gradient, and Hessian are needed in the residual eqn
 // for the left-hand-side of the iterative solver for elliptic equations
 #define need_val_LHS {false}
@@ -102,7 +104,7 @@ for (unsigned int i=0; i<dim; i++){
 }
 
 //compute stress tensor
-computeStress<dim>(CIJ_list[0], E, S);
+computeStress<dim>(stiffness_list[0], E, S);
 
 //compute residual
 for (unsigned int i=0; i<dim; i++){
@@ -148,7 +150,7 @@ for (unsigned int i=0; i<dim; i++){
 }
 
 //compute stress tensor
-computeStress<dim>(CIJ_list[0], E, S);
+computeStress<dim>(stiffness_list[0], E, S);
 
 //compute residual
 for (unsigned int i=0; i<dim; i++){
@@ -168,12 +170,13 @@ modelRes.vectorGradResidual = Rux;
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
-void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value, dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value, dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc, std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 	//u
 	vectorgradType ux = modelVarList[0].vectorGrad;
@@ -209,7 +212,7 @@ void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>
 	}
 
 	//compute stress tensor
-	computeStress<dim>(CIJ_list[0], E, S);
+	computeStress<dim>(stiffness_list[0], E, S);
 
 	scalarvalueType f_el = constV(0.0);
 
@@ -219,16 +222,12 @@ void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>
 	  }
 	}
 
-	// Loop to step through each element of the vectorized arrays. Working with deal.ii
-	// developers to see if there is a more elegant way to do this.
-	assembler_lock.acquire ();
+	// Add the weighted energy densities to their components, only at the points where f_el > 1.0e-10
 	for (unsigned i=0; i<f_el.n_array_elements;i++){
-	  // For some reason, some of the values in this loop
 	  if (f_el[i] > 1.0e-10){
-		  this->energy+=f_el[i]*JxW_value[i];
+		  energyComponents[2][i] += f_el[i]*JxW_value[i];
 	  }
 	}
-	assembler_lock.release ();
 
 
 }
@@ -22,6 +22,30 @@
 #define need_val_residual {true,true,true,true,true,true,true,true,true,true}
 #define need_grad_residual {true,true,true,true,true,true,true,true,true,true}
 
+#define need_q_point_loc false
+
+// The order parameters are stored together as the components of a single field
+// (one DoFHandler and one FEEvaluation object for all of them): the packed group
+// is the num_packed_var variables starting at packed_var_first, which must be
+// SCALAR PARABOLIC variables with the same flags. They are still accessed as
+// separate variables in the residual equations
+#define packed_var_first 0
+#define num_packed_var 10
+
+// Only a few order parameters are nonzero at any point (three at a triple
+// junction in 2D). With num_active_packed_var set, in each cell the residual
+// equations get the num_active_packed_var order parameters of the packed group
+// above activePackedTolerance (completed with the largest other ones), as the
+// first variables of the group, and the other order parameters are left
+// unchanged. Cells where more order parameters are above the tolerance get all
+// of them. This saves work in the residual equations only: all the order
+// parameters are still stored at every node. It is off here until validated
+// against the results with all the order parameters; uncomment the line below
+// to opt in. The number of order parameters passed is the numActive member of
+// the first variable of the group (num_packed_var if off), so the loops over
+// the order parameters below are the same either way
+// #define num_active_packed_var 4
+
 // =================================================================================
 // Define the model parameters and the residual equations
 // =================================================================================
@@ -59,14 +83,20 @@ void generalizedProblem<dim>::residualRHS(const std::vector<modelVariable<dim>>
 dealii::VectorizedArray<double> fnV = constV(0.0);
 scalargradType nx;
 
-for (unsigned int i=0; i<num_var; i++){
+// Order parameters passed in this cell (see num_active_packed_var)
+const unsigned int num_active = modelVariablesList[packed_var_first].numActive;
+
+// Sum of the squares of the active order parameters, for the interaction terms
+// (the sum over the other order parameters j is the sum over all of them minus i)
+dealii::VectorizedArray<double> sum_nsq = constV(0.0);
+for (unsigned int i=packed_var_first; i<packed_var_first+num_active; i++){
+	sum_nsq += modelVariablesList[i].scalarValue*modelVariablesList[i].scalarValue;
+}
+
+for (unsigned int i=packed_var_first; i<packed_var_first+num_active; i++){
 	fnV = - modelVariablesList[i].scalarValue + modelVariablesList[i].scalarValue*modelVariablesList[i].scalarValue*modelVariablesList[i].scalarValue;
 	nx = modelVariablesList[i].scalarGrad;
-	for (unsigned int j=0; j<num_var; j++){
-		if (i != j){
-			fnV += constV(2.0*alpha) * modelVariablesList[i].scalarValue * modelVariablesList[j].scalarValue*modelVariablesList[j].scalarValue;
-		}
-	}
+	fnV += constV(2.0*alpha) * modelVariablesList[i].scalarValue * (sum_nsq - modelVariablesList[i].scalarValue*modelVariablesList[i].scalarValue);
 	modelResidualsList[i].scalarValueResidual = modelVariablesList[i].scalarValue-constV(timeStep*MnV)*fnV;
 	modelResidualsList[i].scalarGradResidual = constV(-timeStep*KnV*MnV)*nx;
 }
@@ -102,14 +132,16 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList,
 											const dealii::VectorizedArray<double> & JxW_value,
-											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+											std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 	scalarvalueType total_energy_density = constV(0.0);
 
 
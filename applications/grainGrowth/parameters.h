@@ -62,3 +62,17 @@
 
 
 
+// =================================================================================
+// Set the grain remapping parameters
+// =================================================================================
+// Every grainRemapInterval time steps, the grains of an order parameter closer
+// than grainBufferDistance to another grain of that order parameter are moved to
+// the order parameter with the farthest grains (the order parameters are the
+// packed group in equations.h). Off by default, so that the results are the same
+// as without remapping; set grainRemapping to true to let more grains share the
+// order parameters (the other parameters below then apply)
+#define grainRemapping false
+#define grainRemapInterval 100
+#define grainThreshold 0.01
+#define grainBufferDistance 8.0
+
@@ -12,7 +12,15 @@
 #define variable_type {"SCALAR","SCALAR","SCALAR","SCALAR","VECTOR"}
 #define variable_eq_type {"PARABOLIC","PARABOLIC","PARABOLIC","PARABOLIC","ELLIPTIC"}
 
+// Optionally, the finite element degree of each variable (finiteElementDegree if not defined). The ELLIPTIC variables
+// can have a lower degree, e.g. a linear displacement field with finiteElementDegree 2:
+// #define variable_degree {2, 2, 2, 2, 1}
+
 // Flags for whether the value, gradient, and Hessian are needed in the residual eqns
+// (the Hessian of u is only used with a concentration dependent misfit, i.e. nonzero
+// sfts_linear1-3 below: set the need_hess entry of u to true then. It can be
+// recovered from the gradients of u by also setting recoveredHessians to true in
+// parameters.h, which only applies to variables with need_hess)
 #define need_val {true, true, true, true, false}
 #define need_grad {true, true, true, true, true}
 #define need_hess {false, false, false, false, false}
@@ -22,6 +30,8 @@
 #define need_val_residual {true, true, true, true, false}
 #define need_grad_residual {true, true, true, true, true}
 
+#define need_q_point_loc false
+
 // Flags for whether the value, gradient, and Hessian are needed in the residual eqn
 // for the left-hand-side of the iterative solver for elliptic equations
 #define need_val_LHS {false, true, true, true, false}
@@ -176,20 +186,15 @@ for (unsigned int j=0; j<dim; j++){
 //compute stress
 //S=C*(E-E0)
 // Compute stress tensor (which is equal to the residual, Rux)
-dealii::VectorizedArray<double> CIJ_combined[CIJ_tensor_size][CIJ_tensor_size];
-
-if (n_dependent_stiffness == true){
+// The stiffness is interpolated between the phases as C = C_alpha*(1-sum_h) + C_beta*sum_h
 dealii::VectorizedArray<double> sum_hV;
 sum_hV = h1V+h2V+h3V;
-for (unsigned int i=0; i<2*dim-1+dim/3; i++){
-	  for (unsigned int j=0; j<2*dim-1+dim/3; j++){
-		  CIJ_combined[i][j] = CIJ_list[0][i][j]*(constV(1.0)-sum_hV) + CIJ_list[1][i][j]*sum_hV;
-	  }
-}
-computeStress<dim>(CIJ_combined, E2, S);
+
+if (n_dependent_stiffness == true){
+computeStress<dim>(stiffness_list[0], constV(1.0)-sum_hV, stiffness_list[1], sum_hV, E2, S);
 }
 else{
-computeStress<dim>(CIJ_list[0], E2, S);
+computeStress<dim>(stiffness_list[0], E2, S);
 }
 
 // Fill residual corresponding to mechanics
@@ -225,8 +230,7 @@ dealii::VectorizedArray<double> heterMechAC3=constV(0.0);
 dealii::VectorizedArray<double> S2[dim][dim];
 
 if (n_dependent_stiffness == true){
-//computeStress<dim>(CIJ_diff, E2, S2);
-	computeStress<dim>(CIJ_list[1]-CIJ_list[0], E2, S2);
+	computeStress<dim>(stiffness_list[1], constV(1.0), stiffness_list[0], constV(-1.0), E2, S2);
 for (unsigned int i=0; i<dim; i++){
 	  for (unsigned int j=0; j<dim; j++){
 		  heterMechAC1 += S2[i][j]*E2[i][j];
@@ -252,10 +256,10 @@ if (c_dependent_misfit == true){
 	}
 
 	if (n_dependent_stiffness == true){
-		computeStress<dim>(CIJ_combined, E3, S3);
+		computeStress<dim>(stiffness_list[0], constV(1.0)-sum_hV, stiffness_list[1], sum_hV, E3, S3);
 	}
 	else{
-		computeStress<dim>(CIJ_list[0], E3, S3);
+		computeStress<dim>(stiffness_list[0], E3, S3);
 	}
 
 	for (unsigned int i=0; i<dim; i++){
@@ -346,13 +350,10 @@ E = symmetrize(ux);
 
 // Compute stress tensor (which is equal to the residual, Rux)
 if (n_dependent_stiffness == true){
-	dealii::Tensor<2, CIJ_tensor_size, dealii::VectorizedArray<double> > CIJ_combined;
-	CIJ_combined = CIJ_list[0]*(constV(1.0)-h1V-h2V-h3V) + CIJ_list[1]*(h1V+h2V+h3V);
-
-	computeStress<dim>(CIJ_combined, E, ruxV);
+	computeStress<dim>(stiffness_list[0], constV(1.0)-h1V-h2V-h3V, stiffness_list[1], h1V+h2V+h3V, E, ruxV);
 }
 else{
-	computeStress<dim>(CIJ_list[0], E, ruxV);
+	computeStress<dim>(stiffness_list[0], E, ruxV);
 }
 
 modelRes.vectorGradResidual = ruxV;
@@ -366,14 +367,16 @@ modelRes.vectorGradResidual = ruxV;
 // It takes "modelVariablesList" as an input, which is a list of the value and
 // derivatives of each of the variables at a specific quadrature point. It also
 // takes the mapped quadrature weight, "JxW_value", as an input. The (x,y,z) location
-// of the quadrature point is given by "q_point_loc". The weighted value of the
-// energy density is added to "energy" variable and the components of the energy
-// density are added to the "energy_components" variable (index 0: chemical energy,
-// index 1: gradient energy, index 2: elastic energy).
+// of the quadrature point is given by "q_point_loc". The weighted values of the
+// components of the energy density are added to "energyComponents" (by default
+// index 0: chemical energy, index 1: gradient energy, index 2: elastic energy; the
+// number of components can be set with "num_energy_components"). The total energy
+// is the sum of the components.
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList,
 											const dealii::VectorizedArray<double> & JxW_value,
-											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+											std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 scalarvalueType total_energy_density = constV(0.0);
 
@@ -457,20 +460,13 @@ for (unsigned int i=0; i<dim; i++){
 
 //compute stress
 //S=C*(E-E0)
-dealii::VectorizedArray<double> CIJ_combined[2*dim-1+dim/3][2*dim-1+dim/3];
-
 if (n_dependent_stiffness == true){
   dealii::VectorizedArray<double> sum_hV;
   sum_hV = h1V+h2V+h3V;
-  for (unsigned int i=0; i<2*dim-1+dim/3; i++){
-	  for (unsigned int j=0; j<2*dim-1+dim/3; j++){
-		  CIJ_combined[i][j] = CIJ_list[0][i][j]*(constV(1.0)-sum_hV) + CIJ_list[1][i][j]*sum_hV;
-	  }
-  }
-  computeStress<dim>(CIJ_combined, E2, S);
+  computeStress<dim>(stiffness_list[0], constV(1.0)-sum_hV, stiffness_list[1], sum_hV, E2, S);
 }
 else{
-  computeStress<dim>(CIJ_list[0], E2, S);
+  computeStress<dim>(stiffness_list[0], E2, S);
 }
 
 scalarvalueType f_el = constV(0.0);
@@ -483,18 +479,14 @@ for (unsigned int i=0; i<dim; i++){
 
 total_energy_density = f_chem + f_grad + f_el;
 
-// Loop to step through each element of the vectorized arrays. Working with deal.ii
-// developers to see if there is a more elegant way to do this.
-assembler_lock.acquire ();
+// Add the weighted energy densities to their components, only at the points where c > 1.0e-10
 for (unsigned i=0; i<c.n_array_elements;i++){
   if (c[i] > 1.0e-10){
-	  this->energy+=total_energy_density[i]*JxW_value[i];
-	  this->energy_components[0]+= f_chem[i]*JxW_value[i];
-	  this->energy_components[1]+= f_grad[i]*JxW_value[i];
-	  this->energy_components[2]+= f_el[i]*JxW_value[i];
+	  energyComponents[0][i] += f_chem[i]*JxW_value[i];
+	  energyComponents[1][i] += f_grad[i]*JxW_value[i];
+	  energyComponents[2][i] += f_el[i]*JxW_value[i];
   }
 }
-assembler_lock.release ();
 }
 
 
@@ -0,0 +1,67 @@
+//selection of the components of a packed group passed to the residual equations for a cell batch (see num_active_packed_var)
+#ifndef ACTIVESELECTION_H
+#define ACTIVESELECTION_H
+
+//A component is selected in a cell batch if its absolute value at a node of the batch is above the tolerance, so a
+//component above the tolerance at a node is selected in all the cell batches around that node and the DOFs shared by
+//neighboring batches get the same residual terms from both. Up to n_slots selected components are passed in the n_slots
+//slots of the group (with the largest remaining components in the free slots). A cell batch with more selected
+//components than slots (e.g. where more grains meet than the slots) is evaluated densely, with all the components.
+
+#include <cmath>
+
+namespace activeSelection {
+
+//largest absolute value of each component (values[c][v] for component c on lane v) over the nodes seen so far (nan once
+//a value is nan, so that it is selected)
+template <unsigned int n_group, typename valueType>
+inline void addMaxAbs(const valueType &values, double maxValue[n_group]){
+	for (unsigned int c=0; c<n_group; c++){
+		for (unsigned int v=0; v<dealii::VectorizedArray<double>::n_array_elements; v++){
+			const double value = std::abs(values[c][v]);
+			if ((value > maxValue[c]) || (value != value)){
+				maxValue[c] = value;
+			}
+		}
+	}
+}
+
+//select the components of a cell batch from their largest absolute values over its nodes: the components above tol,
+//completed with the largest other ones (the first ones for equal values) up to n_slots, or all the components if more than
+//n_slots are above tol. The selected components are stored in index in the order of the components, and their number is
+//returned (n_slots or n_group)
+template <unsigned int n_group>
+inline unsigned int select(const double maxValue[n_group], const unsigned int n_slots, const double tol, unsigned int index[n_group]){
+	bool isActive[n_group];
+	unsigned int n_above = 0;
+	for (unsigned int c=0; c<n_group; c++){
+		isActive[c] = !(maxValue[c] <= tol);
+		n_above += isActive[c];
+	}
+	if (n_above > n_slots){
+		for (unsigned int c=0; c<n_group; c++){
+			index[c] = c;
+		}
+		return n_group;
+	}
+	for (unsigned int s=n_above; s<n_slots; s++){
+		unsigned int largest = n_group;
+		for (unsigned int c=0; c<n_group; c++){
+			if (!isActive[c] && ((largest == n_group) || (maxValue[c] > maxValue[largest]))){
+				largest = c;
+			}
+		}
+		isActive[largest] = true;
+	}
+	unsigned int s = 0;
+	for (unsigned int c=0; c<n_group; c++){
+		if (isActive[c]){
+			index[s++] = c;
+		}
+	}
+	return n_slots;
+}
+
+}
+
+#endif
@@ -3,11 +3,16 @@
 #include <deal.II/base/function.h>
 #include <deal.II/base/logstream.h>
 #include <deal.II/base/timer.h>
+#include <deal.II/base/thread_local_storage.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/multithread_info.h>
 #include <deal.II/base/numbers.h>
 #include <deal.II/lac/vector.h>
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/solver_gmres.h>
 #include <deal.II/lac/precondition.h>
+#include <deal.II/lac/vector_memory.h>
 #include <deal.II/lac/constraint_matrix.h>
 #include <deal.II/fe/fe_system.h>
 #include <deal.II/fe/fe_q.h>
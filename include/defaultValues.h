@@ -67,4 +67,162 @@
 #define skipImplicitSolves 1
 #endif
 
+//solve the elliptic fields with an inexact Newton-Krylov iteration instead of a single linear solve, requires jacobianFreeNewton (default value:false)
+#ifndef nonlinearEllipticSolve
+#define nonlinearEllipticSolve false
+#endif
+
+//use a finite difference directional derivative of residualRHS for the Jacobian action of the Newton-Krylov iteration (default value:false)
+#ifndef jacobianFreeNewton
+#define jacobianFreeNewton false
+#endif
+
+//max number of Newton iterations per elliptic solve (default value:20)
+#ifndef maxNewtonIterations
+#define maxNewtonIterations 20
+#endif
+
+//Newton tolerance, relative to the initial nonlinear residual or absolute if absTol is true (default value:1.0e-8)
+#ifndef newtonTolerance
+#define newtonTolerance 1.0e-8
+#endif
+
+//skip implicit solves while the elliptic residual stays small relative to the last solve, and adapt the solver tolerance
+//to the magnitude of the parabolic updates (default value:false). Overrides skipImplicitSolves when enabled.
+#ifndef adaptiveImplicitSolves
+#define adaptiveImplicitSolves false
+#endif
+
+//an elliptic field is re-solved once its residual exceeds this multiple of the residual reached at its last solve (default value:10.0)
+#ifndef implicitSolveResidualThreshold
+#define implicitSolveResidualThreshold 10.0
+#endif
+
+//max number of consecutive implicit solves skipped by the adaptive policy (default value:100)
+#ifndef maxSkippedImplicitSolves
+#define maxSkippedImplicitSolves 100
+#endif
+
+//max factor by which the adaptive policy loosens or tightens solverTolerance (default value:10.0)
+#ifndef adaptiveToleranceRange
+#define adaptiveToleranceRange 10.0
+#endif
+
+//solve the elliptic (mechanics) field with the FFT-based spectral elasticity backend, for uniform meshes only (default value:false)
+#ifndef spectralElasticity
+#define spectralElasticity false
+#endif
+
+//max number of fixed-point iterations of the spectral backend before finishing the solve with preconditioned CG (default value:20)
+#ifndef maxSpectralIterations
+#define maxSpectralIterations 20
+#endif
+
+//compute the energy of an output step in the computeRHS() pass of the following increment, from the same evaluated fields,
+//instead of a separate cell loop. Supported by generalizedProblem models only (default value:false)
+#ifndef fuseEnergyWithRHS
+#define fuseEnergyWithRHS false
+#endif
+
+//store the fields of the LHS other than the solved field (e.g. the order parameters in the mechanics LHS) at each quadrature
+//point once per implicit solve, instead of reading and evaluating them in every solver iteration. Supported by
+//generalizedProblem models only (default value:false)
+#ifndef cacheLHSCoefficients
+#define cacheLHSCoefficients false
+#endif
+
+//max memory per processor of the LHS coefficient cache in MB. Above it, the fields are evaluated in every solver iteration (default value:1024)
+#ifndef LHSCacheMemoryLimit
+#define LHSCacheMemoryLimit 1024
+#endif
+
+//evaluate the RHS in full only on the cell batches where the fields change (the active set). A cell batch whose residuals
+//equal the current field values within activeSetTolerance (zero update, e.g. in the bulk phases away from the
+//interfaces), and whose neighbors within activeSetHaloLayers are the same, only gets its mass matrix contribution in the
+//next increments. Supported by generalizedProblem models without elliptic fields only (default value:false)
+#ifndef activeSetSkipping
+#define activeSetSkipping false
+#endif
+
+//max absolute difference between the residuals and the field values (and max gradient residual) at the quadrature points
+//of a cell batch with a zero update (default value:1.0e-12)
+#ifndef activeSetTolerance
+#define activeSetTolerance 1.0e-12
+#endif
+
+//layers of neighboring cell batches (sharing a vertex) around the changing cell batches that are also evaluated in
+//full. One layer is needed for the skipped cell batches to be exact (default value:1)
+#ifndef activeSetHaloLayers
+#define activeSetHaloLayers 1
+#endif
+
+//number of increments after which all the cell batches are evaluated in full again (default value:100)
+#ifndef activeSetRefreshInterval
+#define activeSetRefreshInterval 100
+#endif
+
+//evaluate the RHS on a structured grid of the locally owned cells, with direct indexing of the nodes and the constant
+//Jacobian of the cells, instead of the matrix free cell loop. For uniform meshes (hAdaptivity false) and fields of
+//finiteElementDegree only, and checked against the cell loop on the first evaluation. Supported by generalizedProblem
+//models only (default value:false)
+#ifndef structuredGridRHS
+#define structuredGridRHS false
+#endif
+
+//use the collocation of the nodes and the Gauss-Lobatto quadrature points in generalizedProblem models: the values at the
+//quadrature points are the DOF values and the value residuals times JxW are added to the DOF values, so only the gradients
+//and Hessians are evaluated and integrated. Applies to the variables of finiteElementDegree (default value:true)
+#ifndef gaussLobattoCollocation
+#define gaussLobattoCollocation true
+#endif
+
+//detect the grains of the order parameters (connected regions above grainThreshold, see grainRemapping.h) and move the
+//grains closer than grainBufferDistance to a grain of the same order parameter to the order parameter with the farthest
+//grains, every grainRemapInterval increments, so that many grains can share a few order parameters. The order parameters
+//are the variables in grain_remap_var (equations.h), by default the packed group. Supported by generalizedProblem models
+//only (default value:false)
+#ifndef grainRemapping
+#define grainRemapping false
+#endif
+
+//number of increments between the grain remappings (default value:100)
+#ifndef grainRemapInterval
+#define grainRemapInterval 100
+#endif
+
+//value of an order parameter above which a node belongs to a grain (default value:0.01)
+#ifndef grainThreshold
+#define grainThreshold 0.01
+#endif
+
+//minimum distance between the bounding boxes of two grains of the same order parameter (default value:ten elements)
+#ifndef grainBufferDistance
+#define grainBufferDistance (10.0*spanX/((double)subdivisionsX)/std::pow(2.0,refineFactor))
+#endif
+
+//in generalizedProblem models, recover the Hessians of the ELLIPTIC variables needed in the RHS (need_hess) from the L2
+//projections (with the lumped mass matrix) of their derivatives along each direction, recomputed after each solve of the
+//variable, so that the RHS evaluates gradients only instead of Hessians. The recovered Hessian is the symmetrized gradient
+//of the projected derivatives (default value:false)
+#ifndef recoveredHessians
+#define recoveredHessians false
+#endif
+
+//absolute value of an order parameter of a sparse packed group (num_active_packed_var in equations.h) above which it is
+//passed to the residual equations in the cell batches of the node. The cell batches with more order parameters above it
+//than num_active_packed_var are evaluated with the whole group (default value:1.0e-4)
+#ifndef activePackedTolerance
+#define activePackedTolerance 1.0e-4
+#endif
+
+//seed of the random noise of the residuals (gaussianNoise), the same seed gives the same noise (default value:1)
+#ifndef noiseSeed
+#define noiseSeed 1
+#endif
+
+//need_q_point_loc is declared by the applications next to the residual flags (equations.h or residuals.h): whether the
+//residuals read the location of the quadrature point (q_point_loc). If false, the MatrixFree mapping does not compute
+//the quadrature points and q_point_loc is passed to the residuals as a zero point. Since equations.h is included after
+//this file, the default is set in generalized_model_functions.h (default value:true)
+
 #endif
@@ -0,0 +1,274 @@
+//forward-mode automatic differentiation with dual numbers over VectorizedArray<double>
+#ifndef DUALNUMBERS_H
+#define DUALNUMBERS_H
+
+//A dualNumber<n,order> carries a value together with its derivatives with respect to n independent
+//variables: the gradient (order 1) or the gradient and the Hessian (order 2). The arithmetic
+//operators and the functions below propagate the derivatives with the chain rule, so a single
+//evaluation of an expression for the free energy gives its value and all the derivatives needed by
+//the residuals, instead of separate hand-written expressions for each derivative (faV, facV,
+//faccV, hnV, ...). In equations.h:
+//
+//  autoDiff::dual2<2> c_d(c, 0), n_d(n, 1);   //independent variables with index 0 and 1
+//  autoDiff::dual2<2> f = (1.0-h(n_d))*fa(c_d) + h(n_d)*fb(c_d);
+//  f.value, f.gradient(1) (=df/dn), f.hessian(0,0) (=d2f/dc2), f.hessian(0,1) (=d2f/dcdn)
+//
+//The Hessian is symmetric and only its upper triangle is stored and computed.
+
+namespace autoDiff {
+
+typedef dealii::VectorizedArray<double> vdouble;
+
+template <unsigned int n, unsigned int order>
+class dualNumber
+{
+ public:
+	static const unsigned int n_hessian = (order == 2) ? n*(n+1)/2 : 1;
+
+	//constant (all derivatives zero)
+	dualNumber(){
+		value = 0.0;
+		setDerivatives(0.0);
+	}
+
+	dualNumber(const vdouble &_value): value(_value){
+		setDerivatives(0.0);
+	}
+
+	dualNumber(const double _value){
+		value = _value;
+		setDerivatives(0.0);
+	}
+
+	//independent variable number "index"
+	dualNumber(const vdouble &_value, const unsigned int index): value(_value){
+		setDerivatives(0.0);
+		grad[index] = 1.0;
+	}
+
+	const vdouble & gradient(const unsigned int i) const {return grad[i];}
+
+	const vdouble & hessian(const unsigned int i, const unsigned int j) const {return hess[hessianIndex(i,j)];}
+
+	//index of the entry (i,j) in the packed upper triangle of the Hessian
+	static unsigned int hessianIndex(const unsigned int i, const unsigned int j){
+		return (i <= j) ? i*n - i*(i+1)/2 + j : j*n - j*(j+1)/2 + i;
+	}
+
+	dualNumber & operator+=(const dualNumber &b){
+		value += b.value;
+		for (unsigned int i=0; i<n; i++){
+			grad[i] += b.grad[i];
+		}
+		if (order == 2){
+			for (unsigned int k=0; k<n_hessian; k++){
+				hess[k] += b.hess[k];
+			}
+		}
+		return *this;
+	}
+
+	dualNumber & operator-=(const dualNumber &b){
+		value -= b.value;
+		for (unsigned int i=0; i<n; i++){
+			grad[i] -= b.grad[i];
+		}
+		if (order == 2){
+			for (unsigned int k=0; k<n_hessian; k++){
+				hess[k] -= b.hess[k];
+			}
+		}
+		return *this;
+	}
+
+	//product rule, (ab)'' = a''b + ab'' + a'b'^T + b'a'^T
+	dualNumber & operator*=(const dualNumber &b){
+		if (order == 2){
+			for (unsigned int i=0; i<n; i++){
+				for (unsigned int j=i; j<n; j++){
+					const unsigned int k = hessianIndex(i,j);
+					hess[k] = hess[k]*b.value + value*b.hess[k] + grad[i]*b.grad[j] + grad[j]*b.grad[i];
+				}
+			}
+		}
+		for (unsigned int i=0; i<n; i++){
+			grad[i] = grad[i]*b.value + value*b.grad[i];
+		}
+		value *= b.value;
+		return *this;
+	}
+
+	dualNumber & operator/=(const dualNumber &b){
+		const vdouble inv = 1.0/b.value;
+		return (*this) *= chain(b, inv, (0.0-inv)*inv, 2.0*inv*inv*inv);
+	}
+
+	//scaling by a value without derivatives
+	dualNumber & operator*=(const vdouble &s){
+		value *= s;
+		for (unsigned int i=0; i<n; i++){
+			grad[i] *= s;
+		}
+		if (order == 2){
+			for (unsigned int k=0; k<n_hessian; k++){
+				hess[k] *= s;
+			}
+		}
+		return *this;
+	}
+
+	//f(x) from the value f, the first derivative df and the second derivative ddf of f at x.value
+	static dualNumber chain(const dualNumber &x, const vdouble &f, const vdouble &df, const vdouble &ddf){
+		dualNumber r(f);
+		for (unsigned int i=0; i<n; i++){
+			r.grad[i] = df*x.grad[i];
+		}
+		if (order == 2){
+			for (unsigned int i=0; i<n; i++){
+				for (unsigned int j=i; j<n; j++){
+					const unsigned int k = hessianIndex(i,j);
+					r.hess[k] = df*x.hess[k] + ddf*x.grad[i]*x.grad[j];
+				}
+			}
+		}
+		return r;
+	}
+
+	vdouble value;
+	vdouble grad[n];
+	vdouble hess[n_hessian];
+
+ private:
+	void setDerivatives(const double d){
+		for (unsigned int i=0; i<n; i++){
+			grad[i] = d;
+		}
+		for (unsigned int k=0; k<n_hessian; k++){
+			hess[k] = d;
+		}
+	}
+};
+
+//value and gradient
+template <unsigned int n>
+using dual = dualNumber<n,1>;
+
+//value, gradient and Hessian
+template <unsigned int n>
+using dual2 = dualNumber<n,2>;
+
+//arithmetic operators (with dual numbers, VectorizedArrays and doubles)
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator+(dualNumber<n,order> a, const dualNumber<n,order> &b){return a += b;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator-(dualNumber<n,order> a, const dualNumber<n,order> &b){return a -= b;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator*(dualNumber<n,order> a, const dualNumber<n,order> &b){return a *= b;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator/(dualNumber<n,order> a, const dualNumber<n,order> &b){return a /= b;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator-(dualNumber<n,order> a){return a *= vectorizedMath::broadcast(-1.0);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator+(dualNumber<n,order> a, const vdouble &s){a.value += s; return a;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator+(const vdouble &s, dualNumber<n,order> a){a.value += s; return a;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator-(dualNumber<n,order> a, const vdouble &s){a.value -= s; return a;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator-(const vdouble &s, const dualNumber<n,order> &a){return dualNumber<n,order>(s) -= a;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator*(dualNumber<n,order> a, const vdouble &s){return a *= s;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator*(const vdouble &s, dualNumber<n,order> a){return a *= s;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator/(dualNumber<n,order> a, const vdouble &s){return a *= 1.0/s;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator/(const vdouble &s, const dualNumber<n,order> &a){return dualNumber<n,order>(s) /= a;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator+(const dualNumber<n,order> &a, const double s){return a + vectorizedMath::broadcast(s);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator+(const double s, const dualNumber<n,order> &a){return a + vectorizedMath::broadcast(s);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator-(const dualNumber<n,order> &a, const double s){return a - vectorizedMath::broadcast(s);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator-(const double s, const dualNumber<n,order> &a){return vectorizedMath::broadcast(s) - a;}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator*(const dualNumber<n,order> &a, const double s){return a * vectorizedMath::broadcast(s);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator*(const double s, const dualNumber<n,order> &a){return a * vectorizedMath::broadcast(s);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator/(const dualNumber<n,order> &a, const double s){return a * vectorizedMath::broadcast(1.0/s);}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> operator/(const double s, const dualNumber<n,order> &a){return vectorizedMath::broadcast(s) / a;}
+
+//functions (exp and log use the vectorized versions in vectorizedMath.h)
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> exp(const dualNumber<n,order> &x){
+	const vdouble f = vectorizedMath::exp(x.value);
+	return dualNumber<n,order>::chain(x, f, f, f);
+}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> log(const dualNumber<n,order> &x){
+	const vdouble inv = 1.0/x.value;
+	return dualNumber<n,order>::chain(x, vectorizedMath::log(x.value), inv, (0.0-inv)*inv);
+}
+
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> sqrt(const dualNumber<n,order> &x){
+	const vdouble f = std::sqrt(x.value);
+	const vdouble df = 0.5/f;
+	return dualNumber<n,order>::chain(x, f, df, -0.5*df/x.value);
+}
+
+//x^p for x>0
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> pow(const dualNumber<n,order> &x, const double p){
+	const vdouble f = vectorizedMath::pow(x.value, p);
+	const vdouble df = p*f/x.value;
+	return dualNumber<n,order>::chain(x, f, df, (p-1.0)*df/x.value);
+}
+
+//x^p for an integer p (any x for p>=0), by repeated squaring
+template <unsigned int n, unsigned int order>
+inline dualNumber<n,order> pow(dualNumber<n,order> x, const int p){
+	if (p < 0){
+		return 1.0/pow(x, -p);
+	}
+	dualNumber<n,order> r(1.0);
+	unsigned int k = p;
+	while (k > 0){
+		if (k & 1){
+			r *= x;
+		}
+		k >>= 1;
+		if (k > 0){
+			x *= x;
+		}
+	}
+	return r;
+}
+
+}
+
+#endif
@@ -3,17 +3,24 @@
 #define FIELDS_H
 #include <deal.II/base/conditional_ostream.h>
 
-enum fieldType {SCALAR, VECTOR};
+enum fieldType {SCALAR, VECTOR, PACKED};
 enum PDEType   {ELLIPTIC, PARABOLIC};
 
 template<int dim>
 class Field
 {
  public:
-  Field(fieldType _type, PDEType _pdetype, std::string _name);
+  Field(fieldType _type, PDEType _pdetype, std::string _name, unsigned int _degree=finiteElementDegree);
+  //packed field: scalar components (one per name in _componentNames) sharing a single finite element space, with the
+  //values of the components interleaved at each node
+  Field(PDEType _pdetype, std::string _name, std::vector<std::string> _componentNames, unsigned int _degree=finiteElementDegree);
   fieldType type;
   PDEType   pdetype;
   std::string name;
+  //name of each component (the name of the field for SCALAR and VECTOR fields)
+  std::vector<std::string> componentNames;
+  //finite element degree (at most finiteElementDegree, which sets the quadrature common to all the fields)
+  unsigned int degree;
   unsigned int index;
   unsigned int startIndex;
   unsigned int numComponents;
@@ -29,7 +36,7 @@ template <int dim> unsigned int Field<dim>::indexCount = 0;
 
 //constructor
 template<int dim>
-Field<dim>::Field(fieldType _type, PDEType _pdetype, std::string _name): type(_type), pdetype(_pdetype), name(_name)
+Field<dim>::Field(fieldType _type, PDEType _pdetype, std::string _name, unsigned int _degree): type(_type), pdetype(_pdetype), name(_name), degree(_degree)
 {
   //increment field count as new field is being created
   index=fieldCount;
@@ -55,6 +62,21 @@ Field<dim>::Field(fieldType _type, PDEType _pdetype, std::string _name): type(_t
     exit(-1);
   }
   }
+  componentNames.assign(numComponents, name);
+}
+
+//constructor of a packed field
+template<int dim>
+Field<dim>::Field(PDEType _pdetype, std::string _name, std::vector<std::string> _componentNames, unsigned int _degree): type(PACKED), pdetype(_pdetype), name(_name), componentNames(_componentNames), degree(_degree)
+{
+  //increment field count as new field is being created
+  index=fieldCount;
+  fieldCount++;
+  startIndex= indexCount;
+
+  //increment index count by the number of components
+  numComponents=componentNames.size();
+  indexCount+=numComponents;
 }
 
 #endif
@@ -13,6 +13,11 @@
 
 //PRISMS headers
 #include "fields.h"
+#include "vectorizedMath.h"
+#include "randomNoise.h"
+#include "dualNumbers.h"
+#include "activeSelection.h"
+#include "../src/models/mechanics/spectralElasticity.h"
 
  
 //define data types
@@ -133,6 +138,32 @@ class MatrixFreePDE:public Subscriptor
    * and also invokes the corresponding solvers: Explicit solver for Parabolic problems, Implicit (matrix-free) solver for Elliptic problems.
    */  
   void solveIncrement ();
+  /*Method to solve a nonlinear elliptic field with an inexact Newton-Krylov iteration (enabled by the flag nonlinearEllipticSolve).
+   *The nonlinear residual is supplied by residualRHS and the Jacobian action by a finite difference directional derivative of the
+   *residual (jacobianFreeNewton must be true). Returns the total number of linear solver iterations.*/
+  unsigned int solveNonlinearIncrement (unsigned int fieldIndex);
+  /*Method to evaluate the nonlinear residual of an elliptic field, with the Dirichlet rows set to the BC mismatch. Returns the L2 norm of the residual.*/
+  double computeNonlinearResidual (unsigned int fieldIndex);
+  /*Matrix-free finite difference approximation of the Jacobian action, used by the Newton-Krylov solver.*/
+  class JacobianFreeOperator;
+
+  /*Methods of the adaptive implicit solve policy (enabled by the flag adaptiveImplicitSolves). An elliptic field is re-solved only
+   *when its residual for the current solution exceeds implicitSolveResidualThreshold times the residual reached at its last solve,
+   *and the solver tolerance is scaled with the relative magnitude of the parabolic updates.*/
+  bool implicitSolveRequired (unsigned int fieldIndex);
+  double implicitSolveTolerance (double baseTolerance);
+  void recordImplicitSolve (unsigned int fieldIndex, double residualLevel, unsigned int solverSteps);
+  void updateParabolicUpdateMagnitude ();
+  void outputImplicitSolveStatistics ();
+
+  /*FFT-based Green's function solver for the elliptic (mechanics) field on uniform meshes (enabled by the flag spectralElasticity).*/
+  spectralElasticitySolver<dim> spectralSolver;
+  /*Virtual method returning the homogeneous reference stiffness (Voigt notation) used by the spectral elasticity backend.*/
+  virtual void getReferenceStiffness(dealii::Table<2, double> &CIJ);
+  /*Method to map the elliptic field onto the structured grid of the spectral solver. Called at the end of init().*/
+  void initSpectralElasticity();
+  /*Method to solve an elliptic field with the spectral elasticity backend. Returns the number of iterations.*/
+  unsigned int solveSpectralElasticity(unsigned int fieldIndex);
   /* Method to write solution fields to vtu and pvtu (parallel) files. 
   *
   * This method can be enabled/disabled by setting the flag writeOutput to true/false. Also,
@@ -179,18 +210,33 @@ class MatrixFreePDE:public Subscriptor
   MatrixFree<dim,double>               matrixFreeObject;
   /*Vector to store the inverse of the mass matrix diagonal. Due to the choice of spectral elements with Guass-Lobatto quadrature, the mass matrix is diagonal.*/
   vectorType                           invM;
+  /*Inverse of the mass matrix diagonal used for each field: invM for the parabolic fields with one component, and a vector of its own
+   *for a parabolic field with several components (which have a different DoF layout, see PACKED in fields.h). NULL for the elliptic fields.*/
+  std::vector<vectorType*>             invMSet;
   /*Vector to store the solution increment. This is a temporary vector used during implicit solves of the Elliptic fields.*/
   vectorType                           dU;
+  /*Pool of scratch vectors for vmult(). Vectors are reused across calls, and nested or concurrent calls get separate vectors.*/
+  mutable GrowingVectorMemory<vectorType> vmultScratchPool;
   
   //matrix free methods
   /*Current field index*/
   unsigned int currentFieldIndex;
+  /*Index of the field whose residual is requested from getRHS() (see computeFieldRHS()), or -1 for all the fields. A model
+   *may skip the integration of the residuals of the other fields.*/
+  int rhsFieldIndex;
   /*Number of quadrature points*/
   unsigned int num_quadrature_points;
+  /*Flag for whether the locations of the quadrature points are needed in the cell loops. If false, they are not stored in matrixFreeObject.*/
+  bool needQuadraturePoints;
   /*Method to compute the inverse of the mass matrix*/
   void computeInvM();
+  /*Method to compute the inverse of the lumped mass matrix of a field with several components or of another degree than finiteElementDegree*/
+  void computeInvMComponents(vectorType &invMField, unsigned int fieldIndex);
   /*Method to compute the right hand side (RHS) residual vectors*/  
   void computeRHS();
+  /*Method to compute the RHS residual vector of a single field (the other residual vectors are left zero or partially
+   *assembled, depending on the model), used for the Jacobian action of the Newton-Krylov solver*/
+  void computeFieldRHS(unsigned int fieldIndex);
 
   /*AMR methods*/
   void refineGrid();
@@ -207,15 +253,30 @@ class MatrixFreePDE:public Subscriptor
 		      vectorType &dst, 
 		      const vectorType &src,
 		      const std::pair<unsigned int,unsigned int> &cell_range) const;
+  /*Virtual method called before the implicit solve of an elliptic field, to precompute the quantities used by getLHS() that
+   *are constant during the solve. The default implementation does nothing.*/
+  virtual void prepareLHS(unsigned int fieldIndex);
+  /*Virtual method called after the implicit solve of an elliptic field, e.g. to update the quantities derived from it. The
+   *default implementation does nothing.*/
+  virtual void ellipticFieldUpdated(unsigned int fieldIndex);
   /*Method to calculate RHS (implicit/explicit). This is an abstract method, so every model which inherits MatrixFreePDE<dim> has to implement this method.*/
   virtual void getRHS (const MatrixFree<dim,double> &data, 
 		       std::vector<vectorType*> &dst, 
 		       const std::vector<vectorType*> &src,
 		       const std::pair<unsigned int,unsigned int> &cell_range) const = 0;
+  /*Virtual method called before the cell loop of computeRHS(), e.g. to select the cells evaluated by getRHS(). The default
+   *implementation does nothing.*/
+  virtual void prepareRHS();
+  /*Virtual method to compute the RHS residual vectors without the matrix free cell loop, e.g. on a structured grid (see
+   *structuredGridRHS). Returns false if the cell loop of getRHS() is to be used, as in the default implementation.*/
+  virtual bool computeRHSStructured();
   
   //methods to apply dirichlet BC's
   /*Map of degrees of freedom to the corresponding Dirichlet boundary conditions, is any.*/
   std::vector<std::map<dealii::types::global_dof_index, double>*> valuesDirichletSet;
+  /*Sorted local (vector) indices and values of the locally owned Dirichlet degrees of freedom of each field, used in vmult() and the implicit solves.*/
+  std::vector<std::vector<unsigned int> > dirichletLocalIndicesSet;
+  std::vector<std::vector<double> > dirichletLocalValuesSet;
   /*Virtual method to mark the boundaries for applying Dirichlet boundary conditions.  This is usually expected to be provided by the user.*/  
   virtual void markBoundaries();
   /*Virtual method for applying Dirichlet boundary conditions.  This is usually expected to be provided by the user.*/ 
@@ -228,10 +289,22 @@ class MatrixFreePDE:public Subscriptor
 
   /*Method to compute energy like quantities.*/
   void computeEnergy();
+  /*Method to add the energy across all processors and store it in freeEnergyValues.*/
+  void finalizeEnergy();
+  /*Flag for whether getRHS() can compute the energy in the same cell loop (set by the derived class), and flag set on an
+   *output step (with fuseEnergyWithRHS) for the energy to be computed in the next computeRHS() call.*/
+  bool energyInRHSSupported, energyInRHSPending;
+  /*Method to compute and write the energy on an output step, either directly or in the next computeRHS() call.*/
+  void outputEnergy();
+  /*Method to compute the energy requested for the next computeRHS() call right away.*/
+  void flushPendingEnergy();
   virtual void getEnergy(const MatrixFree<dim,double> &data,
 		    std::vector<vectorType*> &dst,
 		    const std::vector<vectorType*> &src,
 		    const std::pair<unsigned int,unsigned int> &cell_range);
+  /*Virtual method to (re)build the scratch data (e.g. FEEvaluation objects) reused by getRHS(), getLHS() and getEnergy() across
+   *cell_loop calls. Called at the end of init(), i.e. also after each AMR step, since the scratch data is tied to matrixFreeObject.*/
+  virtual void reinitCellScratch();
 
   //utility functions
   /*Returns index of given field name if exists, else throw error.*/
@@ -254,13 +327,25 @@ class MatrixFreePDE:public Subscriptor
   double dtValue, currentTime, finalTime;
   unsigned int currentIncrement, totalIncrements;
 
+  //variables for the adaptive implicit solve policy
+  /*Residual level reached at the last implicit solve, and number of consecutive skipped solves, of each elliptic field.*/
+  std::map<unsigned int, double> lastImplicitSolveResidual;
+  std::map<unsigned int, unsigned int> consecutiveSkippedSolves;
+  /*Squared norms of the parabolic update and solution accumulated in an increment, and the resulting relative update magnitude.*/
+  double parabolicUpdateNormSqr, parabolicSolutionNormSqr, parabolicUpdateMagnitude, parabolicUpdateReference;
+  /*Statistics of the adaptive implicit solve policy.*/
+  unsigned int implicitSolvesPerformed, implicitSolvesSkipped, implicitSolverSteps;
+
   /*parallel message stream*/
   ConditionalOStream  pcout;
   /*Timer and logging object*/
   mutable TimerOutput computing_timer;
 
-  double energy;
-  std::vector<double> energy_components;
+  /*Energy and its components (mutable, since they are also accumulated by getRHS() when energyInRHSPending is set).*/
+  mutable double energy;
+  mutable std::vector<double> energy_components;
+  /*Number of components of the energy computed by computeEnergy() (e.g. chemical, gradient and elastic energy).*/
+  unsigned int numEnergyComponents;
 };
 
 //other matrixFree headers 
@@ -276,6 +361,9 @@ class MatrixFreePDE:public Subscriptor
 #include "../src/matrixfree/modifyFields.cc"
 #include "../src/matrixfree/solve.cc"
 #include "../src/matrixfree/solveIncrement.cc"
+#include "../src/matrixfree/solveNonlinear.cc"
+#include "../src/matrixfree/adaptiveImplicitSolves.cc"
+#include "../src/matrixfree/spectralElasticity.cc"
 #include "../src/matrixfree/outputResults.cc"
 #include "../src/matrixfree/markBoundaries.cc"
 #include "../src/matrixfree/boundaryConditions.cc"
@@ -12,6 +12,10 @@ class modelVariable
 	vectorvalueType vectorValue;
 	vectorgradType vectorGrad;
 	vectorhessType vectorHess;
+
+	// Number of variables of a packed group passed to the residual equations for the cell batch (set for the first
+	// variable of the group, see num_active_packed_var)
+	unsigned int numActive;
 };
 
 //constructor
@@ -0,0 +1,99 @@
+//counter-based random numbers for noise terms (e.g. thermal fluctuations) in the residuals
+#ifndef RANDOMNOISE_H
+#define RANDOMNOISE_H
+
+//The Philox4x32-10 generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11) maps a 128 bit
+//counter and a 64 bit key to four random 32 bit words, with no state: a random number only depends on what it is
+//keyed on. gaussian() keys the noise on the location of the point (quantized), the time step and a noise stream, so
+//the noise is the same for any partitioning of the mesh, number of threads or layout of the cell batches, and a node
+//shared by several cells gets the same noise in all of them. gaussianDof() keys the noise on a global DOF index instead.
+//The generator runs on arrays over the lanes of a VectorizedArray, so that the rounds are vectorized by the compiler.
+
+#include <cmath>
+#include <stdint.h>
+
+namespace randomNoise {
+
+const unsigned int n_lanes = dealii::VectorizedArray<double>::n_array_elements;
+
+//multipliers and key increments of Philox4x32
+const uint32_t philoxM0 = 0xD2511F53;
+const uint32_t philoxM1 = 0xCD9E8D57;
+const uint32_t philoxW0 = 0x9E3779B9;
+const uint32_t philoxW1 = 0xBB67AE85;
+
+//Philox4x32-10 of n counters with the same key, in place (counter[w][l] is word w of the counter of lane l)
+template <unsigned int n>
+inline void philox4x32(uint32_t counter[4][n], uint32_t key0, uint32_t key1){
+	for (unsigned int round=0; round<10; round++){
+		for (unsigned int l=0; l<n; l++){
+			const uint64_t product0 = (uint64_t)philoxM0*counter[0][l];
+			const uint64_t product1 = (uint64_t)philoxM1*counter[2][l];
+			const uint32_t word1 = counter[1][l], word3 = counter[3][l];
+			counter[0][l] = (uint32_t)(product1 >> 32) ^ word1 ^ key0;
+			counter[1][l] = (uint32_t)product1;
+			counter[2][l] = (uint32_t)(product0 >> 32) ^ word3 ^ key1;
+			counter[3][l] = (uint32_t)product0;
+		}
+		key0 += philoxW0;
+		key1 += philoxW1;
+	}
+}
+
+//uniform random number in (0,1) from the 53 high bits of two random words
+inline double uniform(const uint32_t high, const uint32_t low){
+	const uint64_t bits = ((uint64_t)high << 21) | (low >> 11);
+	return ((double)bits + 0.5)*(1.0/9007199254740992.0);
+}
+
+//standard normal random numbers of the counters of the lanes (Box-Muller transform of the two uniform random numbers
+//of each output of the generator)
+inline dealii::VectorizedArray<double> gaussian(uint32_t counter[4][n_lanes], const uint32_t key0, const uint32_t key1){
+	philox4x32<n_lanes>(counter, key0, key1);
+	dealii::VectorizedArray<double> u1, angle;
+	for (unsigned int l=0; l<n_lanes; l++){
+		u1[l] = uniform(counter[0][l], counter[1][l]);
+		angle[l] = 2.0*M_PI*uniform(counter[2][l], counter[3][l]);
+	}
+	dealii::VectorizedArray<double> result = std::sqrt(-2.0*vectorizedMath::log(u1));
+	for (unsigned int l=0; l<n_lanes; l++){
+		result[l] *= std::cos(angle[l]);
+	}
+	return result;
+}
+
+//standard normal noise at the points of the lanes: the counter is the location in multiples of resolution[d] along
+//each direction and the step, the key is the stream and the seed
+template <int dim>
+inline dealii::VectorizedArray<double> gaussian(const dealii::Point<dim, dealii::VectorizedArray<double> > &location,
+						 const double resolution[dim], const unsigned int step,
+						 const unsigned int stream, const unsigned int seed){
+	uint32_t counter[4][n_lanes];
+	for (unsigned int l=0; l<n_lanes; l++){
+		for (unsigned int d=0; d<3; d++){
+			counter[d][l] = (d<dim) ? (uint32_t)(int64_t)std::floor(location[d][l]/resolution[d]+0.5) : 0;
+		}
+		counter[3][l] = step;
+	}
+	return gaussian(counter, stream, seed);
+}
+
+//standard normal noise of a DOF, e.g. for a noise term added to the nodal values of a field: the counter is the global
+//index of the DOF (two words) and the step, the key is the stream and the seed. Unlike the noise at a point, it depends on
+//the numbering of the DOFs, which changes with the partitioning of the mesh
+inline double gaussianDof(const dealii::types::global_dof_index dof, const unsigned int step,
+			  const unsigned int stream, const unsigned int seed){
+	uint32_t counter[4][1];
+	counter[0][0] = (uint32_t)dof;
+	counter[1][0] = (uint32_t)((uint64_t)dof >> 32);
+	counter[2][0] = step;
+	counter[3][0] = 0;
+	philox4x32<1>(counter, stream, seed);
+	const double u1 = uniform(counter[0][0], counter[1][0]);
+	const double angle = 2.0*M_PI*uniform(counter[2][0], counter[3][0]);
+	return std::sqrt(-2.0*std::log(u1))*std::cos(angle);
+}
+
+}
+
+#endif
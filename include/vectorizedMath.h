@@ -0,0 +1,230 @@
+//vectorized transcendental functions for VectorizedArray<double>
+#ifndef VECTORIZEDMATH_H
+#define VECTORIZEDMATH_H
+
+//The std::exp, std::log, std::pow and std::tanh overloads of deal.II for VectorizedArray call the
+//scalar functions lane by lane. The functions below evaluate the polynomial approximations with
+//VectorizedArray arithmetic, so that they run on all lanes at once, and only the exponent
+//manipulation (integer bit operations) is done lane by lane. They can be used directly in the
+//residuals in equations.h, e.g. vectorizedMath::exp(c) or vectorizedMath::log<vectorizedMath::SINGLE_ACCURACY>(c).
+//
+//Accuracy (relative error for arguments in the valid range):
+//  DOUBLE_ACCURACY (default): a few ulp, close to the std:: functions
+//  SINGLE_ACCURACY: about 1e-7 (shorter polynomials and fewer Newton iterations)
+//Valid ranges: exp for all x (overflow gives inf, underflow gives 0), log and pow for x>0 (other
+//values fall back to std::log lane by lane), invsqrt for normalized x>0. pow(x,y) is computed as
+//exp(y*log(x)), so its relative error grows with |y*log(x)|.
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+
+namespace vectorizedMath {
+
+enum mathAccuracy {DOUBLE_ACCURACY, SINGLE_ACCURACY};
+
+typedef dealii::VectorizedArray<double> vdouble;
+
+//constants of the range reductions (ln(2) split in a part exact in double precision and the remainder)
+const double ln2_hi = 6.93147180369123816490e-01;
+const double ln2_lo = 1.90821492927058770002e-10;
+const double log2e = 1.44269504088896338700e+00;
+const double sqrt_half = 7.07106781186547524401e-01;
+
+inline vdouble broadcast(const double value){
+	vdouble result;
+	result = value;
+	return result;
+}
+
+//round to the nearest integer (for |x| < 2^51) by adding and subtracting 1.5*2^52
+const double round_shift = 6755399441055744.0;
+
+//2^n for an integer valued n in [-1022,1023], built from the exponent bits: the low bits of
+//n+1023+round_shift hold n+1023
+inline vdouble pow2(const vdouble &n){
+	const vdouble shifted = n + (1023.0 + round_shift);
+	vdouble result;
+	for (unsigned int v=0; v<vdouble::n_array_elements; v++){
+		int64_t bits;
+		std::memcpy(&bits, &shifted[v], sizeof(double));
+		bits <<= 52;
+		std::memcpy(&result[v], &bits, sizeof(double));
+	}
+	return result;
+}
+
+//exp(x) = 2^n*(1+p), with n = round(x/ln(2)) and p = exp(r)-1 for the reduced argument
+//r = x-n*ln(2), |r| <= ln(2)/2. p is returned without the leading 1 so that expm1 does not
+//lose accuracy for small x
+template <mathAccuracy accuracy>
+inline void expReduced(const vdouble &x, vdouble &n, vdouble &p){
+	//outside of [-746,710] exp(x) is 0 or inf in double precision
+	const vdouble xc = std::min(std::max(x, broadcast(-746.0)), broadcast(710.0));
+	n = (xc*log2e + round_shift) - round_shift;
+	const vdouble r = (xc - n*ln2_hi) - n*ln2_lo;
+
+	//Taylor expansion of exp(r)-1 (degree 13, resp. 7, for the accuracy requested)
+	if (accuracy == DOUBLE_ACCURACY){
+		p = broadcast(1.0/6227020800.0);
+		p = p*r + 1.0/479001600.0;
+		p = p*r + 1.0/39916800.0;
+		p = p*r + 1.0/3628800.0;
+		p = p*r + 1.0/362880.0;
+		p = p*r + 1.0/40320.0;
+		p = p*r + 1.0/5040.0;
+	}
+	else {
+		p = broadcast(1.0/5040.0);
+	}
+	p = p*r + 1.0/720.0;
+	p = p*r + 1.0/120.0;
+	p = p*r + 1.0/24.0;
+	p = p*r + 1.0/6.0;
+	p = p*r + 0.5;
+	p = p*r + 1.0;
+	p = p*r;
+}
+
+//2^n*a, split in two factors so that results in the subnormal range and up to the overflow are obtained
+inline vdouble scale(const vdouble &a, const vdouble &n){
+	const vdouble n1 = (0.5*n + round_shift) - round_shift;
+	return a*pow2(n1)*pow2(n - n1);
+}
+
+template <mathAccuracy accuracy>
+inline vdouble exp(const vdouble &x){
+	vdouble n, p;
+	expReduced<accuracy>(x, n, p);
+	return scale(p + 1.0, n);
+}
+
+inline vdouble exp(const vdouble &x){
+	return exp<DOUBLE_ACCURACY>(x);
+}
+
+//exp(x)-1, accurate also for small |x|
+template <mathAccuracy accuracy>
+inline vdouble expm1(const vdouble &x){
+	vdouble n, p;
+	expReduced<accuracy>(x, n, p);
+	const vdouble two_n = scale(broadcast(1.0), n);
+	return two_n*p + (two_n - 1.0);
+}
+
+inline vdouble expm1(const vdouble &x){
+	return expm1<DOUBLE_ACCURACY>(x);
+}
+
+//log(x) = e*ln(2) + log(m), with x = m*2^e and m in [sqrt(1/2),sqrt(2)). log(m) = 2*atanh(s) with
+//s = (m-1)/(m+1), |s| < 0.172, is expanded in a series in s^2
+template <mathAccuracy accuracy>
+inline vdouble log(const vdouble &x){
+	vdouble m, e;
+	for (unsigned int v=0; v<vdouble::n_array_elements; v++){
+		int64_t bits;
+		std::memcpy(&bits, &x[v], sizeof(double));
+		//exponent and mantissa in [0.5,1)
+		e[v] = (double)((bits >> 52) & 0x7ff) - 1022.0;
+		bits = (bits & 0x800fffffffffffffLL) | 0x3fe0000000000000LL;
+		std::memcpy(&m[v], &bits, sizeof(double));
+		if (m[v] < sqrt_half){
+			m[v] *= 2.0;
+			e[v] -= 1.0;
+		}
+	}
+	const vdouble s = (m - 1.0)/(m + 1.0);
+	const vdouble z = s*s;
+
+	vdouble p;
+	if (accuracy == DOUBLE_ACCURACY){
+		p = broadcast(1.0/21.0);
+		p = p*z + 1.0/19.0;
+		p = p*z + 1.0/17.0;
+		p = p*z + 1.0/15.0;
+		p = p*z + 1.0/13.0;
+		p = p*z + 1.0/11.0;
+	}
+	else {
+		p = broadcast(1.0/11.0);
+	}
+	p = p*z + 1.0/9.0;
+	p = p*z + 1.0/7.0;
+	p = p*z + 1.0/5.0;
+	p = p*z + 1.0/3.0;
+	vdouble result = e*ln2_hi + (e*ln2_lo + 2.0*s + 2.0*s*z*p);
+
+	//zero, negative, subnormal, inf and nan arguments
+	for (unsigned int v=0; v<vdouble::n_array_elements; v++){
+		if (!(x[v] >= std::numeric_limits<double>::min() && x[v] <= std::numeric_limits<double>::max())){
+			result[v] = std::log(x[v]);
+		}
+	}
+	return result;
+}
+
+inline vdouble log(const vdouble &x){
+	return log<DOUBLE_ACCURACY>(x);
+}
+
+//x^y for x>0
+template <mathAccuracy accuracy>
+inline vdouble pow(const vdouble &x, const vdouble &y){
+	return exp<accuracy>(y*log<accuracy>(x));
+}
+
+template <mathAccuracy accuracy>
+inline vdouble pow(const vdouble &x, const double y){
+	return exp<accuracy>(y*log<accuracy>(x));
+}
+
+inline vdouble pow(const vdouble &x, const vdouble &y){
+	return pow<DOUBLE_ACCURACY>(x, y);
+}
+
+inline vdouble pow(const vdouble &x, const double y){
+	return pow<DOUBLE_ACCURACY>(x, y);
+}
+
+//tanh(x) = -expm1(-2|x|)/(2+expm1(-2|x|)), with the sign of x
+template <mathAccuracy accuracy>
+inline vdouble tanh(const vdouble &x){
+	const vdouble abs_x = std::abs(x);
+	const vdouble t = expm1<accuracy>(-2.0*abs_x);
+	const vdouble sign = x/std::max(abs_x, broadcast(std::numeric_limits<double>::min()));
+	return sign*t/(-2.0 - t);
+}
+
+inline vdouble tanh(const vdouble &x){
+	return tanh<DOUBLE_ACCURACY>(x);
+}
+
+//1/sqrt(x). With SINGLE_ACCURACY, the initial estimate from the exponent bits is refined with three
+//Newton iterations (no division and square root)
+template <mathAccuracy accuracy>
+inline vdouble invsqrt(const vdouble &x){
+	if (accuracy == DOUBLE_ACCURACY){
+		return 1.0/std::sqrt(x);
+	}
+	vdouble y;
+	for (unsigned int v=0; v<vdouble::n_array_elements; v++){
+		int64_t bits;
+		std::memcpy(&bits, &x[v], sizeof(double));
+		bits = 0x5fe6eb50c7b537a9LL - (bits >> 1);
+		std::memcpy(&y[v], &bits, sizeof(double));
+	}
+	const vdouble half_x = 0.5*x;
+	y = y*(1.5 - half_x*y*y);
+	y = y*(1.5 - half_x*y*y);
+	y = y*(1.5 - half_x*y*y);
+	return y;
+}
+
+inline vdouble invsqrt(const vdouble &x){
+	return invsqrt<DOUBLE_ACCURACY>(x);
+}
+
+}
+
+#endif
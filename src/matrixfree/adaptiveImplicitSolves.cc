@@ -0,0 +1,109 @@
+//adaptive implicit solve policy for MatrixFreePDE class
+
+#ifndef ADAPTIVEIMPLICITSOLVES_MATRIXFREE_H
+#define ADAPTIVEIMPLICITSOLVES_MATRIXFREE_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+//decide if an elliptic field has to be solved in this increment. The residual computed
+//by computeRHS() for the current solution is compared against the residual level
+//reached at the last solve of the field
+template <int dim>
+bool MatrixFreePDE<dim>::implicitSolveRequired(unsigned int fieldIndex){
+  //fields are always solved the first time
+  if (lastImplicitSolveResidual.count(fieldIndex)==0){
+    return true;
+  }
+  if (consecutiveSkippedSolves[fieldIndex]>=maxSkippedImplicitSolves){
+    consecutiveSkippedSolves[fieldIndex]=0;
+    return true;
+  }
+
+  //L2 norm of the residual, with the Dirichlet rows set to the BC mismatch
+  double residualNormSqr=residualSet[fieldIndex]->norm_sqr();
+  double dirichletCorrection=0.0;
+  for (unsigned int i=0; i<dirichletLocalIndicesSet[fieldIndex].size(); i++){
+    const unsigned int dof=dirichletLocalIndicesSet[fieldIndex][i];
+    double mismatch=dirichletLocalValuesSet[fieldIndex][i]-solutionSet[fieldIndex]->local_element(dof);
+    double residual=residualSet[fieldIndex]->local_element(dof);
+    dirichletCorrection+=mismatch*mismatch-residual*residual;
+  }
+  residualNormSqr+=Utilities::MPI::sum(dirichletCorrection, MPI_COMM_WORLD);
+  double residualNorm=std::sqrt(std::max(residualNormSqr, 0.0));
+
+  double threshold=implicitSolveResidualThreshold*lastImplicitSolveResidual[fieldIndex];
+  if (residualNorm>threshold){
+    consecutiveSkippedSolves[fieldIndex]=0;
+    return true;
+  }
+
+  char buffer[200];
+  sprintf(buffer, "field '%2s' [implicit solve]: current residual:%12.6e, below the re-solve threshold:%12.6e, skipping implicit solve\n", \
+	  fields[fieldIndex].name.c_str(), residualNorm, threshold);
+  pcout<<buffer;
+  consecutiveSkippedSolves[fieldIndex]++;
+  implicitSolvesSkipped++;
+  return false;
+}
+
+//scale the solver tolerance with the relative magnitude of the latest parabolic update.
+//Fast moving parabolic fields invalidate the elliptic solution within a few increments,
+//so the tolerance is loosened, while slowly moving fields reuse the solution for many
+//increments, so the tolerance is tightened
+template <int dim>
+double MatrixFreePDE<dim>::implicitSolveTolerance(double baseTolerance){
+  if ((parabolicUpdateMagnitude<=0.0) || (parabolicUpdateReference<=0.0)){
+    return baseTolerance;
+  }
+  double factor=parabolicUpdateMagnitude/parabolicUpdateReference;
+  factor=std::min(std::max(factor, 1.0/adaptiveToleranceRange), adaptiveToleranceRange);
+  return factor*baseTolerance;
+}
+
+//book-keeping after each implicit solve
+template <int dim>
+void MatrixFreePDE<dim>::recordImplicitSolve(unsigned int fieldIndex, double residualLevel, unsigned int solverSteps){
+  lastImplicitSolveResidual[fieldIndex]=residualLevel;
+  implicitSolvesPerformed++;
+  implicitSolverSteps+=solverSteps;
+}
+
+//update the relative magnitude of the parabolic update accumulated in solveIncrement()
+template <int dim>
+void MatrixFreePDE<dim>::updateParabolicUpdateMagnitude(){
+  double updateNormSqr=Utilities::MPI::sum(parabolicUpdateNormSqr, MPI_COMM_WORLD);
+  double solutionNormSqr=Utilities::MPI::sum(parabolicSolutionNormSqr, MPI_COMM_WORLD);
+  parabolicUpdateNormSqr=0.0;
+  parabolicSolutionNormSqr=0.0;
+  if (solutionNormSqr<=0.0){
+    return;
+  }
+  parabolicUpdateMagnitude=std::sqrt(updateNormSqr/solutionNormSqr);
+  //running average of the update magnitude used as the reference
+  if (parabolicUpdateReference<=0.0){
+    parabolicUpdateReference=parabolicUpdateMagnitude;
+  }
+  else{
+    parabolicUpdateReference=0.9*parabolicUpdateReference+0.1*parabolicUpdateMagnitude;
+  }
+}
+
+//report the savings of the adaptive implicit solve policy
+template <int dim>
+void MatrixFreePDE<dim>::outputImplicitSolveStatistics(){
+  unsigned int totalSolves=implicitSolvesPerformed+implicitSolvesSkipped;
+  if (totalSolves==0){
+    return;
+  }
+  double averageSteps=0.0;
+  if (implicitSolvesPerformed>0){
+    averageSteps=(double)implicitSolverSteps/implicitSolvesPerformed;
+  }
+  char buffer[300];
+  sprintf(buffer, "\nadaptive implicit solves: %u of %u solves performed (%u skipped, %.1f%%), %u solver iterations (%.1f per solve), about %.0f solver iterations saved\n", \
+	  implicitSolvesPerformed, totalSolves, implicitSolvesSkipped, 100.0*implicitSolvesSkipped/totalSolves, \
+	  implicitSolverSteps, averageSteps, averageSteps*implicitSolvesSkipped);
+  pcout<<buffer;
+}
+
+#endif
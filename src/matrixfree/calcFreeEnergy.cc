@@ -13,22 +13,29 @@ void MatrixFreePDE<dim>::computeEnergy(){
 
   //call to integrate and assemble
   energy=0.0;
-  energy_components.clear();
-  energy_components.push_back(0.0);
-  energy_components.push_back(0.0);
-  energy_components.push_back(0.0);
+  energy_components.assign(numEnergyComponents, 0.0);
 
   matrixFreeObject.cell_loop (&MatrixFreePDE<dim>::getEnergy, this, residualSet, solutionSet);
-  //add across all processors
+  finalizeEnergy();
+
+  //end log
+  computing_timer.exit_section("matrixFreePDE: computeEnergy");
+}
+
+//add the energy (computed by computeEnergy() or computeRHS()) across all processors and store it
+template <int dim>
+void MatrixFreePDE<dim>::finalizeEnergy(){
   energy=Utilities::MPI::sum(energy, MPI_COMM_WORLD);
-  for (unsigned int i=0; i<3; i++){
+  for (unsigned int i=0; i<numEnergyComponents; i++){
 	  energy_components[i]=Utilities::MPI::sum(energy_components[i], MPI_COMM_WORLD);
   }
   pcout << "Energy: " << energy << std::endl;
-  pcout << "Energy Components: " << energy_components[0] << " " << energy_components[1] << " " << energy_components[2] << " " << std::endl;
+  pcout << "Energy Components: ";
+  for (unsigned int i=0; i<numEnergyComponents; i++){
+	  pcout << energy_components[i] << " ";
+  }
+  pcout << std::endl;
   freeEnergyValues.push_back(energy);
-  //end log
-  computing_timer.exit_section("matrixFreePDE: computeEnergy");
 }
 
 template <int dim>
@@ -10,29 +10,29 @@ void MatrixFreePDE<dim>::vmult (vectorType &dst, const vectorType &src) const{
   //log time
   computing_timer.enter_section("matrixFreePDE: computeLHS");
 
-  //create temporary copy of src vector as src2, as vector src is marked const and cannot be changed
-  vectorType src2;
-  matrixFreeObject.initialize_dof_vector(src2,  ellipticFieldIndex);
-  src2=src;
+  //copy of src vector as src2, as vector src is marked const and cannot be changed. The copy is
+  //taken from a pool of scratch vectors, so no allocation happens after the first solver iterations
+  //and nested calls (e.g. block or multigrid solvers) still get their own copy. The vector is returned
+  //to the pool when src2 goes out of scope, also if the cell loop throws
+  typename GrowingVectorMemory<vectorType>::Pointer src2(vmultScratchPool);
+  src2->reinit(src, true);
+  *src2=src;
   
   //set Dirichlet nodes force to zero in the src
-  for (std::map<types::global_dof_index, double>::const_iterator it=valuesDirichletSet[currentFieldIndex]->begin(); it!=valuesDirichletSet[currentFieldIndex]->end(); ++it){
-    if (src2.in_local_range(it->first)){
-      src2(it->first) = 0.0; //*jacobianDiagonal(it->first);
-    }
+  const std::vector<unsigned int> &dirichletLocalIndices=dirichletLocalIndicesSet[currentFieldIndex];
+  for (unsigned int i=0; i<dirichletLocalIndices.size(); i++){
+    src2->local_element(dirichletLocalIndices[i]) = 0.0;
   }
-  constraintsHangingNodesSet[currentFieldIndex]->distribute(src2);
+  constraintsHangingNodesSet[currentFieldIndex]->distribute(*src2);
 
   //call cell_loop 
   dst=0.0;
-  matrixFreeObject.cell_loop (&MatrixFreePDE<dim>::getLHS, this, dst, src2);
+  matrixFreeObject.cell_loop (&MatrixFreePDE<dim>::getLHS, this, dst, *src2);
   dst.compress(VectorOperation::add);
   
   //Account for Dirichlet BC's (essentially copy dirichlet DOF values present in src to dst)
-  for (std::map<types::global_dof_index, double>::const_iterator it=valuesDirichletSet[currentFieldIndex]->begin(); it!=valuesDirichletSet[currentFieldIndex]->end(); ++it){
-    if (dst.in_local_range(it->first)){
-      dst(it->first) = src(it->first); //*jacobianDiagonal(it->first);
-    }
+  for (unsigned int i=0; i<dirichletLocalIndices.size(); i++){
+    dst.local_element(dirichletLocalIndices[i]) = src.local_element(dirichletLocalIndices[i]);
   }
 
   //end log
@@ -48,6 +48,14 @@ void  MatrixFreePDE<dim>::getLHS(const MatrixFree<dim,double> &data,
   exit(-1);
 }
 
+template <int dim>
+void MatrixFreePDE<dim>::prepareLHS(unsigned int fieldIndex){
+}
+
+template <int dim>
+void MatrixFreePDE<dim>::ellipticFieldUpdated(unsigned int fieldIndex){
+}
+
 #endif
 
 
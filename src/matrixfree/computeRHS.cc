@@ -16,12 +16,66 @@ void MatrixFreePDE<dim>::computeRHS(){
     (*residualSet[fieldIndex])=0.0;
   }
 
-  //call to integrate and assemble 
-  matrixFreeObject.cell_loop (&MatrixFreePDE<dim>::getRHS, this, residualSet, solutionSet);
+  //the energy of the last output step is computed in this cell loop (see solve())
+  if (energyInRHSPending){
+    energy=0.0;
+    energy_components.assign(numEnergyComponents, 0.0);
+  }
+
+  //precompute the quantities used by getRHS() in this cell loop
+  prepareRHS();
+
+  //call to integrate and assemble (unless the model computes the residuals without the cell loop)
+  if (!computeRHSStructured()){
+    matrixFreeObject.cell_loop (&MatrixFreePDE<dim>::getRHS, this, residualSet, solutionSet);
+  }
+
+  if (energyInRHSPending){
+    energyInRHSPending=false;
+    finalizeEnergy();
+  }
 
   //end log
   computing_timer.exit_section("matrixFreePDE: computeRHS");
 }
 
+//update the RHS of a single field (cell loop of getRHS() restricted to the residual of fieldIndex, without the energy)
+template <int dim>
+void MatrixFreePDE<dim>::computeFieldRHS(unsigned int fieldIndex){
+  //log time
+  computing_timer.enter_section("matrixFreePDE: computeFieldRHS");
+
+  //clear residual vectors before update
+  for(unsigned int i=0; i<fields.size(); i++){
+    (*residualSet[i])=0.0;
+  }
+
+  //the energy requested for the next computeRHS() call is left pending
+  const bool energyPending=energyInRHSPending;
+  energyInRHSPending=false;
+
+  //precompute the quantities used by getRHS() in this cell loop
+  prepareRHS();
+
+  //call to integrate and assemble the residual of fieldIndex
+  rhsFieldIndex=fieldIndex;
+  matrixFreeObject.cell_loop (&MatrixFreePDE<dim>::getRHS, this, residualSet, solutionSet);
+  rhsFieldIndex=-1;
+
+  energyInRHSPending=energyPending;
+
+  //end log
+  computing_timer.exit_section("matrixFreePDE: computeFieldRHS");
+}
+
+template <int dim>
+void MatrixFreePDE<dim>::prepareRHS(){
+}
+
+template <int dim>
+bool MatrixFreePDE<dim>::computeRHSStructured(){
+  return false;
+}
+
 #endif
 
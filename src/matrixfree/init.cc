@@ -53,11 +53,17 @@
      if (iter==0){
        //print to std::out
        sprintf(buffer,"initializing finite element space P^%u for %9s:%6s field '%s'\n", \
-	       finiteElementDegree,					\
+	       it->degree,						\
 	       (it->pdetype==PARABOLIC ? "PARABOLIC":"ELLIPTIC"),	\
-	       (it->type==SCALAR ? "SCALAR":"VECTOR"),			\
+	       (it->type==SCALAR ? "SCALAR":(it->type==VECTOR ? "VECTOR":"PACKED")), \
 	       it->name.c_str());
        pcout << buffer;
+       //the quadrature (finiteElementDegree+1 Gauss-Lobatto points per direction) is common to all the fields. The
+       //parabolic fields need the degree of the quadrature for a diagonal mass matrix (see invM.cc)
+       if ((it->degree<1) || (it->degree>finiteElementDegree) || ((it->pdetype==PARABOLIC) && (it->degree!=finiteElementDegree))){
+	 pcout << "\nmatrixFreePDE.h: the degree of field '" << it->name << "' must be between 1 and finiteElementDegree, and finiteElementDegree for a PARABOLIC field\n";
+	 exit(-1);
+       }
        //check if any time dependent fields present
        if (it->pdetype==PARABOLIC){
 	 isTimeDependentBVP=true;
@@ -75,10 +81,13 @@
      //
      if (iter==0){
        if (it->type==SCALAR){
-	 fe=new FESystem<dim>(FE_Q<dim>(QGaussLobatto<1>(finiteElementDegree+1)),1);
+	 fe=new FESystem<dim>(FE_Q<dim>(QGaussLobatto<1>(it->degree+1)),1);
        }
        else if (it->type==VECTOR){
-	 fe=new FESystem<dim>(FE_Q<dim>(QGaussLobatto<1>(finiteElementDegree+1)),dim);
+	 fe=new FESystem<dim>(FE_Q<dim>(QGaussLobatto<1>(it->degree+1)),dim);
+       }
+       else if (it->type==PACKED){
+	 fe=new FESystem<dim>(FE_Q<dim>(QGaussLobatto<1>(it->degree+1)),it->numComponents);
        }
        else{
 	 pcout << "\nmatrixFreePDE.h: unknown field type\n";
@@ -124,6 +133,8 @@
        constraintsHangingNodes=new ConstraintMatrix; constraintsHangingNodesSet.push_back(constraintsHangingNodes);
        constraintsHangingNodesSet2.push_back(constraintsHangingNodes);
        valuesDirichletSet.push_back(new std::map<dealii::types::global_dof_index, double>);
+       dirichletLocalIndicesSet.push_back(std::vector<unsigned int>());
+       dirichletLocalValuesSet.push_back(std::vector<double>());
      }
      else{
        constraints=constraintsSet2.at(it->index);
@@ -142,11 +153,21 @@
 
      //store Dirichlet BC DOF's
      valuesDirichletSet[it->index]->clear();
-     for (types::global_dof_index i=0; i<dof_handler->n_dofs(); i++){
-       if (locally_relevant_dofs->is_element(i)){
-	 if (constraints->is_constrained(i)){
-	   (*valuesDirichletSet[it->index])[i] = constraints->get_inhomogeneity(i);
-	 }
+     for (unsigned int k=0; k<locally_relevant_dofs->n_elements(); k++){
+       types::global_dof_index i=locally_relevant_dofs->nth_index_in_set(k);
+       if (constraints->is_constrained(i)){
+	 (*valuesDirichletSet[it->index])[i] = constraints->get_inhomogeneity(i);
+       }
+     }
+
+     //store the locally owned Dirichlet BC DOF's as local vector indices (sorted, as the map is sorted)
+     const IndexSet &locally_owned_dofs=dof_handler->locally_owned_dofs();
+     dirichletLocalIndicesSet[it->index].clear();
+     dirichletLocalValuesSet[it->index].clear();
+     for (std::map<types::global_dof_index, double>::const_iterator dof=valuesDirichletSet[it->index]->begin(); dof!=valuesDirichletSet[it->index]->end(); ++dof){
+       if (locally_owned_dofs.is_element(dof->first)){
+	 dirichletLocalIndicesSet[it->index].push_back(locally_owned_dofs.index_within_set(dof->first));
+	 dirichletLocalValuesSet[it->index].push_back(dof->second);
        }
      }
 
@@ -160,7 +181,10 @@
    typename MatrixFree<dim,double>::AdditionalData additional_data;
    additional_data.mpi_communicator = MPI_COMM_WORLD;
    additional_data.tasks_parallel_scheme = MatrixFree<dim,double>::AdditionalData::partition_partition;
-   additional_data.mapping_update_flags = (update_values | update_gradients | update_JxW_values | update_quadrature_points);
+   additional_data.mapping_update_flags = (update_values | update_gradients | update_JxW_values);
+   if (needQuadraturePoints){
+     additional_data.mapping_update_flags = additional_data.mapping_update_flags | update_quadrature_points;
+   }
    QGaussLobatto<1> quadrature (finiteElementDegree+1);
    num_quadrature_points=std::pow(quadrature.size(),dim);
    matrixFreeObject.clear();
@@ -226,7 +250,22 @@
      solutionSet[fieldIndex]->update_ghost_values();
    } 
 
+#if spectralElasticity == true
+   //map the elliptic field onto the grid of the spectral elasticity backend
+   initSpectralElasticity();
+#endif
+
    computing_timer.exit_section("matrixFreePDE: initialization");  
+
+   //rebuild the cell scratch data for the new matrixFreeObject
+   computing_timer.enter_section("matrixFreePDE: reinitCellScratch");
+   reinitCellScratch();
+   computing_timer.exit_section("matrixFreePDE: reinitCellScratch");
+}
+
+//default implementation of the cell scratch data setup (models without persistent scratch data)
+template <int dim>
+void MatrixFreePDE<dim>::reinitCellScratch(){
 }
 
 #endif 
@@ -5,14 +5,27 @@
 //this source file is temporarily treated as a header file (hence
 //#ifndef's) till library packaging scheme is finalized
 
+//invert the mass matrix diagonal elements
+inline void invertMassDiagonal(vectorType &invM){
+  for (unsigned int k=0; k<invM.local_size(); ++k){
+    if (std::abs(invM.local_element(k))>1.0e-15){
+      invM.local_element(k) = 1./invM.local_element(k);
+    }
+    else{
+      invM.local_element(k) = 0;
+    }
+  }
+}
+
 //compute inverse of the diagonal mass matrix and store in vector invM
 template <int dim>
 void MatrixFreePDE<dim>::computeInvM(){
-  //initialize  invM
+  //initialize  invM (on the first PARABOLIC field with one component, the parabolic fields with several components get
+  //their own inverse mass matrix below)
   bool invMInitialized=false;
   unsigned int parabolicFieldIndex=0;
   for(unsigned int fieldIndex=0; fieldIndex<fields.size(); fieldIndex++){
-    if (fields[fieldIndex].pdetype==PARABOLIC){
+    if ((fields[fieldIndex].pdetype==PARABOLIC) && (fields[fieldIndex].numComponents==1)){
       matrixFreeObject.initialize_dof_vector (invM, fieldIndex);
       parabolicFieldIndex=fieldIndex;
       invMInitialized=true;
@@ -21,38 +34,96 @@ void MatrixFreePDE<dim>::computeInvM(){
   }
   //check if invM initialized
   if (!invMInitialized){
-    pcout << "matrixFreePDE.h: no PARABOLIC field... hence setting parabolicFieldIndex to 0 and marching ahead withn invM computation\n";
+    pcout << "matrixFreePDE.h: no PARABOLIC field with one component... hence setting parabolicFieldIndex to 0 and marching ahead withn invM computation\n";
     //exit(-1);
   }
-  
+
   //compute invM
-  matrixFreeObject.initialize_dof_vector (invM, parabolicFieldIndex);
-  invM=0.0;
-  VectorizedArray<double> one = make_vectorized_array (1.0);
-  
-  //select gauss lobatto quad points which are suboptimal but give diogonal M 
-  FEEvaluation<dim,finiteElementDegree> fe_eval(matrixFreeObject, parabolicFieldIndex);
-  const unsigned int n_q_points = fe_eval.n_q_points;
-  for (unsigned int cell=0; cell<matrixFreeObject.n_macro_cells(); ++cell){
-    fe_eval.reinit(cell);
-    for (unsigned int q=0; q<n_q_points; ++q){
-      fe_eval.submit_value(one,q);
-    }
-    fe_eval.integrate (true,false);
-    fe_eval.distribute_local_to_global (invM);
+  if (fields[parabolicFieldIndex].numComponents==1){
+    matrixFreeObject.initialize_dof_vector (invM, parabolicFieldIndex);
+    invM=0.0;
+    VectorizedArray<double> one = make_vectorized_array (1.0);
+
+    //select gauss lobatto quad points which are suboptimal but give diogonal M
+    FEEvaluation<dim,finiteElementDegree> fe_eval(matrixFreeObject, parabolicFieldIndex);
+    const unsigned int n_q_points = fe_eval.n_q_points;
+    for (unsigned int cell=0; cell<matrixFreeObject.n_macro_cells(); ++cell){
+      fe_eval.reinit(cell);
+      for (unsigned int q=0; q<n_q_points; ++q){
+	fe_eval.submit_value(one,q);
+      }
+      fe_eval.integrate (true,false);
+      fe_eval.distribute_local_to_global (invM);
+    }
+    invM.compress(VectorOperation::add);
+
+    //invert mass matrix diagonal elements
+    invertMassDiagonal(invM);
+    pcout << "computed mass matrix (using FE space for field: " << parabolicFieldIndex << ")\n";
   }
-  invM.compress(VectorOperation::add);
-  
-  //invert mass matrix diagonal elements
-  for (unsigned int k=0; k<invM.local_size(); ++k){
-    if (std::abs(invM.local_element(k))>1.0e-15){
-      invM.local_element(k) = 1./invM.local_element(k);
+
+  //inverse mass matrix of each parabolic field
+  invMSet.resize(fields.size(), NULL);
+  for(unsigned int fieldIndex=0; fieldIndex<fields.size(); fieldIndex++){
+    if (fields[fieldIndex].pdetype!=PARABOLIC){
+      invMSet[fieldIndex]=NULL;
+    }
+    else if (fields[fieldIndex].numComponents==1){
+      invMSet[fieldIndex]=&invM;
     }
     else{
-      invM.local_element(k) = 0;
+      if ((invMSet[fieldIndex]==NULL) || (invMSet[fieldIndex]==&invM)){
+	invMSet[fieldIndex]=new vectorType;
+      }
+      computeInvMComponents(*invMSet[fieldIndex], fieldIndex);
+      pcout << "computed mass matrix (using FE space for field: " << fieldIndex << ", " << fields[fieldIndex].numComponents << " components)\n";
     }
-  } 
-  pcout << "computed mass matrix (using FE space for field: " << parabolicFieldIndex << ")\n";
+  }
+}
+
+//inverse of the lumped mass matrix of a field with one or several components (invMField initialized on the field, with
+//the ghost entries of the locally owned cells). The mass matrix of each component is the diagonal mass matrix of a scalar
+//field, from the Gauss-Lobatto quadrature of the degree of the field (its nodes), so that it is the lumped mass matrix of
+//a field of a lower degree than finiteElementDegree as well. It is assembled cell by cell since the FEEvaluation objects
+//don't select a component of the field
+template <int dim>
+void computeLumpedInvM(const DoFHandler<dim> &dofHandler, const ConstraintMatrix &constraints, vectorType &invMField){
+  invMField=0.0;
+
+  const FiniteElement<dim> &fe=dofHandler.get_fe();
+  QGaussLobatto<dim> quadrature (fe.degree+1);
+  FEValues<dim> fe_values (fe, quadrature, update_values | update_JxW_values);
+  const unsigned int dofs_per_cell=fe.dofs_per_cell;
+  Vector<double> cellMass (dofs_per_cell);
+  std::vector<types::global_dof_index> local_dof_indices (dofs_per_cell);
+
+  typename DoFHandler<dim>::active_cell_iterator cell=dofHandler.begin_active(), endc=dofHandler.end();
+  for (; cell!=endc; ++cell){
+    if (cell->is_locally_owned()){
+      fe_values.reinit (cell);
+      for (unsigned int i=0; i<dofs_per_cell; ++i){
+	const unsigned int component=fe.system_to_component_index(i).first;
+	cellMass(i)=0.0;
+	for (unsigned int q=0; q<quadrature.size(); ++q){
+	  cellMass(i)+=fe_values.shape_value_component(i,q,component)*fe_values.shape_value_component(i,q,component)*fe_values.JxW(q);
+	}
+      }
+      cell->get_dof_indices (local_dof_indices);
+      constraints.distribute_local_to_global (cellMass, local_dof_indices, invMField);
+    }
+  }
+  invMField.compress(VectorOperation::add);
+
+  //invert mass matrix diagonal elements
+  invertMassDiagonal(invMField);
+}
+
+//compute inverse of the lumped mass matrix of a field with several components, or of a field of another degree than
+//finiteElementDegree
+template <int dim>
+void MatrixFreePDE<dim>::computeInvMComponents(vectorType &invMField, unsigned int fieldIndex){
+  matrixFreeObject.initialize_dof_vector (invMField, fieldIndex);
+  computeLumpedInvM<dim>(*dofHandlersSet2[fieldIndex], *constraintsHangingNodesSet2[fieldIndex], invMField);
 }
 
 #endif
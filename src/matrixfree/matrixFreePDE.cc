@@ -11,6 +11,8 @@
  :
  Subscriptor(),
  triangulation (MPI_COMM_WORLD),
+ rhsFieldIndex(-1),
+ needQuadraturePoints(true),
  isTimeDependentBVP(false),
  isEllipticBVP(false),
  dtValue(0.0),
@@ -18,8 +20,18 @@
  finalTime(0.0),
  currentIncrement(0),
  totalIncrements(1),
+ parabolicUpdateNormSqr(0.0),
+ parabolicSolutionNormSqr(0.0),
+ parabolicUpdateMagnitude(0.0),
+ parabolicUpdateReference(0.0),
+ implicitSolvesPerformed(0),
+ implicitSolvesSkipped(0),
+ implicitSolverSteps(0),
+ energyInRHSSupported(false),
+ energyInRHSPending(false),
  pcout (std::cout, Utilities::MPI::this_mpi_process(MPI_COMM_WORLD)==0),
- computing_timer (pcout, TimerOutput::summary, TimerOutput::wall_times)
+ computing_timer (pcout, TimerOutput::summary, TimerOutput::wall_times),
+ numEnergyComponents(3)
  {
    //initialize time step variables
 #ifdef timeStep
@@ -47,6 +59,12 @@
      delete solutionSet[iter];
      delete residualSet[iter];
    } 
+   //the inverse mass matrices of the parabolic fields with several components (the others point to invM)
+   for(unsigned int iter=0; iter<invMSet.size(); iter++){
+     if (invMSet[iter]!=&invM){
+       delete invMSet[iter];
+     }
+   }
  }
 
 #endif
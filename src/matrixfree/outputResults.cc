@@ -17,14 +17,14 @@ void MatrixFreePDE<dim>::outputResults(){
   //loop over fields
 
   for(unsigned int fieldIndex=0; fieldIndex<fields.size(); fieldIndex++){
-    //mark field as scalar/vector
+    //mark field as scalar/vector (the components of a packed field are scalars)
     std::vector<DataComponentInterpretation::DataComponentInterpretation> dataType \
       (fields[fieldIndex].numComponents,				\
-       (fields[fieldIndex].type==SCALAR ?				\
-	DataComponentInterpretation::component_is_scalar:		\
-	DataComponentInterpretation::component_is_part_of_vector));
+       (fields[fieldIndex].type==VECTOR ?				\
+	DataComponentInterpretation::component_is_part_of_vector:	\
+	DataComponentInterpretation::component_is_scalar));
     //add field to data_out
-    std::vector<std::string> solutionNames (fields[fieldIndex].numComponents, fields[fieldIndex].name.c_str());
+    std::vector<std::string> solutionNames (fields[fieldIndex].componentNames);
     data_out.add_data_vector(*dofHandlersSet[fieldIndex], *solutionSet[fieldIndex], solutionNames, dataType);  
   }
   
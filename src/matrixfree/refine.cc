@@ -74,6 +74,8 @@ void MatrixFreePDE<dim>::refineGrid (){
 template <int dim>
 void MatrixFreePDE<dim>::refineMesh(unsigned int _currentIncrement){
 #if hAdaptivity==true 
+  //the energy of the last output step is computed before the solution is transferred to the new mesh
+  flushPendingEnergy();
   init(_currentIncrement-1);
 #endif
 }
@@ -19,8 +19,7 @@ void MatrixFreePDE<dim>::solve(){
     	outputResults();
     	#ifdef calcEnergy
     	if (calcEnergy == true){
-    		computeEnergy();
-    		outputFreeEnergy(freeEnergyValues);
+    		outputEnergy();
     	}
 		#endif
     }
@@ -52,8 +51,7 @@ void MatrixFreePDE<dim>::solve(){
     	  outputResults();
 			#ifdef calcEnergy
 			  if (calcEnergy == true){
-				  computeEnergy();
-				  outputFreeEnergy(freeEnergyValues);
+				  outputEnergy();
 			  }
 			#endif
 
@@ -63,6 +61,16 @@ void MatrixFreePDE<dim>::solve(){
     	  break;
       }
     }
+
+    //write the energies computed in the computeRHS() passes after the last output step
+	#if fuseEnergyWithRHS == true
+	#ifdef calcEnergy
+    if ((writeOutput) && (calcEnergy == true)){
+    	flushPendingEnergy();
+    	outputFreeEnergy(freeEnergyValues);
+    }
+	#endif
+	#endif
   }
   //time independent BVP
   else{
@@ -90,8 +98,38 @@ void MatrixFreePDE<dim>::solve(){
     }
   }
 
+#if adaptiveImplicitSolves == true
+  outputImplicitSolveStatistics();
+#endif
+
   //log time
   computing_timer.exit_section("matrixFreePDE: solve"); 
 }
 
+//compute and write the energy on an output step. With fuseEnergyWithRHS, the energy is computed in the
+//computeRHS() pass of the next increment (from the same solution) and written with the next output record.
+//The last increment has no next computeRHS() pass, so there the energy is computed with computeEnergy()
+template <int dim>
+void MatrixFreePDE<dim>::outputEnergy(){
+#if fuseEnergyWithRHS == true
+  if (energyInRHSSupported && isTimeDependentBVP && (currentIncrement<totalIncrements) && (currentTime<finalTime)){
+    energyInRHSPending=true;
+    outputFreeEnergy(freeEnergyValues);
+    return;
+  }
+#endif
+  computeEnergy();
+  outputFreeEnergy(freeEnergyValues);
+}
+
+//compute the energy requested on the last output step with a separate cell loop. Called before the solution
+//is modified outside of the time step (AMR, nucleation), which would change it before the next computeRHS()
+template <int dim>
+void MatrixFreePDE<dim>::flushPendingEnergy(){
+  if (energyInRHSPending){
+    energyInRHSPending=false;
+    computeEnergy();
+  }
+}
+
 #endif
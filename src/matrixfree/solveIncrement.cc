@@ -13,10 +13,10 @@ void MatrixFreePDE<dim>::solveIncrement(){
   Timer time; 
   char buffer[200];
 
-  //modify fields (rarely used. Typically used in problems involving nucleation)
-#ifdef nucleation_occurs
-  if (nucleation_occurs == true) modifySolutionFields();
-#endif
+  //modify fields (rarely used. Typically used in problems involving nucleation or grain remapping, the model checks its
+  //own flags). An energy requested for this computeRHS() (fuseEnergyWithRHS) has to be computed with flushPendingEnergy()
+  //before the fields are modified
+  modifySolutionFields();
 
   //compute residual vectors
   computeRHS();
@@ -25,10 +25,17 @@ void MatrixFreePDE<dim>::solveIncrement(){
   for(unsigned int fieldIndex=0; fieldIndex<fields.size(); fieldIndex++){
     //Parabolic (first order derivatives in time) fields
     if (fields[fieldIndex].pdetype==PARABOLIC){
-      //explicit-time step each DOF
+      //explicit-time step each DOF (with the inverse mass matrix of the DoF layout of the field, see computeInvM)
+      const vectorType &invMField=*invMSet[fieldIndex];
       for (unsigned int dof=0; dof<solutionSet[fieldIndex]->local_size(); ++dof){
+#if adaptiveImplicitSolves == true
+	//accumulate the update magnitude used to adapt the implicit solver tolerance
+	double update=invMField.local_element(dof)*residualSet[fieldIndex]->local_element(dof)-solutionSet[fieldIndex]->local_element(dof);
+	parabolicUpdateNormSqr+=update*update;
+	parabolicSolutionNormSqr+=solutionSet[fieldIndex]->local_element(dof)*solutionSet[fieldIndex]->local_element(dof);
+#endif
 	solutionSet[fieldIndex]->local_element(dof)=			\
-	  invM.local_element(dof)*residualSet[fieldIndex]->local_element(dof);
+	  invMField.local_element(dof)*residualSet[fieldIndex]->local_element(dof);
       }
       //
       //apply constraints
@@ -46,21 +53,40 @@ void MatrixFreePDE<dim>::solveIncrement(){
     else if (fields[fieldIndex].pdetype==ELLIPTIC){
     	//implicit solve
 		#ifdef solverType
-		if (currentIncrement%skipImplicitSolves==0){
+		bool solveRequired=(currentIncrement%skipImplicitSolves==0);
+		#if adaptiveImplicitSolves == true
+		solveRequired=implicitSolveRequired(fieldIndex);
+		#endif
+		if (solveRequired){
+			#if nonlinearEllipticSolve == true
+			//Newton-Krylov solve
+			unsigned int solverSteps=solveNonlinearIncrement(fieldIndex);
+			#if adaptiveImplicitSolves == true
+			recordImplicitSolve(fieldIndex, residualSet[fieldIndex]->l2_norm(), solverSteps);
+			#endif
+			#elif spectralElasticity == true
+			//FFT-based spectral elasticity solve
+			solveSpectralElasticity(fieldIndex);
+			#else
 			//apply Dirichlet BC's
-			for (std::map<types::global_dof_index, double>::const_iterator it=valuesDirichletSet[fieldIndex]->begin(); it!=valuesDirichletSet[fieldIndex]->end(); ++it){
-				if (residualSet[fieldIndex]->in_local_range(it->first)){
-					(*residualSet[fieldIndex])(it->first) = it->second; //*jacobianDiagonal(it->first);
-				}
+			for (unsigned int i=0; i<dirichletLocalIndicesSet[fieldIndex].size(); i++){
+				residualSet[fieldIndex]->local_element(dirichletLocalIndicesSet[fieldIndex][i]) = dirichletLocalValuesSet[fieldIndex][i];
 			}
 	
 			//solver controls
 			#if absTol == true
-			SolverControl solver_control(maxSolverIterations, solverTolerance);
+			double tolerance=solverTolerance;
 			#else
-			SolverControl solver_control(maxSolverIterations, solverTolerance*residualSet[fieldIndex]->l2_norm());
+			double tolerance=solverTolerance*residualSet[fieldIndex]->l2_norm();
+			#endif
+			#if adaptiveImplicitSolves == true
+			tolerance=implicitSolveTolerance(tolerance);
 			#endif
+			SolverControl solver_control(maxSolverIterations, tolerance);
 			solverType<vectorType> solver(solver_control);
+
+			//precompute the parts of the LHS that are constant during the solve
+			prepareLHS(fieldIndex);
 	
 			//solve
 			try{
@@ -83,7 +109,15 @@ void MatrixFreePDE<dim>::solveIncrement(){
 					solver_control.last_value(),				\
 					solver_control.last_step(), solver_control.tolerance(), solutionSet[fieldIndex]->l2_norm(), dU.l2_norm());
 			pcout<<buffer;
+			#if adaptiveImplicitSolves == true
+			recordImplicitSolve(fieldIndex, solver_control.last_value(), solver_control.last_step());
+			#endif
+			#endif
+
+			//update the quantities derived from the field
+			ellipticFieldUpdated(fieldIndex);
 		}
+		#if adaptiveImplicitSolves != true
 		else{
 			sprintf(buffer, "field '%2s' [implicit solve]: current residual:%12.6e\n", \
 					fields[fieldIndex].name.c_str(),			\
@@ -91,6 +125,7 @@ void MatrixFreePDE<dim>::solveIncrement(){
 			pcout<<buffer;
 			pcout << "skipping implicit solve as currentIncrement%skipImplicitSolves!=0\n";
 		}
+		#endif
 
 		#else
 		pcout << "\nError: solverType not defined. This is required for ELLIPTIC fields.\n\n";
@@ -113,6 +148,9 @@ void MatrixFreePDE<dim>::solveIncrement(){
 		  exit(-1);
 	  }
   }
+#if adaptiveImplicitSolves == true
+  updateParabolicUpdateMagnitude();
+#endif
   pcout << "wall time: " << time.wall_time() << "s\n";
   //log time
   computing_timer.exit_section("matrixFreePDE: solveIncrements"); 
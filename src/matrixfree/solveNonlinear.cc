@@ -0,0 +1,190 @@
+//solveNonlinearIncrement() method for MatrixFreePDE class
+
+#ifndef SOLVENONLINEAR_MATRIXFREE_H
+#define SOLVENONLINEAR_MATRIXFREE_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+//Matrix-free finite difference approximation of the Jacobian action. The residual
+//computed by residualRHS is of the form R(u)=b-A(u), so the action of the Jacobian
+//of A(u) on a direction v is approximated by (R(u)-R(u+epsilon*v))/epsilon
+template <int dim>
+class MatrixFreePDE<dim>::JacobianFreeOperator{
+ public:
+  JacobianFreeOperator(MatrixFreePDE<dim> &_pde, unsigned int _fieldIndex, const vectorType &_baseResidual):
+    pde(_pde), fieldIndex(_fieldIndex), baseResidual(_baseResidual)
+  {
+    pde.matrixFreeObject.initialize_dof_vector(baseSolution, fieldIndex);
+    pde.matrixFreeObject.initialize_dof_vector(direction, fieldIndex);
+    baseSolution=*pde.solutionSet[fieldIndex];
+    baseSolutionNorm=baseSolution.l2_norm();
+  }
+
+  void vmult (vectorType &dst, const vectorType &src) const{
+    //set Dirichlet nodes of the direction to zero (same as in MatrixFreePDE::vmult)
+    const std::vector<unsigned int> &dirichletLocalIndices=pde.dirichletLocalIndicesSet[fieldIndex];
+    direction=src;
+    for (unsigned int i=0; i<dirichletLocalIndices.size(); i++){
+      direction.local_element(dirichletLocalIndices[i]) = 0.0;
+    }
+    double directionNorm=direction.l2_norm();
+    if (directionNorm==0.0){
+      dst=src;
+      return;
+    }
+
+    //perturbation size (square root of the machine precision, scaled by the solution magnitude)
+    const double epsilon=std::sqrt(std::numeric_limits<double>::epsilon())*(1.0+baseSolutionNorm)/directionNorm;
+
+    //evaluate the residual at the perturbed solution
+    vectorType &solution=*pde.solutionSet[fieldIndex];
+    solution=baseSolution;
+    solution.add(epsilon, direction);
+    pde.constraintsHangingNodesSet[fieldIndex]->distribute(solution);
+    solution.update_ghost_values();
+    pde.computeFieldRHS(fieldIndex);
+
+    //finite difference of the residuals
+    dst=baseResidual;
+    dst-=*pde.residualSet[fieldIndex];
+    dst*=(1.0/epsilon);
+
+    //Account for Dirichlet BC's (identity rows)
+    for (unsigned int i=0; i<dirichletLocalIndices.size(); i++){
+      dst.local_element(dirichletLocalIndices[i]) = src.local_element(dirichletLocalIndices[i]);
+    }
+
+    //restore the unperturbed solution
+    solution=baseSolution;
+    solution.update_ghost_values();
+  }
+
+ private:
+  MatrixFreePDE<dim> &pde;
+  unsigned int fieldIndex;
+  const vectorType &baseResidual;
+  vectorType baseSolution;
+  mutable vectorType direction;
+  double baseSolutionNorm;
+};
+
+//evaluate the nonlinear residual of an elliptic field at the current solution
+template <int dim>
+double MatrixFreePDE<dim>::computeNonlinearResidual(unsigned int fieldIndex){
+  computeRHS();
+
+  //Dirichlet rows hold the mismatch between the BC value and the current solution
+  for (unsigned int i=0; i<dirichletLocalIndicesSet[fieldIndex].size(); i++){
+    const unsigned int dof=dirichletLocalIndicesSet[fieldIndex][i];
+    residualSet[fieldIndex]->local_element(dof) = dirichletLocalValuesSet[fieldIndex][i]-solutionSet[fieldIndex]->local_element(dof);
+  }
+  return residualSet[fieldIndex]->l2_norm();
+}
+
+//inexact Newton-Krylov solve of a nonlinear elliptic field, with Eisenstat-Walker
+//forcing terms and a backtracking line search on the residual norm
+template <int dim>
+unsigned int MatrixFreePDE<dim>::solveNonlinearIncrement(unsigned int fieldIndex){
+  //residualLHS is linearized about the Krylov direction only (not about the current solution), so the Jacobian action of
+  //a nonlinear residual is only available by finite differences
+#if jacobianFreeNewton == false
+  pcout << "\nError: nonlinearEllipticSolve requires jacobianFreeNewton to be true.\n";
+  exit(-1);
+#endif
+
+  computing_timer.enter_section("matrixFreePDE: solveNonlinearIncrement");
+  char buffer[200];
+  currentFieldIndex=fieldIndex;
+
+  //computeRHS() refreshes every residual vector, so keep the ones of the fields yet to be updated in this increment
+  std::vector<vectorType> pendingResiduals(fields.size());
+  for (unsigned int i=fieldIndex+1; i<fields.size(); i++){
+    pendingResiduals[i]=*residualSet[i];
+  }
+
+  //Eisenstat-Walker (choice 2) forcing term parameters
+  const double etaInitial=0.5, etaMax=0.9, gamma=0.9, alpha=2.0;
+  //line search parameters
+  const double sufficientDecrease=1.0e-4, minStep=1.0/1024.0;
+
+  vectorType newtonResidual, previousSolution;
+  matrixFreeObject.initialize_dof_vector(newtonResidual, fieldIndex);
+  matrixFreeObject.initialize_dof_vector(previousSolution, fieldIndex);
+
+  double residualNorm=computeNonlinearResidual(fieldIndex);
+  const double initialResidualNorm=residualNorm;
+#if absTol == true
+  const double tolerance=newtonTolerance;
+#else
+  const double tolerance=newtonTolerance*initialResidualNorm;
+#endif
+  double eta=etaInitial;
+  unsigned int newtonIteration=0, totalLinearSteps=0;
+
+  while ((residualNorm>tolerance) && (newtonIteration<maxNewtonIterations)){
+    newtonIteration++;
+    newtonResidual=*residualSet[fieldIndex];
+
+    //inexact linear solve for the Newton step
+    SolverControl solver_control(maxSolverIterations, eta*residualNorm);
+    try{
+      dU=0;
+      JacobianFreeOperator jacobian(*this, fieldIndex, newtonResidual);
+      SolverGMRES<vectorType> solver(solver_control);
+      solver.solve(jacobian, dU, newtonResidual, IdentityMatrix(solutionSet[fieldIndex]->size()));
+    }
+    catch (...) {
+      pcout << "\nWarning: linear solver did not reach the Newton forcing tolerance. consider increasing maxSolverIterations.\n";
+    }
+    totalLinearSteps+=solver_control.last_step();
+
+    //backtracking line search
+    previousSolution=*solutionSet[fieldIndex];
+    double stepLength=1.0, trialResidualNorm;
+    while (true){
+      *solutionSet[fieldIndex]=previousSolution;
+      solutionSet[fieldIndex]->add(stepLength, dU);
+      constraintsHangingNodesSet[fieldIndex]->distribute(*solutionSet[fieldIndex]);
+      solutionSet[fieldIndex]->update_ghost_values();
+      trialResidualNorm=computeNonlinearResidual(fieldIndex);
+      if ((trialResidualNorm<=(1.0-sufficientDecrease*stepLength)*residualNorm) || (stepLength<=minStep)){
+	break;
+      }
+      stepLength*=0.5;
+    }
+    if (trialResidualNorm>residualNorm){
+      pcout << "\nWarning: Newton line search failed to reduce the residual. accepting the minimum step.\n";
+    }
+
+    //Eisenstat-Walker update of the forcing term, safeguarded against oversolving
+    double etaNew=gamma*std::pow(trialResidualNorm/residualNorm, alpha);
+    if (gamma*std::pow(eta, alpha)>0.1){
+      etaNew=std::max(etaNew, gamma*std::pow(eta, alpha));
+    }
+    eta=std::max(std::min(etaNew, etaMax), 0.5*tolerance/trialResidualNorm);
+    eta=std::min(eta, etaMax);
+
+    sprintf(buffer, "field '%2s' [Newton iteration %2u]: residual:%12.6e, linear steps:%u, step length:%8.4f, next forcing term:%10.4e\n", \
+	    fields[fieldIndex].name.c_str(), newtonIteration, trialResidualNorm, \
+	    solver_control.last_step(), stepLength, eta);
+    pcout<<buffer;
+    residualNorm=trialResidualNorm;
+  }
+
+  if (residualNorm>tolerance){
+    pcout << "\nWarning: Newton iteration did not converge as per set tolerances. consider increasing maxNewtonIterations or newtonTolerance.\n";
+  }
+  sprintf(buffer, "field '%2s' [nonlinear implicit solve]: initial residual:%12.6e, current residual:%12.6e, Newton iterations:%u, linear steps:%u, solution: %12.6e\n", \
+	  fields[fieldIndex].name.c_str(), initialResidualNorm, residualNorm, newtonIteration, totalLinearSteps, solutionSet[fieldIndex]->l2_norm());
+  pcout<<buffer;
+
+  //restore the residuals of the remaining fields
+  for (unsigned int i=fieldIndex+1; i<fields.size(); i++){
+    *residualSet[i]=pendingResiduals[i];
+  }
+
+  computing_timer.exit_section("matrixFreePDE: solveNonlinearIncrement");
+  return totalLinearSteps;
+}
+
+#endif
@@ -0,0 +1,118 @@
+//spectral elasticity backend methods for MatrixFreePDE class
+
+#ifndef SPECTRALELASTICITY_MATRIXFREE_H
+#define SPECTRALELASTICITY_MATRIXFREE_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+//default implementation of the reference stiffness, to be provided by the mechanics models
+template <int dim>
+void MatrixFreePDE<dim>::getReferenceStiffness(dealii::Table<2, double> &CIJ){
+  pcout << "\nError: spectralElasticity.cc: getReferenceStiffness() not implemented in the derived class, but is called\n";
+  exit(-1);
+}
+
+//map the elliptic field onto the structured grid of the spectral solver (called after each init())
+template <int dim>
+void MatrixFreePDE<dim>::initSpectralElasticity(){
+  if (!isEllipticBVP){
+    return;
+  }
+#if hAdaptivity == true
+  pcout << "\nError: the spectral elasticity backend requires a uniform mesh (hAdaptivity false)\n";
+  exit(-1);
+#endif
+  dealii::Table<2, double> CIJ;
+  getReferenceStiffness(CIJ);
+  spectralSolver.reinit(*dofHandlersSet[ellipticFieldIndex], CIJ, *valuesDirichletSet[ellipticFieldIndex], pcout);
+}
+
+//solve an elliptic (mechanics) field with the spectral backend. The Khachaturyan solution for
+//the reference stiffness is refined by fixed-point iterations on the residual of the actual
+//operator; if these stagnate (strongly heterogeneous moduli) the solve is finished with CG,
+//using the spectral operator as the preconditioner. Returns the number of iterations.
+template <int dim>
+unsigned int MatrixFreePDE<dim>::solveSpectralElasticity(unsigned int fieldIndex){
+  computing_timer.enter_section("matrixFreePDE: solveSpectralElasticity");
+  char buffer[200];
+  currentFieldIndex=fieldIndex;
+  prepareLHS(fieldIndex);
+  vectorType &residual=*residualSet[fieldIndex];
+
+  //apply Dirichlet BC's
+  for (unsigned int i=0; i<dirichletLocalIndicesSet[fieldIndex].size(); i++){
+    residual.local_element(dirichletLocalIndicesSet[fieldIndex][i]) = dirichletLocalValuesSet[fieldIndex][i];
+  }
+
+  //solver tolerance
+  const double initialResidualNorm=residual.l2_norm();
+#if absTol == true
+  double tolerance=solverTolerance;
+#else
+  double tolerance=solverTolerance*initialResidualNorm;
+#endif
+#if adaptiveImplicitSolves == true
+  tolerance=implicitSolveTolerance(tolerance);
+#endif
+
+  vectorType operatorResidual, correction;
+  matrixFreeObject.initialize_dof_vector(operatorResidual, fieldIndex);
+  matrixFreeObject.initialize_dof_vector(correction, fieldIndex);
+
+  //Khachaturyan solution for the reference stiffness
+  spectralSolver.vmult(dU, residual);
+
+  //fixed-point iterations
+  unsigned int fixedPointIterations=1, cgIterations=0;
+  double residualNorm, previousResidualNorm=initialResidualNorm;
+  bool converged=false;
+  while (true){
+    vmult(operatorResidual, dU);
+    operatorResidual.sadd(-1.0, 1.0, residual);
+    residualNorm=operatorResidual.l2_norm();
+    if (residualNorm<=tolerance){
+      converged=true;
+      break;
+    }
+    if ((fixedPointIterations>=maxSpectralIterations) || (residualNorm>=previousResidualNorm)){
+      break;
+    }
+    spectralSolver.vmult(correction, operatorResidual);
+    dU+=correction;
+    previousResidualNorm=residualNorm;
+    fixedPointIterations++;
+  }
+
+  //finish with preconditioned CG
+  if (!converged){
+    SolverControl solver_control(maxSolverIterations, tolerance);
+    SolverCG<vectorType> solver(solver_control);
+    try{
+      solver.solve(*this, dU, residual, spectralSolver);
+    }
+    catch (...) {
+      pcout << "\nWarning: implicit solver did not converge as per set tolerances. consider increasing maxSolverIterations or decreasing solverTolerance.\n";
+    }
+    cgIterations=solver_control.last_step();
+    residualNorm=solver_control.last_value();
+  }
+  *solutionSet[fieldIndex]+=dU;
+
+  //apply constraints
+  constraintsHangingNodesSet[fieldIndex]->distribute(*solutionSet[fieldIndex]);
+  //sync ghost DOF's
+  solutionSet[fieldIndex]->update_ghost_values();
+
+  sprintf(buffer, "field '%2s' [spectral implicit solve]: initial residual:%12.6e, current residual:%12.6e, fixed-point steps:%u, CG steps:%u, tolerance criterion:%12.6e, solution: %12.6e\n", \
+	  fields[fieldIndex].name.c_str(), initialResidualNorm, residualNorm, fixedPointIterations, cgIterations, \
+	  tolerance, solutionSet[fieldIndex]->l2_norm());
+  pcout<<buffer;
+#if adaptiveImplicitSolves == true
+  recordImplicitSolve(fieldIndex, residualNorm, fixedPointIterations+cgIterations);
+#endif
+
+  computing_timer.exit_section("matrixFreePDE: solveSpectralElasticity");
+  return fixedPointIterations+cgIterations;
+}
+
+#endif
@@ -0,0 +1,296 @@
+//vectorized kernels for anisotropic interfacial energies
+#ifndef INTERFACIALANISOTROPY_H
+#define INTERFACIALANISOTROPY_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+//The interfacial energy gamma(normal) depends on the direction of the unit normal
+//normal = grad(n)/|grad(n)| of an order parameter n. The gradient energy is
+//0.5*gamma^2*|grad(n)|^2 and the corresponding term of the Allen-Cahn residual (multiplied
+//by the gradient of the test function) is
+//  gamma*( |grad(n)|*(I - normal (x) normal)*dgamma/dnormal + gamma*grad(n) )
+//which is computed by anisotropicGradientFlux(). The forms of gamma are classes with an
+//evaluate() method that returns gamma and dgamma/dnormal for a batch of normals. The
+//constants are precomputed in the constructors and evaluate() has no branches on the
+//values, so the kernels run on all lanes of the VectorizedArray at once (except the
+//angle lookup of tabulatedAnisotropy). Example of use in residualRHS in equations.h:
+//
+//  static const cubicAnisotropy<dim> anisotropy(epsilonM);
+//  scalargradType aniso = anisotropicGradientFlux(anisotropy, nx);
+//
+//The anisotropy objects are constructed once (static) since the constructors precompute the
+//constants, e.g. the spline coefficients of tabulatedAnisotropy.
+//
+//Available forms:
+//cubicAnisotropy       - gamma = 1 + epsilon*(4*sum(n_i^4) - 3) [+ epsilon2*(3*sum(n_i^4) + 66*n_x^2*n_y^2*n_z^2 - 17/7) in 3D]
+//hexagonalAnisotropy   - gamma = 1 + epsilon6*cos(6*(phi - phi0)) [+ epsilon2*(3*n_z^2 - 1)/2 in 3D], with phi the
+//                        angle of the normal in the x-y plane (in 3D, the term is weighted by sin(theta)^6)
+//harmonicAnisotropy    - gamma = 1 + sum_k epsilon_k*cos(m_k*(phi - phi_k)), a general Fourier expansion in phi
+//                        (in 3D, each term is weighted by sin(theta)^m_k)
+//tabulatedAnisotropy   - gamma(phi) interpolated from values at evenly spaced angles with periodic cubic splines (2D only)
+//In 1D the interfacial energy is isotropic.
+
+#include <vector>
+#include <cmath>
+
+typedef dealii::VectorizedArray<double> anisotropyScalar;
+
+//In the bulk, where the gradient vanishes, the normal is not defined. The squared gradient
+//norm is bounded from below by this value when normalizing, which keeps the normal finite.
+//All the anisotropic terms are multiplied by the gradient, so they vanish there regardless
+const double anisotropyNormalizationThreshold = 1.0e-24;
+
+inline anisotropyScalar anisotropyConstant(const double value){
+	anisotropyScalar result;
+	result = value;
+	return result;
+}
+
+// =================================================================================
+// cubic (4-fold in 2D, octahedral in 3D) anisotropy
+// =================================================================================
+template <int dim>
+class cubicAnisotropy
+{
+ public:
+	cubicAnisotropy(const double _epsilon, const double _epsilon2=0.0):
+		gamma_0(1.0-3.0*_epsilon-(dim==3 ? 17.0/7.0*_epsilon2 : 0.0)), c_4(4.0*_epsilon+(dim==3 ? 3.0*_epsilon2 : 0.0)),
+		c_6(dim==3 ? 66.0*_epsilon2 : 0.0){}
+
+	void evaluate(const dealii::Tensor<1,dim,anisotropyScalar> &normal, anisotropyScalar &gamma,
+			dealii::Tensor<1,dim,anisotropyScalar> &dgammadnormal) const{
+		dealii::Tensor<1,dim,anisotropyScalar> normal_sqr;
+		anisotropyScalar sum_4 = anisotropyConstant(0.0);
+		for (unsigned int i=0; i<dim; i++){
+			normal_sqr[i] = normal[i]*normal[i];
+			sum_4 += normal_sqr[i]*normal_sqr[i];
+			dgammadnormal[i] = (4.0*c_4)*normal_sqr[i]*normal[i];
+		}
+		gamma = gamma_0 + c_4*sum_4;
+		if (dim == 3){
+			gamma += c_6*normal_sqr[0]*normal_sqr[1]*normal_sqr[2];
+			dgammadnormal[0] += (2.0*c_6)*normal[0]*normal_sqr[1]*normal_sqr[2];
+			dgammadnormal[1] += (2.0*c_6)*normal_sqr[0]*normal[1]*normal_sqr[2];
+			dgammadnormal[2] += (2.0*c_6)*normal_sqr[0]*normal_sqr[1]*normal[2];
+		}
+	}
+
+ private:
+	double gamma_0, c_4, c_6;
+};
+
+// =================================================================================
+// hexagonal (6-fold) anisotropy
+// =================================================================================
+template <int dim>
+class hexagonalAnisotropy
+{
+ public:
+	hexagonalAnisotropy(const double _epsilon6, const double _rotation=0.0, const double _epsilon2=0.0):
+		epsilon6(_epsilon6), epsilon2(_epsilon2), cos_rotation(std::cos(_rotation)), sin_rotation(std::sin(_rotation)){}
+
+	void evaluate(const dealii::Tensor<1,dim,anisotropyScalar> &normal, anisotropyScalar &gamma,
+			dealii::Tensor<1,dim,anisotropyScalar> &dgammadnormal) const{
+		//components of the normal in the frame of the crystal
+		const anisotropyScalar x = cos_rotation*normal[0] + sin_rotation*normal[1];
+		const anisotropyScalar y = cos_rotation*normal[1] - sin_rotation*normal[0];
+		const anisotropyScalar x2 = x*x, y2 = y*y;
+		const anisotropyScalar x4 = x2*x2, y4 = y2*y2;
+
+		//Re((x+iy)^6) and its derivatives
+		gamma = 1.0 + epsilon6*(x4*x2 - 15.0*x4*y2 + 15.0*x2*y4 - y4*y2);
+		const anisotropyScalar dx = epsilon6*x*(6.0*x4 - 60.0*x2*y2 + 30.0*y4);
+		const anisotropyScalar dy = epsilon6*y*(-30.0*x4 + 60.0*x2*y2 - 6.0*y4);
+		dgammadnormal[0] = cos_rotation*dx - sin_rotation*dy;
+		dgammadnormal[1] = sin_rotation*dx + cos_rotation*dy;
+		if (dim == 3){
+			gamma += (1.5*epsilon2)*normal[dim-1]*normal[dim-1] - 0.5*epsilon2;
+			dgammadnormal[dim-1] = (3.0*epsilon2)*normal[dim-1];
+		}
+	}
+
+ private:
+	double epsilon6, epsilon2, cos_rotation, sin_rotation;
+};
+
+// =================================================================================
+// general harmonic expansion in the angle of the normal in the x-y plane
+// =================================================================================
+template <int dim>
+class harmonicAnisotropy
+{
+ public:
+	//modes m_k, amplitudes epsilon_k and phases phi_k of the terms
+	harmonicAnisotropy(const std::vector<unsigned int> &_modes, const std::vector<double> &_amplitudes,
+			const std::vector<double> &_phases=std::vector<double>()): max_mode(0){
+		if ((_amplitudes.size() != _modes.size()) || ((_phases.size() > 0) && (_phases.size() != _modes.size()))){
+			std::cout << "\nharmonicAnisotropy: the number of amplitudes and phases must be equal to the number of modes\n";
+			exit(-1);
+		}
+		for (unsigned int k=0; k<_modes.size(); k++){
+			max_mode = std::max(max_mode, _modes[k]);
+		}
+		//epsilon_k*cos(m_k*(phi-phi_k)) = a_k*Re((nx+i*ny)^m_k) + b_k*Im((nx+i*ny)^m_k), summed by mode
+		cos_coefficients.assign(max_mode+1, 0.0);
+		sin_coefficients.assign(max_mode+1, 0.0);
+		for (unsigned int k=0; k<_modes.size(); k++){
+			double phase = (_phases.size() > 0) ? _modes[k]*_phases[k] : 0.0;
+			cos_coefficients[_modes[k]] += _amplitudes[k]*std::cos(phase);
+			sin_coefficients[_modes[k]] += _amplitudes[k]*std::sin(phase);
+		}
+	}
+
+	void evaluate(const dealii::Tensor<1,dim,anisotropyScalar> &normal, anisotropyScalar &gamma,
+			dealii::Tensor<1,dim,anisotropyScalar> &dgammadnormal) const{
+		//powers z^m = (nx+i*ny)^m by complex multiplication. d(z^m)/dnx = m*z^(m-1), d(z^m)/dny = i*m*z^(m-1)
+		anisotropyScalar re = anisotropyConstant(1.0), im = anisotropyConstant(0.0);
+		gamma = 1.0 + cos_coefficients[0];
+		dgammadnormal = dealii::Tensor<1,dim,anisotropyScalar>();
+		for (unsigned int m=1; m<=max_mode; m++){
+			//re, im hold z^(m-1)
+			dgammadnormal[0] += (m*cos_coefficients[m])*re + (m*sin_coefficients[m])*im;
+			dgammadnormal[1] += (m*sin_coefficients[m])*re - (m*cos_coefficients[m])*im;
+			const anisotropyScalar re_next = re*normal[0] - im*normal[1];
+			im = re*normal[1] + im*normal[0];
+			re = re_next;
+			gamma += cos_coefficients[m]*re + sin_coefficients[m]*im;
+		}
+	}
+
+ private:
+	unsigned int max_mode;
+	std::vector<double> cos_coefficients, sin_coefficients;
+};
+
+// =================================================================================
+// tabulated anisotropy gamma(phi)
+// =================================================================================
+template <int dim>
+class tabulatedAnisotropy
+{
+ public:
+	//values of gamma at the angles phi_j = 2*pi*j/N, j=0..N-1
+	tabulatedAnisotropy(const std::vector<double> &_gamma_values){
+		if (dim != 2){
+			std::cout << "\ntabulatedAnisotropy: tabulated anisotropy is only implemented in 2D\n";
+			exit(-1);
+		}
+		const unsigned int n = _gamma_values.size();
+		if (n < 3){
+			std::cout << "\ntabulatedAnisotropy: at least 3 tabulated values are needed\n";
+			exit(-1);
+		}
+		spacing = 2.0*dealii::numbers::PI/n;
+		inv_spacing = 1.0/spacing;
+
+		//periodic cubic spline: second derivatives from the cyclic tridiagonal system
+		//M_{j-1} + 4*M_j + M_{j+1} = 6*(g_{j+1} - 2*g_j + g_{j-1})/h^2, solved by Gauss-Seidel (diagonally dominant)
+		std::vector<double> second(n, 0.0);
+		for (unsigned int iteration=0; iteration<200; iteration++){
+			double change = 0.0;
+			for (unsigned int j=0; j<n; j++){
+				const unsigned int jm = (j+n-1)%n, jp = (j+1)%n;
+				double value = (6.0*(_gamma_values[jp]-2.0*_gamma_values[j]+_gamma_values[jm])*inv_spacing*inv_spacing
+						- second[jm] - second[jp])/4.0;
+				change = std::max(change, std::abs(value-second[j]));
+				second[j] = value;
+			}
+			if (change < 1.0e-14){
+				break;
+			}
+		}
+
+		//coefficients of the cubic in each interval, in the local coordinate t = phi - phi_j (with one
+		//padding interval so that the lookup of phi = pi needs no wrap around)
+		coefficients.resize(4*(n+1));
+		for (unsigned int j=0; j<=n; j++){
+			const unsigned int j0 = j%n, j1 = (j+1)%n;
+			coefficients[4*j] = _gamma_values[j0];
+			coefficients[4*j+1] = (_gamma_values[j1]-_gamma_values[j0])*inv_spacing - spacing*(2.0*second[j0]+second[j1])/6.0;
+			coefficients[4*j+2] = 0.5*second[j0];
+			coefficients[4*j+3] = (second[j1]-second[j0])*inv_spacing/6.0;
+		}
+		num_intervals = n;
+	}
+
+	void evaluate(const dealii::Tensor<1,dim,anisotropyScalar> &normal, anisotropyScalar &gamma,
+			dealii::Tensor<1,dim,anisotropyScalar> &dgammadnormal) const{
+		anisotropyScalar dgammadphi;
+		for (unsigned int v=0; v<anisotropyScalar::n_array_elements; v++){
+			double phi = std::atan2(normal[1][v], normal[0][v]);
+			if (phi < 0.0){
+				phi += 2.0*dealii::numbers::PI;
+			}
+			unsigned int j = std::min((unsigned int)(phi*inv_spacing), num_intervals);
+			const double t = phi - j*spacing;
+			const double *c = &coefficients[4*j];
+			gamma[v] = c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+			dgammadphi[v] = c[1] + t*(2.0*c[2] + t*3.0*c[3]);
+		}
+		//dphi/dnormal = (-ny, nx) for a unit normal
+		dgammadnormal[0] = dgammadphi*(0.0-normal[1]);
+		dgammadnormal[1] = dgammadphi*normal[0];
+	}
+
+ private:
+	double spacing, inv_spacing;
+	unsigned int num_intervals;
+	std::vector<double> coefficients;
+};
+
+// =================================================================================
+// gradient flux and gradient energy of the anisotropic interface
+// =================================================================================
+//gamma*( |grad(n)|*(I - normal (x) normal)*dgamma/dnormal + gamma*grad(n) ). The value of gamma is
+//returned in gamma_value, e.g. for an anisotropic mobility
+template <int dim, typename anisotropyType>
+inline dealii::Tensor<1,dim,anisotropyScalar> anisotropicGradientFlux(const anisotropyType &anisotropy,
+		const dealii::Tensor<1,dim,anisotropyScalar> &nx, anisotropyScalar &gamma_value){
+	const anisotropyScalar grad_norm_sqr = nx.norm_square();
+	const anisotropyScalar inv_grad_norm = vectorizedMath::invsqrt(std::max(grad_norm_sqr, anisotropyConstant(anisotropyNormalizationThreshold)));
+	const dealii::Tensor<1,dim,anisotropyScalar> normal = nx*inv_grad_norm;
+
+	dealii::Tensor<1,dim,anisotropyScalar> dgammadnormal;
+	anisotropy.evaluate(normal, gamma_value, dgammadnormal);
+
+	//projection of dgamma/dnormal onto the plane normal to the interface normal
+	const dealii::Tensor<1,dim,anisotropyScalar> tangential = dgammadnormal - normal*(normal*dgammadnormal);
+	return gamma_value*(tangential*(grad_norm_sqr*inv_grad_norm) + gamma_value*nx);
+}
+
+template <int dim, typename anisotropyType>
+inline dealii::Tensor<1,dim,anisotropyScalar> anisotropicGradientFlux(const anisotropyType &anisotropy,
+		const dealii::Tensor<1,dim,anisotropyScalar> &nx){
+	anisotropyScalar gamma_value;
+	return anisotropicGradientFlux(anisotropy, nx, gamma_value);
+}
+
+//0.5*gamma^2*|grad(n)|^2
+template <int dim, typename anisotropyType>
+inline anisotropyScalar anisotropicGradientEnergy(const anisotropyType &anisotropy, const dealii::Tensor<1,dim,anisotropyScalar> &nx){
+	const anisotropyScalar grad_norm_sqr = nx.norm_square();
+	const anisotropyScalar inv_grad_norm = vectorizedMath::invsqrt(std::max(grad_norm_sqr, anisotropyConstant(anisotropyNormalizationThreshold)));
+	anisotropyScalar gamma;
+	dealii::Tensor<1,dim,anisotropyScalar> dgammadnormal;
+	anisotropy.evaluate(nx*inv_grad_norm, gamma, dgammadnormal);
+	return 0.5*gamma*gamma*grad_norm_sqr;
+}
+
+//1D (gradients are scalars): isotropic
+template <typename anisotropyType>
+inline anisotropyScalar anisotropicGradientFlux(const anisotropyType &anisotropy, const anisotropyScalar &nx, anisotropyScalar &gamma_value){
+	gamma_value = 1.0;
+	return nx;
+}
+
+template <typename anisotropyType>
+inline anisotropyScalar anisotropicGradientFlux(const anisotropyType &anisotropy, const anisotropyScalar &nx){
+	return nx;
+}
+
+template <typename anisotropyType>
+inline anisotropyScalar anisotropicGradientEnergy(const anisotropyType &anisotropy, const anisotropyScalar &nx){
+	return 0.5*nx*nx;
+}
+
+#endif
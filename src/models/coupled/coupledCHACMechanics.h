@@ -673,6 +673,9 @@ std::vector<nucleus> nuclei, localNuclei;
 template <int dim>
 void CoupledCHACMechanicsProblem<dim>::modifySolutionFields()
 {
+  //called on every increment (see solveIncrement)
+  if (nucleation_occurs == false) return;
+
   //current time
   double t=this->currentTime;
   unsigned int inc=this->currentIncrement;
@@ -6,6 +6,9 @@
 
 //material models
 #include "../mechanics/computeStress.h"
+#include "../anisotropy/interfacialAnisotropy.h"
+#include "structuredGrid.h"
+#include "grainRemapping.h"
 
 // BC object declaration
 template <int dim>
@@ -68,10 +71,12 @@ class generalizedProblem: public MatrixFreePDE<dim>
   // Elasticity matrix variables
   const static unsigned int CIJ_tensor_size = 2*dim-1+dim/3;
   std::vector<dealii::Tensor<2, CIJ_tensor_size, dealii::VectorizedArray<double> > > CIJ_list;
+  // Stiffness of each material with its symmetry, for the specialized versions of computeStress
+  std::vector<elasticStiffness<dim> > stiffness_list;
 
   bool c_dependent_misfit;
 
-  Threads::Mutex assembler_lock;
+  mutable Threads::Mutex assembler_lock;
 
   // Variables needed to calculate the LHS
   std::vector<variable_info<dim>> varInfoListRHS;
@@ -81,6 +86,55 @@ class generalizedProblem: public MatrixFreePDE<dim>
   unsigned int num_var_LHS;
   std::vector<variable_info<dim>> varInfoListLHS;
 
+  // Scratch data of the cell range methods (FEEvaluation objects and model variables). One copy is kept per
+  // thread, reused across cell_loop calls and rebuilt in reinitCellScratch() after each init(). It is defined in
+  // generalized_model_functions.h, since the FEEvaluation types depend on the variables in equations.h
+  struct cellScratch;
+  std_cxx11::shared_ptr<Threads::ThreadLocalStorage<cellScratch> > cellScratchRHS, cellScratchLHS;
+
+  void reinitCellScratch();
+
+  // Cache of the LHS variables other than the solved field, at each quadrature point of each cell batch (see
+  // cacheLHSCoefficients). Built by prepareLHS() before each implicit solve and valid for that field and increment
+  std::vector<dealii::AlignedVector<dealii::VectorizedArray<double> > > LHSCache;
+  std::vector<unsigned int> LHSCacheComponents;
+  int LHSCacheFieldIndex;
+  unsigned int LHSCacheIncrement;
+  double LHSCacheReportedMemory;
+
+  void prepareLHS(unsigned int fieldIndex);
+  unsigned int countLHSCacheComponents(const variable_info<dim> &varInfo) const;
+  template <typename cacheType>
+  void copyLHSCache(modelVariable<dim> &modelVar, cacheType *cache, const variable_info<dim> &varInfo) const;
+
+  // Active set of the RHS cell loop (see activeSetSkipping). activeSetZeroUpdate is set by getRHS for the cell batches
+  // evaluated in full, and activeSetEvaluate (whether a cell batch is evaluated in full) is set by prepareRHS() from it
+  bool activeSetSupported, activeSetValid;
+  std::vector<std::vector<unsigned int> > activeSetNeighbors;
+  std::vector<unsigned char> activeSetAlwaysEvaluate, activeSetEvaluate;
+  mutable std::vector<unsigned char> activeSetZeroUpdate;
+
+  void prepareRHS();
+  void buildActiveSetNeighbors();
+
+  // Structured grid execution of the RHS on uniform meshes (see structuredGridRHS). structuredGridValid is set after each init()
+  // if the mesh is uniform and reset if the first evaluation on the mesh differs from the cell loop
+  bool structuredGridSupported, structuredGridValid, structuredGridChecked;
+  structuredGridLayout<dim> structuredGrid;
+
+  bool computeRHSStructured();
+  void getRHSStructured(unsigned int firstLayer, unsigned int lastLayer);
+
+  // L2 projections of the derivatives of the variables with a recovered Hessian (see recoveredHessians), recoveredGradients[i][d]
+  // for the derivative of variable i along d, and the inverse lumped mass matrix of their fields. recoveredGradientsValid is
+  // reset after each init() and the projections are recomputed after each solve of the variable
+  std::vector<std::vector<vectorType> > recoveredGradients;
+  std::vector<vectorType> recoveredGradientInvM;
+  bool recoveredGradientsValid;
+
+  void computeRecoveredGradients();
+  void ellipticFieldUpdated(unsigned int fieldIndex);
+
   //RHS implementation for explicit solve
   void getRHS(const MatrixFree<dim,double> &data, 
 	      std::vector<vectorType*> &dst, 
@@ -99,8 +153,13 @@ class generalizedProblem: public MatrixFreePDE<dim>
   //methods to apply dirichlet BC's on displacement
   void applyDirichletBCs();
 
-  // method to modify the fields for nucleation
+  // method to modify the fields for nucleation and grain remapping
   void modifySolutionFields();
+  void seedNuclei();
+
+  // Grains of the order parameters, moved to other order parameters by remapGrains() (see grainRemapping)
+  grainRemapper<dim> grainRemap;
+  void remapGrains();
 
   void computeIntegral(double& integratedField);
 
@@ -121,11 +180,20 @@ class generalizedProblem: public MatrixFreePDE<dim>
 														  dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) const;
 
   void energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value,
-		  	  	  	  	  	  	  	  	  	  	  	  	  dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc);
+		  	  	  	  	  	  	  	  	  	  	  	  	  dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+														  std::vector<dealii::VectorizedArray<double> > & energyComponents) const;
+
+  // Standard normal noise at the points of the lanes (q_point_loc in residualRHS, requires need_q_point_loc), for the current
+  // increment and a noise stream (one per noise term) - see randomNoise.h
+  dealii::VectorizedArray<double> gaussianNoise(const dealii::Point<dim, dealii::VectorizedArray<double> > &location,
+		  unsigned int stream=0) const;
 
   //AMR methods
   void adaptiveRefine(unsigned int currentIncrement);
   void adaptiveRefineCriterion();
 
+  //reference stiffness for the spectral elasticity backend (average of the CIJ_list entries)
+  void getReferenceStiffness(dealii::Table<2, double> &CIJ);
+
 };
 
@@ -1,3 +1,11 @@
+// If the application doesn't declare whether the residuals depend on the quadrature point locations, assume they do
+// (see defaultValues.h)
+#ifndef need_q_point_loc
+#define need_q_point_loc true
+#endif
+
+#include "generalized_model_layout.h"
+
 // =====================================================================
 // CONSTRUCTOR
 // =====================================================================
@@ -65,6 +73,9 @@ generalizedProblem<dim>::generalizedProblem(): MatrixFreePDE<dim>()
 		if (temp_mat_models[mater_num] == "ISOTROPIC"){
 			mat_model = ISOTROPIC;
 		}
+		else if (temp_mat_models[mater_num] == "CUBIC"){
+			mat_model = CUBIC;
+		}
 		else if (temp_mat_models[mater_num] == "TRANSVERSE"){
 			mat_model = TRANSVERSE;
 		}
@@ -76,11 +87,12 @@ generalizedProblem<dim>::generalizedProblem(): MatrixFreePDE<dim>()
 		}
 		else {
 			// Should change to an exception
-			std::cout << "Elastic material model is invalid, please use ISOTROPIC, TRANSVERSE, ORTHOTROPIC, or ANISOTROPIC" << std::endl;
+			std::cout << "Elastic material model is invalid, please use ISOTROPIC, CUBIC, TRANSVERSE, ORTHOTROPIC, or ANISOTROPIC" << std::endl;
 		}
 
 		getCIJMatrix<dim>(mat_model, temp_mat_consts[mater_num], CIJ_temp, this->pcout);
 		CIJ_list.push_back(CIJ_temp);
+		stiffness_list.push_back(elasticStiffness<dim>(mat_model, CIJ_temp));
 	}
 #endif
 
@@ -105,16 +117,84 @@ for (unsigned int i=0; i<dim; i++){
 	#define nucleation_occurs false
 #endif
 
+// The quadrature point locations are only computed and stored if the residuals need them
+this->needQuadraturePoints = need_q_point_loc;
+
+// Number of components of the energy density (by default chemical, gradient and elastic energy)
+#ifndef num_energy_components
+	#define num_energy_components 3
+#endif
+this->numEnergyComponents = num_energy_components;
+
+// The energy densities can be evaluated in the RHS cell loop (see fuseEnergyWithRHS)
+this->energyInRHSSupported = true;
+
+// The LHS coefficient cache is built before the first implicit solve
+LHSCacheFieldIndex = -1;
+LHSCacheIncrement = 0;
+LHSCacheReportedMemory = 0.0;
+
+// The active set of the RHS cell loop compares the value residuals with the values, so these have to be evaluated. Elliptic
+// fields are solved in every increment and would change the residuals of the skipped cell batches
+activeSetSupported = true;
+for (unsigned int i=0; i<num_var; i++){
+	if ((var_eq_type[i] == "ELLIPTIC") || (value_residual[i] && !need_value[i])){
+		activeSetSupported = false;
+	}
+}
+activeSetValid = false;
+#if activeSetSkipping == true
+if (!activeSetSupported){
+	this->pcout << "\nactiveSetSkipping needs the values of the fields with a value residual and no elliptic fields, all the cell batches are evaluated in full\n";
+}
+#endif
+
+// The structured grid needs identical cells and all the fields of finiteElementDegree (the degree of the quadrature). It
+// doesn't keep the active set of the RHS, which takes precedence, nor the active components of a sparse packed group, and
+// evaluates the Hessians directly
+structuredGridSupported = !variableLayout::isSparse && !variableLayout::anyRecovered(0);
+for (unsigned int i=0; i<num_var; i++){
+	if (variableLayout::degree(i) != finiteElementDegree){
+		structuredGridSupported = false;
+	}
+}
+#if hAdaptivity == true
+structuredGridSupported = false;
+#endif
+#if activeSetSkipping == true
+if (activeSetSupported){
+	structuredGridSupported = false;
+}
+#endif
+structuredGridValid = false;
+structuredGridChecked = false;
+
+// The recovered Hessians are computed on the first evaluation of the RHS
+recoveredGradientsValid = false;
+#if structuredGridRHS == true
+if (!structuredGridSupported){
+	this->pcout << "\nstructuredGridRHS needs a uniform mesh (hAdaptivity false), all the variables of finiteElementDegree, no active set, no sparse packed group and no recovered Hessians, the RHS is evaluated with the matrix free cell loop\n";
+}
+#endif
+
+// The variables of the packed group share a single field (see variableLayout::numPacked), which is updated explicitly, so
+// they have to be PARABOLIC and can't be needed in the LHS
+for (unsigned int i=0; i<num_var; i++){
+	if (variableLayout::isPacked(i) && ((var_eq_type[i] != "PARABOLIC") || need_value_LHS[i] || need_gradient_LHS[i] || need_hessian_LHS[i])){
+		this->pcout << "\nError: the variables of the packed group (packed_var_first and num_packed_var) must be PARABOLIC and not needed in the LHS\n";
+		exit(-1);
+	}
+}
+
 // Load variable information for calculating the RHS
 varInfoListRHS.reserve(num_var);
-unsigned int field_number = 0;
 unsigned int scalar_var_index = 0;
 unsigned int vector_var_index = 0;
 for (unsigned int i=0; i<num_var; i++){
 	variable_info<dim> varInfo;
 	if (need_value[i] or need_gradient[i] or need_hessian[i]){
 		varInfo.global_var_index = i;
-		varInfo.global_field_index = field_number;
+		varInfo.global_field_index = variableLayout::fieldIndex(i);
 		if (var_type[i] == "SCALAR"){
 			varInfo.is_scalar = true;
 			varInfo.scalar_or_vector_index = scalar_var_index;
@@ -127,13 +207,6 @@ for (unsigned int i=0; i<num_var; i++){
 		}
 		varInfoListRHS.push_back(varInfo);
 	}
-
-	if (var_type[i] == "SCALAR"){
-		field_number++;
-	}
-	else {
-		field_number+=dim;
-	}
 }
 
 // Load variable information for calculating the LHS
@@ -145,14 +218,13 @@ for (unsigned int i=0; i<num_var; i++){
 }
 
 varInfoListLHS.reserve(num_var_LHS);
-field_number = 0;
 scalar_var_index = 0;
 vector_var_index = 0;
 for (unsigned int i=0; i<num_var; i++){
 	variable_info<dim> varInfo;
 	if (need_value_LHS[i] or need_gradient_LHS[i] or need_hessian_LHS[i]){
 		varInfo.global_var_index = i;
-		varInfo.global_field_index = field_number;
+		varInfo.global_field_index = variableLayout::fieldIndex(i);
 		if (var_type[i] == "SCALAR"){
 			varInfo.is_scalar = true;
 			varInfo.scalar_or_vector_index = scalar_var_index;
@@ -165,13 +237,6 @@ for (unsigned int i=0; i<num_var; i++){
 		}
 		varInfoListLHS.push_back(varInfo);
 	}
-
-	if (var_type[i] == "SCALAR"){
-		field_number++;
-	}
-	else {
-		field_number+=dim;
-	}
 }
 
 }
@@ -181,6 +246,72 @@ for (unsigned int i=0; i<num_var; i++){
 // RESIDUAL CONSTRUCTION FUNCTIONS (RHS, LHS, ENERGY DENSITY)
 // =====================================================================
 
+// Scratch data of the cell range methods: one FEEvaluation object per field (of the degree of the variable, see
+// variableLayout::evaluator) and the model variables and residuals at a quadrature point
+template <int dim>
+struct generalizedProblem<dim>::cellScratch{
+	variableLayout::evaluatorList<dim,0,num_var> vars;
+	std::vector<modelVariable<dim> > modelVarList;
+	std::vector<modelResidual<dim> > modelResidualsList;
+
+	cellScratch(const MatrixFree<dim,double> &data): vars(data){}
+};
+
+// Build the per-thread scratch data used by getRHS, getLHS and getEnergy. The FEEvaluation objects
+// refer to the current matrixFreeObject, so this is called again after each init()
+template <int dim>
+void generalizedProblem<dim>::reinitCellScratch(){
+
+	// Projected derivatives of the variables with a recovered Hessian, on the fields of the new mesh
+	recoveredGradients.assign(num_var, std::vector<vectorType>());
+	recoveredGradientInvM.assign(num_var, vectorType());
+	for (unsigned int i=0; i<num_var; i++){
+		if (variableLayout::isRecovered(i)){
+			recoveredGradients[i].resize(dim);
+			for (unsigned int d=0; d<dim; d++){
+				this->matrixFreeObject.initialize_dof_vector(recoveredGradients[i][d], variableLayout::fieldIndex(i));
+			}
+			this->computeInvMComponents(recoveredGradientInvM[i], variableLayout::fieldIndex(i));
+		}
+	}
+	recoveredGradientsValid = false;
+
+	// Scratch data for getRHS and getEnergy
+	cellScratch scratchRHS(this->matrixFreeObject);
+	scratchRHS.modelVarList.resize(num_var);
+	scratchRHS.modelResidualsList.resize(num_var);
+	variableLayout::variableKernel<dim,0,num_var>::setRecoveredSources(scratchRHS.vars, recoveredGradients);
+
+	// Scratch data for getLHS (the model variables are the ones needed in the LHS)
+	cellScratch scratchLHS(this->matrixFreeObject);
+	scratchLHS.modelVarList.resize(num_var_LHS);
+	variableLayout::variableKernel<dim,0,num_var>::setRecoveredSources(scratchLHS.vars, recoveredGradients);
+
+	// The thread local copies are created from these exemplars the first time a thread runs a cell range
+	cellScratchRHS.reset(new Threads::ThreadLocalStorage<cellScratch>(scratchRHS));
+	cellScratchLHS.reset(new Threads::ThreadLocalStorage<cellScratch>(scratchLHS));
+
+	// The LHS coefficient cache refers to the cells of the previous mesh
+	LHSCacheFieldIndex = -1;
+	LHSCache.clear();
+
+	// The active set refers to the cell batches of the previous mesh
+	activeSetValid = false;
+	activeSetNeighbors.clear();
+
+	// Structured grid of the new mesh
+#if structuredGridRHS == true
+	if (structuredGridSupported){
+		structuredGridValid = structuredGrid.reinit(this->dofHandlersSet, this->solutionSet, this->pcout);
+		structuredGridChecked = false;
+	}
+#endif
+
+	char buffer[200];
+	sprintf(buffer, "cell scratch data: %u evaluators per thread for the RHS and for the LHS (%u variables in the LHS)\n", variableLayout::numFields, num_var_LHS);
+	this->pcout<<buffer;
+}
+
 template <int dim>
 void generalizedProblem<dim>::getRHS(const MatrixFree<dim,double> &data,
 					       std::vector<vectorType*> &dst,
@@ -188,224 +319,499 @@ void generalizedProblem<dim>::getRHS(const MatrixFree<dim,double> &data,
 					       const std::pair<unsigned int,unsigned int> &cell_range) const{
 
 
-  //initialize FEEvaulation objects
-  std::vector<typeScalar> scalar_vars;
-  std::vector<typeVector> vector_vars;
-
-  for (unsigned int i=0; i<num_var; i++){
-	  if (varInfoListRHS[i].is_scalar){
-		  typeScalar var(data, i);
-		  scalar_vars.push_back(var);
-	  }
-	  else {
-		  typeVector var(data, i);
-		  vector_vars.push_back(var);
-	  }
+  //FEEvaulation objects and model variables of this thread (built in reinitCellScratch)
+  cellScratch &scratch = cellScratchRHS->get();
+  variableLayout::evaluatorList<dim,0,num_var> &vars = scratch.vars;
+  std::vector<modelVariable<dim> > &modelVarList = scratch.modelVarList;
+  std::vector<modelResidual<dim> > &modelResidualsList = scratch.modelResidualsList;
+
+  const unsigned int num_q_points = vars.var.n_q_points;
+
+  // The energy of the last output step is computed in this pass from the same evaluated fields (see
+  // fuseEnergyWithRHS). The accumulation is the same as in getEnergy
+  const bool computeEnergyDensity = this->energyInRHSPending;
+  // The JxW values are needed for the energy and for the value residuals integrated by collocation
+  const bool needJxW = computeEnergyDensity || variableLayout::anyCollocatedValueResidual(0);
+  dealii::AlignedVector<dealii::VectorizedArray<double> > JxW;
+  std::vector<dealii::VectorizedArray<double> > cellEnergyComponents;
+  std::vector<double> rangeEnergyComponents;
+  if (needJxW){
+	  JxW.resize(num_q_points);
+  }
+  if (computeEnergyDensity){
+	  cellEnergyComponents.resize(this->numEnergyComponents);
+	  rangeEnergyComponents.assign(this->numEnergyComponents, 0.0);
   }
 
-  std::vector<modelVariable<dim> > modelVarList;
-  std::vector<modelResidual<dim> > modelResidualsList;
-  modelVarList.reserve(num_var);
-  modelResidualsList.reserve(num_var);
+#if activeSetSkipping == true
+  // Cell batches outside of the active set only get the mass matrix contribution (see prepareRHS)
+  const bool useActiveSet = activeSetSupported;
+  bool zeroUpdate = true;
+#endif
 
   //loop over cells
   for (unsigned int cell=cell_range.first; cell<cell_range.second; ++cell){
 
-	  // Initialize, read DOFs, and set evaulation flags for each variable
-	  for (unsigned int i=0; i<num_var; i++){
-		  if (varInfoListRHS[i].is_scalar) {
-			  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].reinit(cell);
-			  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].read_dof_values_plain(*src[varInfoListRHS[i].global_field_index]);
-			  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].evaluate(need_value[i], need_gradient[i], need_hessian[i]);
-		  }
-		  else {
-			  vector_vars[varInfoListRHS[i].scalar_or_vector_index].reinit(cell);
-			  vector_vars[varInfoListRHS[i].scalar_or_vector_index].read_dof_values_plain(*src[varInfoListRHS[i].global_field_index]);
-			  vector_vars[varInfoListRHS[i].scalar_or_vector_index].evaluate(need_value[i], need_gradient[i], need_hessian[i]);
+#if activeSetSkipping == true
+	  if (useActiveSet){
+		  if (!activeSetEvaluate[cell]){
+			  variableLayout::variableKernel<dim,0,num_var>::integrateMass(vars, cell, dst, src);
+			  continue;
 		  }
+		  zeroUpdate = true;
 	  }
+#endif
 
-	  unsigned int num_q_points;
-	  if (scalar_vars.size() > 0){
-		  num_q_points = scalar_vars[0].n_q_points;
+	  // Initialize, read DOFs, and set evaulation flags for each variable
+	  variableLayout::variableKernel<dim,0,num_var>::evaluate(vars, cell, src);
+
+	  if (needJxW){
+		  variableLayout::variableKernel<dim,0,num_var>::fillJxW(vars, JxW);
 	  }
-	  else {
-		  num_q_points = vector_vars[0].n_q_points;
+	  if (computeEnergyDensity){
+		  for (unsigned int k=0; k<this->numEnergyComponents; k++){
+			  cellEnergyComponents[k]=constV(0.0);
+		  }
 	  }
 
 	  //loop over quadrature points
 	  for (unsigned int q=0; q<num_q_points; ++q){
 
 		  dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc;
-		  if (scalar_vars.size() > 0){
-			  q_point_loc = scalar_vars[0].quadrature_point(q);
-		  }
-		  else {
-			  q_point_loc = vector_vars[0].quadrature_point(q);
-		  }
+#if need_q_point_loc == true
+		  q_point_loc = variableLayout::variableKernel<dim,0,num_var>::quadraturePoint(vars, q);
+#endif
 
-		  for (unsigned int i=0; i<num_var; i++){
-			  if (varInfoListRHS[i].is_scalar) {
-				  if (need_value[i]){
-					  modelVarList[i].scalarValue = scalar_vars[varInfoListRHS[i].scalar_or_vector_index].get_value(q);
-				  }
-				  if (need_gradient[i]){
-					  modelVarList[i].scalarGrad = scalar_vars[varInfoListRHS[i].scalar_or_vector_index].get_gradient(q);
-				  }
-				  if (need_hessian[i]){
-					  modelVarList[i].scalarHess = scalar_vars[varInfoListRHS[i].scalar_or_vector_index].get_hessian(q);
-				  }
-			  }
-			  else {
-				  if (need_value[i]){
-					  modelVarList[i].vectorValue = vector_vars[varInfoListRHS[i].scalar_or_vector_index].get_value(q);
-				  }
-				  if (need_gradient[i]){
-					  modelVarList[i].vectorGrad = vector_vars[varInfoListRHS[i].scalar_or_vector_index].get_gradient(q);
-				  }
-				  if (need_hessian[i]){
-					  modelVarList[i].vectorHess = vector_vars[varInfoListRHS[i].scalar_or_vector_index].get_hessian(q);
-				  }
-			  }
-		  }
+		  variableLayout::variableKernel<dim,0,num_var>::get(vars, q, modelVarList);
 
 		  // Calculate the residuals
 		  residualRHS(modelVarList,modelResidualsList,q_point_loc);
 
+#if activeSetSkipping == true
+		  if (useActiveSet && zeroUpdate){
+			  zeroUpdate = variableLayout::variableKernel<dim,0,num_var>::zeroUpdate(modelVarList, modelResidualsList, activeSetTolerance);
+		  }
+#endif
+
+		  // Calculate the energy density
+		  if (computeEnergyDensity){
+			  energyDensity(modelVarList,JxW[q],q_point_loc,cellEnergyComponents);
+		  }
+
 		  // Submit values
-		  for (unsigned int i=0; i<num_var; i++){
-			  if (varInfoListRHS[i].is_scalar) {
-				  if (value_residual[i] == true){
-					  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].submit_value(modelResidualsList[i].scalarValueResidual,q);
-				  }
-      			  if (gradient_residual[i] == true){
-      				  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].submit_gradient(modelResidualsList[i].scalarGradResidual,q);
-      			  }
-      		  }
-      		  else {
-      			  if (value_residual[i] == true){
-      				  vector_vars[varInfoListRHS[i].scalar_or_vector_index].submit_value(modelResidualsList[i].vectorValueResidual,q);
-      			  }
-      			  if (gradient_residual[i] == true){
-      				  vector_vars[varInfoListRHS[i].scalar_or_vector_index].submit_gradient(modelResidualsList[i].vectorGradResidual,q);
-      			  }
-      		  }
-      	  }
+		  variableLayout::variableKernel<dim,0,num_var>::submit(vars, q, modelResidualsList, JxW, this->rhsFieldIndex);
+	  }
+
+	  variableLayout::variableKernel<dim,0,num_var>::integrate(vars, dst, this->rhsFieldIndex);
 
+#if activeSetSkipping == true
+	  if (useActiveSet){
+		  activeSetZeroUpdate[cell] = zeroUpdate;
 	  }
+#endif
 
-	  for (unsigned int i=0; i<num_var; i++){
-		  if (varInfoListRHS[i].is_scalar) {
-			  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].integrate(value_residual[i], gradient_residual[i]);
-			  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].distribute_local_to_global(*dst[varInfoListRHS[i].global_field_index]);
-		  }
-		  else {
-			  vector_vars[varInfoListRHS[i].scalar_or_vector_index].integrate(value_residual[i], gradient_residual[i]);
-			  vector_vars[varInfoListRHS[i].scalar_or_vector_index].distribute_local_to_global(*dst[varInfoListRHS[i].global_field_index]);
+	  if (computeEnergyDensity){
+		  for (unsigned int k=0; k<this->numEnergyComponents; k++){
+			  for (unsigned int v=0; v<data.n_components_filled(cell); v++){
+				  rangeEnergyComponents[k]+=cellEnergyComponents[k][v];
+			  }
 		  }
 	  }
   }
+
+  // Add the energy of this cell range to the totals
+  if (computeEnergyDensity){
+	  assembler_lock.acquire ();
+	  for (unsigned int k=0; k<this->numEnergyComponents; k++){
+		  this->energy_components[k]+=rangeEnergyComponents[k];
+		  this->energy+=rangeEnergyComponents[k];
+	  }
+	  assembler_lock.release ();
+  }
 }
 
+// Structured grid execution of the RHS: the fields are copied to the grid, the cell layers along the last direction are
+// split in ranges evaluated in parallel (the even ranges, then the odd ones, so that the ranges evaluated at the same time
+// don't share nodes), and the residuals are added to the residual vectors. Returns false if the cell loop is to be used
 template <int dim>
-void  generalizedProblem<dim>::getLHS(const MatrixFree<dim,double> &data,
-					       vectorType &dst,
-					       const vectorType &src,
-					       const std::pair<unsigned int,unsigned int> &cell_range) const{
+bool generalizedProblem<dim>::computeRHSStructured(){
+#if structuredGridRHS == true
+	// The energy is computed by getRHS (see fuseEnergyWithRHS)
+	if (!structuredGridValid || this->energyInRHSPending){
+		return false;
+	}
 
-	variable_info<dim> resInfoLHS;
-	for (unsigned int i=0; i<num_var_LHS; i++){
-		if (MatrixFreePDE<dim>::currentFieldIndex == varInfoListLHS[i].global_field_index){
-			resInfoLHS = varInfoListLHS[i];
+	std::vector<vectorType*> &dst = this->residualSet;
+	const std::vector<vectorType*> &src = this->solutionSet;
+	for (unsigned int f=0; f<src.size(); f++){
+		if (!src[f]->has_ghost_elements()){
+			src[f]->update_ghost_values();
 		}
+		dst[f]->zero_out_ghosts();
 	}
+	structuredGrid.gather(src);
 
-	//initialize FEEvaulation objects
-	std::vector<typeScalar> scalar_vars;
-	std::vector<typeVector> vector_vars;
+	const unsigned int nLayers = (dim > 1) ? structuredGrid.nCells[dim-1] : std::min(structuredGrid.nCells[0], 1u);
+	const unsigned int nRanges = std::min(nLayers, 2*MultithreadInfo::n_threads());
+	if (nRanges <= 2){
+		getRHSStructured(0, nLayers);
+	}
+	else {
+		for (unsigned int parity=0; parity<2; parity++){
+			Threads::TaskGroup<void> tasks;
+			for (unsigned int r=parity; r<nRanges; r+=2){
+				tasks += Threads::new_task(std_cxx11::function<void ()>(std_cxx11::bind(&generalizedProblem<dim>::getRHSStructured,
+						this, r*nLayers/nRanges, (r+1)*nLayers/nRanges)));
+			}
+			tasks.join_all();
+		}
+	}
 
-	for (unsigned int i=0; i<num_var_LHS; i++){
-		if (varInfoListLHS[i].is_scalar){
-			typeScalar var(data, varInfoListLHS[i].global_field_index);
-			scalar_vars.push_back(var);
+	structuredGrid.scatter(dst);
+	for (unsigned int f=0; f<dst.size(); f++){
+		dst[f]->compress(VectorOperation::add);
+	}
+
+	// The first evaluation on each mesh is compared with the cell loop of getRHS, which is used from then on if they differ
+	if (!structuredGridChecked){
+		structuredGridChecked = true;
+		std::vector<vectorType> reference(dst.size());
+		std::vector<vectorType*> referenceSet(dst.size());
+		for (unsigned int f=0; f<dst.size(); f++){
+			this->matrixFreeObject.initialize_dof_vector(reference[f], f);
+			referenceSet[f] = &reference[f];
 		}
-		else {
-			typeVector var(data, varInfoListLHS[i].global_field_index);
-			vector_vars.push_back(var);
+		this->matrixFreeObject.cell_loop(&generalizedProblem<dim>::getRHS, this, referenceSet, src);
+
+		double difference = 0.0;
+		for (unsigned int f=0; f<dst.size(); f++){
+			vectorType diff(reference[f]);
+			diff -= *dst[f];
+			difference = std::max(difference, diff.linfty_norm()/std::max(reference[f].linfty_norm(), std::numeric_limits<double>::min()));
+		}
+		char buffer[200];
+		sprintf(buffer, "structured grid RHS: max. relative difference with the matrix free cell loop: %12.6e\n", difference);
+		this->pcout<<buffer;
+		if (!(difference <= 1.0e-10)){
+			this->pcout << "\nstructured grid RHS: the difference is above the round-off level (1.0e-10), the RHS is evaluated with the matrix free cell loop\n";
+			structuredGridValid = false;
+			for (unsigned int f=0; f<dst.size(); f++){
+				*dst[f] = reference[f];
+			}
 		}
 	}
+	return true;
+#else
+	return false;
+#endif
+}
 
-	std::vector<modelVariable<dim> > modelVarList;
-	modelVarList.reserve(num_var_LHS);
-	modelResidual<dim> modelRes;
+// RHS on the cell layers [firstLayer,lastLayer) of the structured grid (along the last direction). The rows of cells along x
+// are split in cell batches of consecutive cells, and the lanes of the cells that aren't locally owned repeat a cell in use
+// and aren't added to the node residuals
+template <int dim>
+void generalizedProblem<dim>::getRHSStructured(unsigned int firstLayer, unsigned int lastLayer){
+	structuredGridLayout<dim> &grid = structuredGrid;
+	const unsigned int n_lanes = dealii::VectorizedArray<double>::n_array_elements;
+	const unsigned int n_nodes = variableLayout::structuredCell<dim>::n_nodes;
+	const unsigned int n_nodes_1d = variableLayout::structuredCell<dim>::n_nodes_1d;
+
+	// Scratch data of this range (in an AlignedVector, for the alignment of the VectorizedArrays)
+	dealii::AlignedVector<variableLayout::structuredDataList<dim,0,num_var> > scratch(1);
+	variableLayout::structuredDataList<dim,0,num_var> &list = scratch[0];
+	std::vector<modelVariable<dim> > modelVarList(num_var);
+	std::vector<modelResidual<dim> > modelResidualsList(num_var);
+	// The packed group isn't sparse on the structured grid, so all of its variables are passed
+	modelVarList[variableLayout::packedFirst].numActive = variableLayout::numPacked;
+
+	unsigned int rowsPerLayer = 1;
+	for (unsigned int d=1; d+1<dim; d++){
+		rowsPerLayer *= grid.nCells[d];
+	}
 
-	//loop over cells
-	for (unsigned int cell=cell_range.first; cell<cell_range.second; ++cell){
+	unsigned int base[n_lanes];
+	bool laneInUse[n_lanes];
+	for (unsigned int layer=firstLayer; layer<lastLayer; layer++){
+		for (unsigned int row=0; row<rowsPerLayer; row++){
+			// Index of the row in each direction, and its first cell and first node on the grid
+			unsigned int cellIndex[dim];
+			cellIndex[0] = 0;
+			unsigned int remainder = row;
+			for (unsigned int d=1; d<dim; d++){
+				if (d+1 < dim){
+					cellIndex[d] = remainder%grid.nCells[d];
+					remainder /= grid.nCells[d];
+				}
+				else {
+					cellIndex[d] = layer;
+				}
+			}
+			unsigned int rowCell = 0, rowNode = 0, cellStride = 1;
+			for (unsigned int d=0; d<dim; d++){
+				rowCell += cellIndex[d]*cellStride;
+				cellStride *= grid.nCells[d];
+				rowNode += cellIndex[d]*grid.degree*grid.nodeStride[d];
+			}
 
-		// Initialize, read DOFs, and set evaulation flags for each variable
-		for (unsigned int i=0; i<num_var_LHS; i++){
-			if (varInfoListLHS[i].is_scalar) {
-				scalar_vars[varInfoListLHS[i].scalar_or_vector_index].reinit(cell);
-				if ( varInfoListLHS[i].global_field_index == resInfoLHS.global_field_index ){
-					scalar_vars[varInfoListLHS[i].scalar_or_vector_index].read_dof_values_plain(src);
+			for (unsigned int first=0; first<grid.nCells[0]; first+=n_lanes){
+				unsigned int nInUse = 0, firstInUse = 0;
+				for (unsigned int l=n_lanes; l>0; l--){
+					const unsigned int i = first+l-1;
+					laneInUse[l-1] = (i < grid.nCells[0]) && grid.cellOwned[rowCell+i];
+					if (laneInUse[l-1]){
+						base[l-1] = rowNode + i*grid.degree;
+						firstInUse = l-1;
+						nInUse++;
+					}
 				}
-				else{
-					scalar_vars[varInfoListLHS[i].scalar_or_vector_index].read_dof_values_plain(*MatrixFreePDE<dim>::solutionSet[varInfoListLHS[i].global_field_index]);
+				if (nInUse == 0){
+					continue;
 				}
-				scalar_vars[varInfoListLHS[i].scalar_or_vector_index].evaluate(need_value_LHS[varInfoListLHS[i].global_var_index], need_gradient_LHS[varInfoListLHS[i].global_var_index], need_hessian_LHS[varInfoListLHS[i].global_var_index]);
+				for (unsigned int l=0; l<n_lanes; l++){
+					if (!laneInUse[l]){
+						base[l] = base[firstInUse];
+					}
+				}
+
+				variableLayout::structuredKernel<dim,0,num_var>::evaluate(list, grid, base, nInUse == n_lanes);
+
+				for (unsigned int q=0; q<n_nodes; ++q){
+
+					dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc;
+#if need_q_point_loc == true
+					unsigned int a = q;
+					for (unsigned int d=0; d<dim; d++){
+						for (unsigned int l=0; l<n_lanes; l++){
+							const double index = (d == 0) ? (double)(base[l]-rowNode)/grid.degree : (double)cellIndex[d];
+							q_point_loc[d][l] = grid.origin[d] + (index + grid.points1D[a%n_nodes_1d])*grid.cellSize[d];
+						}
+						a /= n_nodes_1d;
+					}
+#endif
+
+					variableLayout::structuredKernel<dim,0,num_var>::get(list, q, modelVarList);
+
+					// Calculate the residuals
+					residualRHS(modelVarList,modelResidualsList,q_point_loc);
+
+					variableLayout::structuredKernel<dim,0,num_var>::submit(list, q, modelResidualsList);
+				}
+
+				variableLayout::structuredKernel<dim,0,num_var>::integrate(list, grid, base, laneInUse);
 			}
-			else {
-				vector_vars[varInfoListLHS[i].scalar_or_vector_index].reinit(cell);
-				if ( varInfoListLHS[i].global_field_index == resInfoLHS.global_field_index ){
-					vector_vars[varInfoListLHS[i].scalar_or_vector_index].read_dof_values_plain(src);
+		}
+	}
+}
+
+// L2 projections of the derivatives of the variables with a recovered Hessian (see recoveredHessians): the integrals of the
+// test functions times the derivatives, times the inverse lumped mass matrix
+template <int dim>
+void generalizedProblem<dim>::computeRecoveredGradients(){
+	cellScratch &scratch = cellScratchRHS->get();
+	for (unsigned int i=0; i<num_var; i++){
+		for (unsigned int d=0; d<recoveredGradients[i].size(); d++){
+			recoveredGradients[i][d] = 0.0;
+		}
+	}
+	for (unsigned int cell=0; cell<this->matrixFreeObject.n_macro_cells(); ++cell){
+		variableLayout::variableKernel<dim,0,num_var>::projectDerivatives(scratch.vars, cell, recoveredGradients, this->solutionSet);
+	}
+	for (unsigned int i=0; i<num_var; i++){
+		for (unsigned int d=0; d<recoveredGradients[i].size(); d++){
+			recoveredGradients[i][d].compress(VectorOperation::add);
+			recoveredGradients[i][d].scale(recoveredGradientInvM[i]);
+			this->constraintsHangingNodesSet[variableLayout::fieldIndex(i)]->distribute(recoveredGradients[i][d]);
+			recoveredGradients[i][d].update_ghost_values();
+		}
+	}
+	recoveredGradientsValid = true;
+}
+
+// The recovered Hessians of an elliptic variable are updated after each of its solves
+template <int dim>
+void generalizedProblem<dim>::ellipticFieldUpdated(unsigned int fieldIndex){
+	for (unsigned int i=0; i<num_var; i++){
+		if (variableLayout::isRecovered(i) && (variableLayout::fieldIndex(i) == fieldIndex)){
+			computeRecoveredGradients();
+			return;
+		}
+	}
+}
+
+// Select the cell batches evaluated in full by getRHS (the active set). A cell batch with a zero update in its last full
+// evaluation keeps it as long as its DOFs (shared with the neighboring cell batches) don't change, so the cell batches with a
+// nonzero update in the last increment and the ones within activeSetHaloLayers of them are evaluated in full, and the others
+// only get the mass matrix contribution (which is their full residual)
+template <int dim>
+void generalizedProblem<dim>::prepareRHS(){
+	// The recovered Hessians of the initial fields, or of the fields transferred to a new mesh
+	if (variableLayout::anyRecovered(0) && !recoveredGradientsValid){
+		computeRecoveredGradients();
+	}
+
+#if activeSetSkipping == true
+	if (!activeSetSupported){
+		return;
+	}
+
+	const unsigned int n_cells = this->matrixFreeObject.n_macro_cells();
+	if (activeSetNeighbors.size() != n_cells){
+		buildActiveSetNeighbors();
+	}
+
+	// All the cell batches are evaluated in full after a change of the mesh or of the fields outside of the time step,
+	// for the energy, and every activeSetRefreshInterval increments (for residuals that depend on time)
+	if (!activeSetValid || this->energyInRHSPending || (this->currentIncrement % activeSetRefreshInterval == 0)){
+		activeSetEvaluate.assign(n_cells, 1);
+		activeSetZeroUpdate.assign(n_cells, 0);
+		activeSetValid = true;
+		return;
+	}
+
+	for (unsigned int cell=0; cell<n_cells; ++cell){
+		activeSetEvaluate[cell] = (activeSetZeroUpdate[cell] == 0);
+	}
+	std::vector<unsigned char> layer;
+	for (unsigned int l=0; l<activeSetHaloLayers; l++){
+		layer = activeSetEvaluate;
+		for (unsigned int cell=0; cell<n_cells; ++cell){
+			for (unsigned int k=0; (k<activeSetNeighbors[cell].size()) && !activeSetEvaluate[cell]; k++){
+				activeSetEvaluate[cell] = layer[activeSetNeighbors[cell][k]];
+			}
+		}
+	}
+	unsigned int n_evaluated = 0;
+	for (unsigned int cell=0; cell<n_cells; ++cell){
+		activeSetEvaluate[cell] = activeSetEvaluate[cell] || activeSetAlwaysEvaluate[cell];
+		n_evaluated += activeSetEvaluate[cell];
+	}
+
+	char buffer[200];
+	const unsigned int n_evaluated_total = Utilities::MPI::sum(n_evaluated, MPI_COMM_WORLD);
+	const unsigned int n_cells_total = Utilities::MPI::sum(n_cells, MPI_COMM_WORLD);
+	sprintf(buffer, "active set: %u of %u cell batches evaluated in full (%.1f%%)\n",
+			n_evaluated_total, n_cells_total, 100.0*n_evaluated_total/std::max(n_cells_total, 1u));
+	this->pcout<<buffer;
+#endif
+}
+
+// Neighbors (sharing a vertex) of each cell batch of matrixFreeObject. The cell batches next to a cell of another
+// processor, a boundary (periodic or not) or a hanging node share DOFs with cells that aren't in this list (or are
+// constrained), so they are always evaluated in full
+template <int dim>
+void generalizedProblem<dim>::buildActiveSetNeighbors(){
+	const unsigned int n_cells = this->matrixFreeObject.n_macro_cells();
+	const unsigned int n_vertices = this->triangulation.n_vertices();
+
+	std::vector<unsigned char> vertexAlwaysEvaluate(n_vertices, 0);
+	typename Triangulation<dim>::active_cell_iterator cell = this->triangulation.begin_active(), endc = this->triangulation.end();
+	for (; cell!=endc; ++cell){
+		bool flag = !cell->is_locally_owned();
+		for (unsigned int f=0; (f<GeometryInfo<dim>::faces_per_cell) && !flag; ++f){
+			if (cell->at_boundary(f)){
+				flag = true;
+			}
+			else if (cell->neighbor(f)->has_children() || (cell->neighbor(f)->level() != cell->level())){
+				flag = true;
+			}
+		}
+		if (flag){
+			for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v){
+				vertexAlwaysEvaluate[cell->vertex_index(v)] = 1;
+			}
+		}
+	}
+
+	std::vector<std::vector<unsigned int> > vertexCells(n_vertices);
+	for (unsigned int batch=0; batch<n_cells; ++batch){
+		for (unsigned int c=0; c<this->matrixFreeObject.n_components_filled(batch); ++c){
+			typename DoFHandler<dim>::active_cell_iterator batch_cell = this->matrixFreeObject.get_cell_iterator(batch, c);
+			for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v){
+				std::vector<unsigned int> &cells = vertexCells[batch_cell->vertex_index(v)];
+				if (cells.empty() || (cells.back() != batch)){
+					cells.push_back(batch);
 				}
-				else {
-					vector_vars[varInfoListLHS[i].scalar_or_vector_index].read_dof_values_plain(*MatrixFreePDE<dim>::solutionSet[varInfoListLHS[i].global_field_index]);
+			}
+		}
+	}
+
+	activeSetNeighbors.assign(n_cells, std::vector<unsigned int>());
+	activeSetAlwaysEvaluate.assign(n_cells, 0);
+	activeSetEvaluate.assign(n_cells, 1);
+	activeSetZeroUpdate.assign(n_cells, 0);
+	for (unsigned int batch=0; batch<n_cells; ++batch){
+		std::vector<unsigned int> &neighbors = activeSetNeighbors[batch];
+		for (unsigned int c=0; c<this->matrixFreeObject.n_components_filled(batch); ++c){
+			typename DoFHandler<dim>::active_cell_iterator batch_cell = this->matrixFreeObject.get_cell_iterator(batch, c);
+			for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell; ++v){
+				const unsigned int vertex = batch_cell->vertex_index(v);
+				if (vertexAlwaysEvaluate[vertex]){
+					activeSetAlwaysEvaluate[batch] = 1;
 				}
-				vector_vars[varInfoListLHS[i].scalar_or_vector_index].evaluate(need_value_LHS[varInfoListLHS[i].global_var_index], need_gradient_LHS[varInfoListLHS[i].global_var_index], need_hessian_LHS[varInfoListLHS[i].global_var_index]);
+				neighbors.insert(neighbors.end(), vertexCells[vertex].begin(), vertexCells[vertex].end());
 			}
 		}
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), batch), neighbors.end());
+	}
+	activeSetValid = false;
+}
 
-		unsigned int num_q_points;
-		if (scalar_vars.size() > 0){
-			num_q_points = scalar_vars[0].n_q_points;
+template <int dim>
+void  generalizedProblem<dim>::getLHS(const MatrixFree<dim,double> &data,
+					       vectorType &dst,
+					       const vectorType &src,
+					       const std::pair<unsigned int,unsigned int> &cell_range) const{
+
+	variable_info<dim> resInfoLHS;
+	for (unsigned int i=0; i<num_var_LHS; i++){
+		if (MatrixFreePDE<dim>::currentFieldIndex == varInfoListLHS[i].global_field_index){
+			resInfoLHS = varInfoListLHS[i];
 		}
-		else {
-			num_q_points = vector_vars[0].n_q_points;
+	}
+	const unsigned int resVar = resInfoLHS.global_var_index;
+
+	//FEEvaulation objects and model variables of this thread (built in reinitCellScratch). The variables are only known
+	//at runtime here, so the operations on the FEEvaluation objects are dispatched with evaluatorList::apply
+	cellScratch &scratch = cellScratchLHS->get();
+	variableLayout::evaluatorList<dim,0,num_var> &vars = scratch.vars;
+	std::vector<modelVariable<dim> > &modelVarList = scratch.modelVarList;
+	modelResidual<dim> modelRes;
+
+	const unsigned int num_q_points = vars.var.n_q_points;
+
+	// The fields other than the solved one are read from the cache if it was built for this solve
+	const bool useCache = (LHSCacheFieldIndex == (int)MatrixFreePDE<dim>::currentFieldIndex) && (LHSCacheIncrement == MatrixFreePDE<dim>::currentIncrement);
+
+	//loop over cells
+	for (unsigned int cell=cell_range.first; cell<cell_range.second; ++cell){
+
+		// Initialize, read DOFs, and set evaulation flags for each variable (except the ones in the cache)
+		for (unsigned int i=0; i<num_var_LHS; i++){
+			if (useCache && (LHSCacheComponents[i] > 0)){
+				continue;
+			}
+			const unsigned int var = varInfoListLHS[i].global_var_index;
+			const vectorType &field = (varInfoListLHS[i].global_field_index == resInfoLHS.global_field_index) ? src : *MatrixFreePDE<dim>::solutionSet[varInfoListLHS[i].global_field_index];
+			vars.apply(var, variableLayout::evaluateField(cell, field, need_value_LHS[var], need_gradient_LHS[var], need_hessian_LHS[var]));
 		}
 
 		//loop over quadrature points
 	    for (unsigned int q=0; q<num_q_points; ++q){
 	    	dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc;
-	    	if (scalar_vars.size() > 0){
-	    		q_point_loc = scalar_vars[0].quadrature_point(q);
-	    	}
-	    	else {
-	    		q_point_loc = vector_vars[0].quadrature_point(q);
-	    	}
+#if need_q_point_loc == true
+	    	// The evaluator of the solved field is always initialized for this cell
+	    	vars.apply(resVar, variableLayout::getQuadraturePoint<dim>(q, q_point_loc));
+#endif
 
 	    	for (unsigned int i=0; i<num_var_LHS; i++){
-	    		if (varInfoListLHS[i].is_scalar) {
-	    			if (need_value_LHS[varInfoListLHS[i].global_var_index]){
-	    				modelVarList[i].scalarValue = scalar_vars[varInfoListLHS[i].scalar_or_vector_index].get_value(q);
-	    			}
-	    			if (need_gradient_LHS[varInfoListLHS[i].global_var_index]){
-	    				modelVarList[i].scalarGrad = scalar_vars[varInfoListLHS[i].scalar_or_vector_index].get_gradient(q);
-	    			}
-	    			if (need_hessian_LHS[varInfoListLHS[i].global_var_index]){
-	    				modelVarList[i].scalarHess = scalar_vars[varInfoListLHS[i].scalar_or_vector_index].get_hessian(q);
-	    			}
+	    		if (useCache && (LHSCacheComponents[i] > 0)){
+	    			copyLHSCache(modelVarList[i], &LHSCache[i][(cell*num_q_points+q)*LHSCacheComponents[i]], varInfoListLHS[i]);
 	    		}
 	    		else {
-	    			if (need_value_LHS[varInfoListLHS[i].global_var_index]){
-	    				modelVarList[i].vectorValue = vector_vars[varInfoListLHS[i].scalar_or_vector_index].get_value(q);
-	    			}
-	    			if (need_gradient_LHS[varInfoListLHS[i].global_var_index]){
-	    				modelVarList[i].vectorGrad = vector_vars[varInfoListLHS[i].scalar_or_vector_index].get_gradient(q);
-	    			}
-	    			if (need_hessian_LHS[varInfoListLHS[i].global_var_index]){
-	    				modelVarList[i].vectorHess = vector_vars[varInfoListLHS[i].scalar_or_vector_index].get_hessian(q);
-	    			}
+	    			const unsigned int var = varInfoListLHS[i].global_var_index;
+	    			vars.apply(var, variableLayout::getField<dim>(q, modelVarList[i], need_value_LHS[var], need_gradient_LHS[var], need_hessian_LHS[var]));
 	    		}
 	    	}
 
@@ -413,36 +819,166 @@ void  generalizedProblem<dim>::getLHS(const MatrixFree<dim,double> &data,
 	    	residualLHS(modelVarList,modelRes,q_point_loc);
 
 	    	// Submit values
-			if (resInfoLHS.is_scalar){
-				if (value_residual[resInfoLHS.global_var_index]){
-					scalar_vars[resInfoLHS.scalar_or_vector_index].submit_value(modelRes.scalarValueResidual,q);
-				}
-				if (gradient_residual[resInfoLHS.global_var_index]){
-					scalar_vars[resInfoLHS.scalar_or_vector_index].submit_gradient(modelRes.scalarGradResidual,q);
+	    	vars.apply(resVar, variableLayout::submitField<dim>(q, modelRes, value_residual[resVar], gradient_residual[resVar]));
+	    }
+
+	    //integrate
+	    vars.apply(resVar, variableLayout::integrateField(dst, value_residual[resVar], gradient_residual[resVar]));
+	}
+
+}
+
+// Number of values per quadrature point of an LHS variable in the LHS coefficient cache
+template <int dim>
+unsigned int generalizedProblem<dim>::countLHSCacheComponents(const variable_info<dim> &varInfo) const{
+	const unsigned int var = varInfo.global_var_index;
+	const unsigned int rank_offset = varInfo.is_scalar ? 1 : dim;
+	return rank_offset*((need_value_LHS[var] ? 1 : 0) + (need_gradient_LHS[var] ? dim : 0) + (need_hessian_LHS[var] ? dim*dim : 0));
+}
+
+// Copy of an entry of the LHS coefficient cache: from the model variable into the cache while it is built, and from
+// the (read-only) cache into the model variable in getLHS
+inline void copyLHSCacheEntry(dealii::VectorizedArray<double> &entry, dealii::VectorizedArray<double> &cache){
+	cache = entry;
+}
+
+inline void copyLHSCacheEntry(dealii::VectorizedArray<double> &entry, const dealii::VectorizedArray<double> &cache){
+	entry = cache;
+}
+
+// Copy the parts of an LHS variable needed by residualLHS between the model variable and the cache entries of a quadrature point
+template <int dim>
+template <typename cacheType>
+void generalizedProblem<dim>::copyLHSCache(modelVariable<dim> &modelVar, cacheType *cache, const variable_info<dim> &varInfo) const{
+	const unsigned int var = varInfo.global_var_index;
+	unsigned int k = 0;
+	auto copy = [&](dealii::VectorizedArray<double> &entry){
+		copyLHSCacheEntry(entry, cache[k]);
+		k++;
+	};
+
+	if (varInfo.is_scalar){
+		if (need_value_LHS[var]){
+			copy(modelVar.scalarValue);
+		}
+		if (need_gradient_LHS[var]){
+			for (unsigned int i=0; i<dim; i++){
+				copy(modelVar.scalarGrad[i]);
+			}
+		}
+		if (need_hessian_LHS[var]){
+			for (unsigned int i=0; i<dim; i++){
+				for (unsigned int j=0; j<dim; j++){
+					copy(modelVar.scalarHess[i][j]);
 				}
 			}
-			else {
-				if (value_residual[resInfoLHS.global_var_index]){
-					vector_vars[resInfoLHS.scalar_or_vector_index].submit_value(modelRes.vectorValueResidual,q);
+		}
+	}
+	else {
+		if (need_value_LHS[var]){
+			for (unsigned int i=0; i<dim; i++){
+				copy(modelVar.vectorValue[i]);
+			}
+		}
+		if (need_gradient_LHS[var]){
+			for (unsigned int i=0; i<dim; i++){
+				for (unsigned int j=0; j<dim; j++){
+					copy(modelVar.vectorGrad[i][j]);
 				}
-				if (gradient_residual[resInfoLHS.global_var_index]){
-					vector_vars[resInfoLHS.scalar_or_vector_index].submit_gradient(modelRes.vectorGradResidual,q);
+			}
+		}
+		if (need_hessian_LHS[var]){
+			for (unsigned int i=0; i<dim; i++){
+				for (unsigned int j=0; j<dim; j++){
+					for (unsigned int l=0; l<dim; l++){
+						copy(modelVar.vectorHess[i][j][l]);
+					}
 				}
 			}
+		}
+	}
+}
 
-	    }
+// Build the LHS coefficient cache for the implicit solve of field "fieldIndex": the LHS variables other than the
+// solved field are constant during the solve, so they are evaluated once here instead of in every call of getLHS
+template <int dim>
+void generalizedProblem<dim>::prepareLHS(unsigned int fieldIndex){
+#if cacheLHSCoefficients == true
+	LHSCacheFieldIndex = -1;
+	if (num_var_LHS == 0){
+		return;
+	}
 
-	    //integrate
-		if (resInfoLHS.is_scalar) {
-			scalar_vars[resInfoLHS.scalar_or_vector_index].integrate(value_residual[resInfoLHS.global_var_index], gradient_residual[resInfoLHS.global_var_index]);
-			scalar_vars[resInfoLHS.scalar_or_vector_index].distribute_local_to_global(dst);
+	this->computing_timer.enter_section("matrixFreePDE: prepareLHS");
+	Timer time;
+
+	cellScratch &scratch = cellScratchLHS->get();
+	variableLayout::evaluatorList<dim,0,num_var> &vars = scratch.vars;
+	std::vector<modelVariable<dim> > &modelVarList = scratch.modelVarList;
+
+	const unsigned int n_cells = this->matrixFreeObject.n_macro_cells();
+	const unsigned int num_q_points = vars.var.n_q_points;
+
+	// Values per quadrature point of each LHS variable (none for the solved field), and the memory of the cache
+	// compared with the DOF vectors of the cached fields
+	LHSCacheComponents.assign(num_var_LHS, 0);
+	unsigned int total_components = 0, cached_fields = 0;
+	double dof_memory = 0.0;
+	for (unsigned int i=0; i<num_var_LHS; i++){
+		if (varInfoListLHS[i].global_field_index != fieldIndex){
+			LHSCacheComponents[i] = countLHSCacheComponents(varInfoListLHS[i]);
+			total_components += LHSCacheComponents[i];
+			cached_fields++;
+			dof_memory += this->solutionSet[varInfoListLHS[i].global_field_index]->local_size()*sizeof(double)/1048576.0;
 		}
-		else {
-			vector_vars[resInfoLHS.scalar_or_vector_index].integrate(value_residual[resInfoLHS.global_var_index], gradient_residual[resInfoLHS.global_var_index]);
-			vector_vars[resInfoLHS.scalar_or_vector_index].distribute_local_to_global(dst);
+	}
+	const double cache_memory = (double)n_cells*num_q_points*total_components*sizeof(dealii::VectorizedArray<double>)/1048576.0;
+
+	char buffer[300];
+	if ((total_components == 0) || (cache_memory > LHSCacheMemoryLimit)){
+		if ((total_components > 0) && (cache_memory != LHSCacheReportedMemory)){
+			sprintf(buffer, "LHS coefficient cache: %.2f MB needed per processor, above LHSCacheMemoryLimit (%.2f MB), the fields are evaluated in every solver iteration\n",
+					cache_memory, (double)LHSCacheMemoryLimit);
+			this->pcout<<buffer;
+			LHSCacheReportedMemory = cache_memory;
 		}
+		this->computing_timer.exit_section("matrixFreePDE: prepareLHS");
+		return;
 	}
 
+	// Evaluate the cached fields on each cell batch and store them by quadrature point
+	LHSCache.resize(num_var_LHS);
+	for (unsigned int i=0; i<num_var_LHS; i++){
+		LHSCache[i].resize(n_cells*num_q_points*LHSCacheComponents[i]);
+	}
+	for (unsigned int cell=0; cell<n_cells; ++cell){
+		for (unsigned int i=0; i<num_var_LHS; i++){
+			if (LHSCacheComponents[i] == 0){
+				continue;
+			}
+			const unsigned int var = varInfoListLHS[i].global_var_index;
+			const vectorType &field = *this->solutionSet[varInfoListLHS[i].global_field_index];
+			vars.apply(var, variableLayout::evaluateField(cell, field, need_value_LHS[var], need_gradient_LHS[var], need_hessian_LHS[var]));
+			for (unsigned int q=0; q<num_q_points; ++q){
+				vars.apply(var, variableLayout::getField<dim>(q, modelVarList[i], need_value_LHS[var], need_gradient_LHS[var], need_hessian_LHS[var]));
+				copyLHSCache(modelVarList[i], &LHSCache[i][(cell*num_q_points+q)*LHSCacheComponents[i]], varInfoListLHS[i]);
+			}
+		}
+	}
+	LHSCacheFieldIndex = fieldIndex;
+	LHSCacheIncrement = this->currentIncrement;
+
+	// Memory/compute trade-off, reported when the size of the cache changes (first solve and after remeshing).
+	// The build time is about the evaluation time that the cache saves in each solver iteration
+	if (cache_memory != LHSCacheReportedMemory){
+		sprintf(buffer, "LHS coefficient cache: %u field(s), %u values per quadrature point, %.2f MB per processor (%.1fx the DOF vectors of the fields), built in %.4fs (about the time saved per solver iteration)\n",
+				cached_fields, total_components, cache_memory, cache_memory/std::max(dof_memory, 1.0e-12), time.wall_time());
+		this->pcout<<buffer;
+		LHSCacheReportedMemory = cache_memory;
+	}
+
+	this->computing_timer.exit_section("matrixFreePDE: prepareLHS");
+#endif
 }
 
 // Calculate the free energy
@@ -452,101 +988,58 @@ void  generalizedProblem<dim>::getEnergy(const MatrixFree<dim,double> &data,
 				    const std::vector<vectorType*> &src,
 				    const std::pair<unsigned int,unsigned int> &cell_range) {
 
-	//initialize FEEvaulation objects
-	  std::vector<typeScalar> scalar_vars;
-	  std::vector<typeVector> vector_vars;
+	//FEEvaulation objects and model variables of this thread (built in reinitCellScratch)
+	  cellScratch &scratch = cellScratchRHS->get();
+	  variableLayout::evaluatorList<dim,0,num_var> &vars = scratch.vars;
+	  std::vector<modelVariable<dim> > &modelVarList = scratch.modelVarList;
 
-	  for (unsigned int i=0; i<num_var; i++){
-		  if (varInfoListRHS[i].is_scalar){
-			  typeScalar var(data, i);
-			  scalar_vars.push_back(var);
-		  }
-		  else {
-			  typeVector var(data, i);
-			  vector_vars.push_back(var);
-		  }
-	  }
+	  const unsigned int num_q_points = vars.var.n_q_points;
+	  dealii::AlignedVector<dealii::VectorizedArray<double> > JxW(num_q_points);
 
-	  std::vector<modelVariable<dim> > modelVarList;
-	  std::vector<modelResidual<dim> > modelResidualsList;
-	  modelVarList.reserve(num_var);
-	  modelResidualsList.reserve(num_var);
+	  // Energy components of a cell batch, and of this cell range (summed over the lanes holding actual
+	  // cells). The cell range totals are added to the global ones once, at the end
+	  std::vector<dealii::VectorizedArray<double> > cellEnergyComponents(this->numEnergyComponents);
+	  std::vector<double> rangeEnergyComponents(this->numEnergyComponents, 0.0);
 
 	  //loop over cells
 	  for (unsigned int cell=cell_range.first; cell<cell_range.second; ++cell){
 
 		  // Initialize, read DOFs, and set evaulation flags for each variable
-		  for (unsigned int i=0; i<num_var; i++){
-			  if (varInfoListRHS[i].is_scalar) {
-				  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].reinit(cell);
-				  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].read_dof_values_plain(*src[varInfoListRHS[i].global_field_index]);
-				  scalar_vars[varInfoListRHS[i].scalar_or_vector_index].evaluate(need_value[i], need_gradient[i], need_hessian[i]);
-			  }
-			  else {
-				  vector_vars[varInfoListRHS[i].scalar_or_vector_index].reinit(cell);
-				  vector_vars[varInfoListRHS[i].scalar_or_vector_index].read_dof_values_plain(*src[varInfoListRHS[i].global_field_index]);
-				  vector_vars[varInfoListRHS[i].scalar_or_vector_index].evaluate(need_value[i], need_gradient[i], need_hessian[i]);
-			  }
-		  }
+		  variableLayout::variableKernel<dim,0,num_var>::evaluate(vars, cell, src);
 
+		  variableLayout::variableKernel<dim,0,num_var>::fillJxW(vars, JxW);
 
-		  unsigned int num_q_points;
-		  if (scalar_vars.size() > 0){
-			  num_q_points = scalar_vars[0].n_q_points;
-		  }
-		  else {
-			  num_q_points = vector_vars[0].n_q_points;
-		  }
-
-		  dealii::AlignedVector<dealii::VectorizedArray<double> > JxW(num_q_points);
-
-		  if (scalar_vars.size() > 0){
-			  scalar_vars[0].fill_JxW_values(JxW);
-		  }
-		  else {
-			  vector_vars[0].fill_JxW_values(JxW);
+		  for (unsigned int k=0; k<this->numEnergyComponents; k++){
+			  cellEnergyComponents[k]=constV(0.0);
 		  }
 
 		  //loop over quadrature points
 		  for (unsigned int q=0; q<num_q_points; ++q){
 			  dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc;
-			  if (scalar_vars.size() > 0){
-				  q_point_loc = scalar_vars[0].quadrature_point(q);
-			  }
-			  else {
-				  q_point_loc = vector_vars[0].quadrature_point(q);
-			  }
+#if need_q_point_loc == true
+			  q_point_loc = variableLayout::variableKernel<dim,0,num_var>::quadraturePoint(vars, q);
+#endif
 
-			  for (unsigned int i=0; i<num_var; i++){
-				  if (varInfoListRHS[i].is_scalar) {
-					  if (need_value[i]){
-						  modelVarList[i].scalarValue = scalar_vars[varInfoListRHS[i].scalar_or_vector_index].get_value(q);
-					  }
-					  if (need_gradient[i]){
-						  modelVarList[i].scalarGrad = scalar_vars[varInfoListRHS[i].scalar_or_vector_index].get_gradient(q);
-					  }
-					  if (need_hessian[i]){
-						  modelVarList[i].scalarHess = scalar_vars[varInfoListRHS[i].scalar_or_vector_index].get_hessian(q);
-					  }
-				  }
-				  else {
-					  if (need_value[i]){
-						  modelVarList[i].vectorValue = vector_vars[varInfoListRHS[i].scalar_or_vector_index].get_value(q);
-					  }
-					  if (need_gradient[i]){
-						  modelVarList[i].vectorGrad = vector_vars[varInfoListRHS[i].scalar_or_vector_index].get_gradient(q);
-					  }
-					  if (need_hessian[i]){
-						  modelVarList[i].vectorHess = vector_vars[varInfoListRHS[i].scalar_or_vector_index].get_hessian(q);
-					  }
-				  }
-			  }
+			  variableLayout::variableKernel<dim,0,num_var>::get(vars, q, modelVarList);
 
 			  // Calculate the energy density
-			  energyDensity(modelVarList,JxW[q],q_point_loc);
+			  energyDensity(modelVarList,JxW[q],q_point_loc,cellEnergyComponents);
+		  }
+
+		  for (unsigned int k=0; k<this->numEnergyComponents; k++){
+			  for (unsigned int v=0; v<data.n_components_filled(cell); v++){
+				  rangeEnergyComponents[k]+=cellEnergyComponents[k][v];
+			  }
 		  }
 	  }
 
+	  // Add the energy of this cell range to the totals
+	  assembler_lock.acquire ();
+	  for (unsigned int k=0; k<this->numEnergyComponents; k++){
+		  this->energy_components[k]+=rangeEnergyComponents[k];
+		  this->energy+=rangeEnergyComponents[k];
+	  }
+	  assembler_lock.release ();
 }
 
 //compute the integral of one of the fields
@@ -587,6 +1080,23 @@ void generalizedProblem<dim>::computeIntegral(double& integratedField){
   integratedField = value;
 }
 
+//homogeneous reference stiffness for the spectral elasticity backend, taken as the average of the material stiffnesses
+template <int dim>
+void generalizedProblem<dim>::getReferenceStiffness(dealii::Table<2, double> &CIJ){
+	if (CIJ_list.size() == 0){
+		this->pcout << "\nError: the spectral elasticity backend requires MaterialModels and MaterialConstants to be defined\n";
+		exit(-1);
+	}
+	CIJ.reinit(CIJ_tensor_size, CIJ_tensor_size);
+	for (unsigned int mater_num=0; mater_num < CIJ_list.size(); mater_num++){
+		for (unsigned int i=0; i<CIJ_tensor_size; i++){
+			for (unsigned int j=0; j<CIJ_tensor_size; j++){
+				CIJ(i,j) += CIJ_list[mater_num][i][j][0]/CIJ_list.size();
+			}
+		}
+	}
+}
+
 // =====================================================================
 // ADAPTIVE MESHING FUNCTIONS
 // =====================================================================
@@ -611,6 +1121,15 @@ void generalizedProblem<dim>::adaptiveRefineCriterion(){
 	std::vector<double> refine_window_min = refineWindowMin;
 	std::vector<std::vector<double> > errorOutV;
 
+	// Fields of the criterion variables (the variables of the packed group are components of a field, and aren't supported)
+	for (unsigned int field_index=0; field_index<refine_criterion_fields.size(); field_index++){
+		if (variableLayout::isPacked(refine_criterion_fields[field_index])){
+			this->pcout << "\nError: the variables of the packed group can't be in refineCriterionFields\n";
+			exit(-1);
+		}
+		refine_criterion_fields[field_index] = variableLayout::fieldIndex(refine_criterion_fields[field_index]);
+	}
+
 
 	QGauss<dim>  quadrature(finiteElementDegree+1);
 	FEValues<dim> fe_values (*this->FESet[refine_criterion_fields[0]], quadrature, update_values);
@@ -672,14 +1191,21 @@ void generalizedProblem<dim>::adaptiveRefineCriterion(){
 
 template <int dim>
 void generalizedProblem<dim>::buildFields(){
-	// Build each of the fields in the system
+	// Build each of the fields in the system, with the finite element degree of the variable. The variables of the packed
+	// group are the components of a single field, with the index variableLayout::fieldIndex of the group
 	for (unsigned int i=0; i<num_var; i++){
-		  if (var_type[i] == "SCALAR"){
+		  const unsigned int degree = variableLayout::degree(i);
+		  if (variableLayout::groupSize(i) > 1){
+			  std::vector<std::string> component_names(var_name.begin()+i, var_name.begin()+i+variableLayout::groupSize(i));
+			  this->fields.push_back(Field<problemDIM>(PARABOLIC, component_names.front() + "-" + component_names.back(), component_names, degree));
+			  i += variableLayout::groupSize(i)-1;
+		  }
+		  else if (var_type[i] == "SCALAR"){
 			  if (var_eq_type[i] == "ELLIPTIC"){
-				  this->fields.push_back(Field<problemDIM>(SCALAR, ELLIPTIC, var_name[i]));
+				  this->fields.push_back(Field<problemDIM>(SCALAR, ELLIPTIC, var_name[i], degree));
 			  }
 			  else if (var_eq_type[i] == "PARABOLIC"){
-				  this->fields.push_back(Field<problemDIM>(SCALAR, PARABOLIC, var_name[i]));
+				  this->fields.push_back(Field<problemDIM>(SCALAR, PARABOLIC, var_name[i], degree));
 			  }
 			  else{
 				  // Need to change to throw an exception
@@ -688,10 +1214,10 @@ void generalizedProblem<dim>::buildFields(){
 		  }
 		  else if (var_type[i] == "VECTOR"){
 			  if (var_eq_type[i] == "ELLIPTIC"){
-				  this->fields.push_back(Field<problemDIM>(VECTOR, ELLIPTIC, var_name[i]));
+				  this->fields.push_back(Field<problemDIM>(VECTOR, ELLIPTIC, var_name[i], degree));
 			  }
 			  else if (var_eq_type[i] == "PARABOLIC"){
-				  this->fields.push_back(Field<problemDIM>(VECTOR, PARABOLIC, var_name[i]));
+				  this->fields.push_back(Field<problemDIM>(VECTOR, PARABOLIC, var_name[i], degree));
 			  }
 			  else{
 				  // Need to change to throw an exception
@@ -706,22 +1232,42 @@ void generalizedProblem<dim>::buildFields(){
 // INITIAL CONDITION FUNCTIONS
 // =====================================================================
 
+// Initial condition of the packed field: the initial condition of each variable of the group (ICs_and_BCs.h) in its component
+template <int dim>
+class packedInitialCondition : public Function<dim>
+{
+public:
+  packedInitialCondition (const unsigned int first_var, const unsigned int n_var) : Function<dim>(n_var) {
+	  for (unsigned int c=0; c<n_var; c++){
+		  varICs.push_back(InitialCondition<dim>(first_var+c));
+	  }
+  }
+  double value (const Point<dim> &p, const unsigned int component = 0) const
+  {
+	  return varICs[component].value(p);
+  }
+
+private:
+  std::vector<InitialCondition<dim> > varICs;
+};
+
 //apply initial conditions
 template <int dim>
 void generalizedProblem<dim>::applyInitialConditions()
 {
 
-unsigned int fieldIndex = 0;
-
 for (unsigned int var_index=0; var_index < num_var; var_index++){
 
-	  if (var_type[var_index] == "SCALAR"){
+	  const unsigned int fieldIndex = variableLayout::fieldIndex(var_index);
+	  if (variableLayout::groupSize(var_index) > 1){
+		  VectorTools::interpolate (*this->dofHandlersSet[fieldIndex], packedInitialCondition<dim>(var_index, variableLayout::groupSize(var_index)), *this->solutionSet[fieldIndex]);
+		  var_index += variableLayout::groupSize(var_index)-1;
+	  }
+	  else if (var_type[var_index] == "SCALAR"){
 		  VectorTools::interpolate (*this->dofHandlersSet[fieldIndex], InitialCondition<dim>(var_index), *this->solutionSet[fieldIndex]);
-		  fieldIndex++;
 	  }
 	  else {
 		  VectorTools::interpolate (*this->dofHandlersSet[fieldIndex], InitialConditionVec<dim>(var_index), *this->solutionSet[fieldIndex]);
-		  fieldIndex += dim;
 	  }
 }
 }
@@ -744,12 +1290,12 @@ private:
 };
 
 template <int dim>
-vectorBCFunction<dim>::vectorBCFunction(std::vector<double> input_values) : Function<dim>(dim), BC_values (input_values) {}
+vectorBCFunction<dim>::vectorBCFunction(std::vector<double> input_values) : Function<dim>(input_values.size()), BC_values (input_values) {}
 
 template <int dim>
 void vectorBCFunction<dim>::vector_value(const Point<dim> &p, Vector<double> &values) const {
 
-	for (unsigned int i=0; i<dim; i++) {
+	for (unsigned int i=0; i<BC_values.size(); i++) {
 		values(i) = BC_values[i];
 	}
 }
@@ -764,43 +1310,48 @@ void vectorBCFunction<dim>::vector_value_list (const std::vector<Point<dim>> &po
 //apply Dirchlet BC function
 template <int dim>
 void generalizedProblem<dim>::applyDirichletBCs(){
-  // First, get the variable index of the current field
-  unsigned int var_index;
-  unsigned int field_number = 0;
+  // First, get the variable index of the current field and the index of its first component in BC_list (where the BCs
+  // are in the order of the variables, one per component)
+  unsigned int var_index = 0;
+  unsigned int BC_index = 0;
+  unsigned int component_number = 0;
   for (unsigned int i=0; i<num_var; i++){
 
-	  if (field_number == this->currentFieldIndex){
+	  if ((variableLayout::fieldIndex(i) == this->currentFieldIndex) && (variableLayout::fieldComponent(i) == 0)){
 		  var_index = i;
+		  BC_index = component_number;
 	  }
 
 	  if (var_type[i] == "SCALAR"){
-		  field_number++;
+		  component_number++;
 	  }
 	  else {
-		  field_number+=dim;
+		  component_number+=dim;
 	  }
   }
 
-  if (var_type[var_index] == "SCALAR"){
+  if ((var_type[var_index] == "SCALAR") && (variableLayout::groupSize(var_index) == 1)){
 	  for (unsigned int direction = 0; direction < 2*dim; direction++){
-		  if (BC_list[this->currentFieldIndex].var_BC_type[direction] == "DIRICHLET"){
+		  if (BC_list[BC_index].var_BC_type[direction] == "DIRICHLET"){
 			  VectorTools::interpolate_boundary_values (*this->dofHandlersSet[this->currentFieldIndex],\
-					  direction, ConstantFunction<dim>(BC_list[this->currentFieldIndex].var_BC_val[direction],1), *(ConstraintMatrix*) \
+					  direction, ConstantFunction<dim>(BC_list[BC_index].var_BC_val[direction],1), *(ConstraintMatrix*) \
 					  this->constraintsSet[this->currentFieldIndex]);
 		  }
 	  }
   }
   else {
+	  // Vector field, or the packed field (one scalar variable per component)
+	  const unsigned int n_components = this->fields[this->currentFieldIndex].numComponents;
 	  for (unsigned int direction = 0; direction < 2*dim; direction++){
 
 		  std::vector<double> BC_values;
-		  for (unsigned int component=0; component < dim; component++){
-			  BC_values.push_back(BC_list[this->currentFieldIndex+component].var_BC_val[direction]);
+		  for (unsigned int component=0; component < n_components; component++){
+			  BC_values.push_back(BC_list[BC_index+component].var_BC_val[direction]);
 		  }
 
 		  std::vector<bool> mask;
-		  for (unsigned int component=0; component < dim; component++){
-			  if (BC_list[this->currentFieldIndex+component].var_BC_type[direction] == "DIRICHLET"){
+		  for (unsigned int component=0; component < n_components; component++){
+			  if (BC_list[BC_index+component].var_BC_type[direction] == "DIRICHLET"){
 				  mask.push_back(true);
 			  }
 			  else {
@@ -808,6 +1359,9 @@ void generalizedProblem<dim>::applyDirichletBCs(){
 			  }
 		  }
 
+		  if (std::find(mask.begin(), mask.end(), true) == mask.end()){
+			  continue;
+		  }
 
 		  VectorTools::interpolate_boundary_values (*this->dofHandlersSet[this->currentFieldIndex],\
 				  direction, vectorBCFunction<dim>(BC_values), *(ConstraintMatrix*) \
@@ -935,9 +1489,25 @@ struct nucleus{
 //vector of all nucleus seeded in the problem
 std::vector<nucleus> nuclei, localNuclei;
 
-//nucleation model implementation
+//modify the fields between increments: seed the nuclei and remap the grains. The energy requested on the last output
+//step (fuseEnergyWithRHS) is computed first on the increments that modify the fields
 template <int dim>
 void generalizedProblem<dim>::modifySolutionFields()
+{
+#if nucleation_occurs == true
+  seedNuclei();
+#endif
+#if grainRemapping == true
+  if (this->currentIncrement % grainRemapInterval == 0){
+	  this->flushPendingEnergy();
+	  remapGrains();
+  }
+#endif
+}
+
+//nucleation model implementation
+template <int dim>
+void generalizedProblem<dim>::seedNuclei()
 {
   //current time
   double t=this->currentTime;
@@ -1149,6 +1719,14 @@ void generalizedProblem<dim>::modifySolutionFields()
     }
   }
 
+  //the nuclei are the same on all the processors, so are the increments on which a nucleus is seeded
+  for (std::vector<nucleus>::iterator thisNuclei=nuclei.begin(); thisNuclei!=nuclei.end(); ++thisNuclei){
+	  if ((t>thisNuclei->seededTime) && (t<(thisNuclei->seededTime+thisNuclei->seedingTime))){
+		  this->flushPendingEnergy();
+		  break;
+	  }
+  }
+
   //seed nuclei
   unsigned int fieldIndex=this->getFieldIndex("n1");
   for (std::vector<nucleus>::iterator thisNuclei=nuclei.begin(); thisNuclei!=nuclei.end(); ++thisNuclei){
@@ -1171,6 +1749,8 @@ void generalizedProblem<dim>::modifySolutionFields()
 					  //this->pcout << "times: " << t << " " << seededTime << " " << seedingTime << std::endl;
 					  //(*n1)(dof)=0.5*(1.0-std::tanh((r-radius)/(dx)));
 					  (*n1)(dof)=0.5*(1.0-std::tanh((r-radius)/(0.4)));
+					  // the cell batches of the nucleus have to be evaluated in full in the next increment
+					  activeSetValid = false;
 				  }
 			  }
 		  }
@@ -1178,3 +1758,70 @@ void generalizedProblem<dim>::modifySolutionFields()
   }
 }
 
+// Grain remapping: find the grains of the order parameters (grain_remap_var in equations.h, by default the variables of the
+// packed group) and move the grains too close to a grain of the same order parameter to another order parameter
+template <int dim>
+void generalizedProblem<dim>::remapGrains()
+{
+#ifdef grain_remap_var
+  const unsigned int remapVarList[] = grain_remap_var;
+  std::vector<unsigned int> remapVars(remapVarList, remapVarList+sizeof(remapVarList)/sizeof(remapVarList[0]));
+#else
+  std::vector<unsigned int> remapVars;
+  if (variableLayout::numPacked > 1){
+	  for (unsigned int i=0; i<variableLayout::numPacked; i++){
+		  remapVars.push_back(variableLayout::packedFirst+i);
+	  }
+  }
+#endif
+  if (remapVars.size() < 2){
+	  this->pcout << "\nError: grain remapping needs at least two order parameters (grain_remap_var or the packed group in equations.h)\n";
+	  exit(-1);
+  }
+
+  // Field, component and DoFHandler of each order parameter
+  std::vector<const DoFHandler<dim>*> remapDofHandlers;
+  std::vector<vectorType*> remapVectors;
+  std::vector<unsigned int> remapComponents;
+  for (unsigned int v=0; v<remapVars.size(); v++){
+	  const unsigned int i = remapVars[v];
+	  const unsigned int fieldIndex = variableLayout::fieldIndex(i);
+	  if ((i >= num_var) || (var_type[i] != "SCALAR") || (this->fields[fieldIndex].pdetype != PARABOLIC)
+			  || (this->dofHandlersSet[fieldIndex]->get_fe().degree != this->dofHandlersSet[variableLayout::fieldIndex(remapVars[0])]->get_fe().degree)){
+		  this->pcout << "\nError: the order parameters of the grain remapping must be PARABOLIC scalar variables of the same finite element degree\n";
+		  exit(-1);
+	  }
+	  remapDofHandlers.push_back(this->dofHandlersSet[fieldIndex]);
+	  remapVectors.push_back(this->solutionSet[fieldIndex]);
+	  remapComponents.push_back(variableLayout::fieldComponent(i));
+  }
+
+  grainRemap.findGrains(remapDofHandlers, remapVectors, remapComponents, grainThreshold);
+  if (grainRemap.remap(remapDofHandlers, remapVectors, remapComponents, grainBufferDistance, this->pcout) > 0){
+	  for (unsigned int v=0; v<remapVars.size(); v++){
+		  const unsigned int fieldIndex = variableLayout::fieldIndex(remapVars[v]);
+		  this->constraintsHangingNodesSet[fieldIndex]->distribute(*this->solutionSet[fieldIndex]);
+		  this->solutionSet[fieldIndex]->update_ghost_values();
+	  }
+	  // the cell batches of the moved grains have to be evaluated in full in the next increment
+	  activeSetValid = false;
+  }
+}
+
+
+// Standard normal noise at the points of the lanes. The points are located on a grid of 2^30 points along each direction
+// of the domain, fine enough to tell all the quadrature points apart, so that the noise is a function of the point only
+template <int dim>
+dealii::VectorizedArray<double> generalizedProblem<dim>::gaussianNoise(const dealii::Point<dim, dealii::VectorizedArray<double> > &location,
+		unsigned int stream) const
+{
+	// The locations are only computed with need_q_point_loc (otherwise q_point_loc is the origin at all the points). The
+	// condition depends on dim so that only the models calling gaussianNoise are checked
+	static_assert((dim > 0) && (need_q_point_loc == true), "gaussianNoise needs need_q_point_loc to be true in equations.h");
+	const double span[3] = {spanX, spanY, spanZ};
+	double resolution[dim];
+	for (unsigned int d=0; d<dim; d++){
+		resolution[d] = std::ldexp(span[d], -30);
+	}
+	return randomNoise::gaussian<dim>(location, resolution, this->currentIncrement, stream, noiseSeed);
+}
@@ -0,0 +1,1080 @@
+// =====================================================================
+// COMPILE-TIME VARIABLE LAYOUT
+// =====================================================================
+// The variable types and the flags in equations.h are compile-time constants, so the
+// per-variable work in getRHS and getEnergy (reading, evaluating, filling modelVarList,
+// submitting and integrating) is unrolled over the variable index. The checks of the
+// variable type and of the flags are then resolved by the compiler, and the branches
+// for flags that are false are removed.
+
+namespace variableLayout {
+
+constexpr const char* varType[] = variable_type;
+constexpr const char* varEqType[] = variable_eq_type;
+constexpr bool needValue[] = need_val;
+constexpr bool needGradient[] = need_grad;
+constexpr bool needHessian[] = need_hess;
+constexpr bool valueResidual[] = need_val_residual;
+constexpr bool gradientResidual[] = need_grad_residual;
+#ifdef variable_degree
+constexpr int varDegree[] = variable_degree;
+static_assert(sizeof(varDegree)/sizeof(varDegree[0]) == num_var, "variable_degree needs one degree per variable");
+#endif
+
+constexpr bool isScalar(unsigned int i){
+	return varType[i][0] == 'S';
+}
+
+// Packed group of variables (packed_var_first and num_packed_var in equations.h): consecutive SCALAR PARABOLIC variables with the
+// same flags, stored as the components of a single field (one DoFHandler, with the values of the variables interleaved at each
+// node) and evaluated with a single FEEvaluation object of num_packed_var components. Without a packed group, each variable is
+// a field of its own (a group of one variable)
+#ifdef num_packed_var
+constexpr unsigned int packedFirst = packed_var_first;
+constexpr unsigned int numPacked = num_packed_var;
+static_assert((numPacked > 0) && (packedFirst+numPacked <= num_var), "packed_var_first and num_packed_var must give a group of variables in equations.h");
+#else
+constexpr unsigned int packedFirst = 0;
+constexpr unsigned int numPacked = 1;
+#endif
+
+// Whether variable i is in the packed group
+constexpr bool isPacked(unsigned int i){
+	return (numPacked > 1) && (i >= packedFirst) && (i < packedFirst+numPacked);
+}
+
+// Number of variables evaluated together with variable i (the size of the packed group for its first variable, else one)
+constexpr unsigned int groupSize(unsigned int i){
+	return ((numPacked > 1) && (i == packedFirst)) ? numPacked : 1;
+}
+
+// Index of the field (and DoFHandler) of variable i, and the component of the field for a packed variable
+constexpr unsigned int fieldIndex(unsigned int i){
+	return (i <= packedFirst) ? i : ((i < packedFirst+numPacked) ? packedFirst : i-numPacked+1);
+}
+
+constexpr unsigned int fieldComponent(unsigned int i){
+	return isPacked(i) ? i-packedFirst : 0;
+}
+
+constexpr unsigned int numFields = num_var-numPacked+1;
+
+// Sparse evaluation of the packed group (num_active_packed_var in equations.h): in each cell batch, only numActive
+// components of the packed field, the ones above activePackedTolerance at a node of the batch and the largest other ones,
+// are passed to the residual equations, in the model variables of the first numActive variables of the group. The other
+// components keep their values (their residual is the mass term only, which is the update of a zero order parameter), so
+// the work of the residual equations per quadrature point depends on the number of active order parameters instead of the
+// size of the group. The cell batches with more than numActive components above the tolerance pass the whole group (see
+// activeSelection.h), so the residual equations loop over the numActive member of the model variable of the first variable
+#ifdef num_active_packed_var
+constexpr unsigned int numActive = num_active_packed_var;
+static_assert((numActive > 0) && (numActive <= numPacked), "num_active_packed_var must be at most num_packed_var");
+#else
+constexpr unsigned int numActive = numPacked;
+#endif
+constexpr bool isSparse = numActive < numPacked;
+
+// Finite element degree of variable i (finiteElementDegree unless variable_degree is given in equations.h)
+constexpr int degree(unsigned int i){
+#ifdef variable_degree
+	return varDegree[i];
+#else
+	return finiteElementDegree;
+#endif
+}
+
+// The variables of the packed group have the same flags and degree
+constexpr bool packedGroupMatches(unsigned int i){
+	return (i >= packedFirst+numPacked) || ((needValue[i] == needValue[packedFirst]) && (needGradient[i] == needGradient[packedFirst])
+			&& (needHessian[i] == needHessian[packedFirst]) && (valueResidual[i] == valueResidual[packedFirst])
+			&& (gradientResidual[i] == gradientResidual[packedFirst]) && (degree(i) == degree(packedFirst))
+			&& isScalar(i) && packedGroupMatches(i+1));
+}
+static_assert(packedGroupMatches(packedFirst), "the variables of the packed group must be SCALAR with the same flags and degree");
+static_assert(!isSparse || (needValue[packedFirst] && valueResidual[packedFirst]), "the sparse packed group (num_active_packed_var) needs the values and a value residual");
+
+// Whether variable i is evaluated by collocation (see gaussLobattoCollocation): its nodes are the Gauss-Lobatto quadrature
+// points, so the values at the quadrature points are the DOF values and the integral of a value residual times the test
+// function of a node is the residual times JxW at that node
+constexpr bool isCollocated(unsigned int i){
+	return gaussLobattoCollocation && (degree(i) == finiteElementDegree);
+}
+
+// Whether the Hessian of variable i in the RHS is recovered (see recoveredHessians): ELLIPTIC variables with need_hess get
+// the symmetrized gradient of the L2 projections of their gradient components, so only gradients are evaluated
+constexpr bool isRecovered(unsigned int i){
+	return recoveredHessians && needHessian[i] && (varEqType[i][0] == 'E');
+}
+
+constexpr bool anyRecovered(unsigned int i){
+	return (i < num_var) && (isRecovered(i) || anyRecovered(i+1));
+}
+
+// Whether the Hessian of variable i is evaluated by its FEEvaluation object
+constexpr bool evaluatedHessian(unsigned int i){
+	return needHessian[i] && !isRecovered(i);
+}
+
+constexpr bool isEvaluated(unsigned int i){
+	return needValue[i] || needGradient[i] || needHessian[i];
+}
+
+constexpr bool isIntegrated(unsigned int i){
+	return valueResidual[i] || gradientResidual[i];
+}
+
+// Whether any variable from i on has a value residual integrated by collocation (which needs the JxW values of the cell)
+constexpr bool anyCollocatedValueResidual(unsigned int i){
+	return (i < num_var) && ((isCollocated(i) && valueResidual[i]) || anyCollocatedValueResidual(i+1));
+}
+
+// Whether all the lanes of a value are within tol of zero (false for nan)
+inline bool withinTolerance(const dealii::VectorizedArray<double> & x, double tol){
+	for (unsigned int v=0; v<dealii::VectorizedArray<double>::n_array_elements; v++){
+		if (!(std::abs(x[v]) <= tol)){
+			return false;
+		}
+	}
+	return true;
+}
+
+template <int rank, int dim>
+inline bool withinTolerance(const dealii::Tensor<rank,dim,dealii::VectorizedArray<double> > & x, double tol){
+	for (unsigned int d=0; d<dim; d++){
+		if (!withinTolerance(x[d], tol)){
+			return false;
+		}
+	}
+	return true;
+}
+
+// FEEvaluation type of variable i: the degree of the variable on the quadrature of finiteElementDegree, which is
+// common to all the variables (so the variables of a lower degree are evaluated at the same quadrature points). The
+// evaluator of the first variable of the packed group has one component per variable of the group
+template <int dim, unsigned int i>
+struct evaluator{
+	static const unsigned int n_components = isScalar(i) ? groupSize(i) : dim;
+	typedef dealii::FEEvaluation<dim,degree(i),finiteElementDegree+1,n_components,double> type;
+	typedef typename std::conditional<(groupSize(i) > 1), dealii::Tensor<1,groupSize(i),dealii::VectorizedArray<double> >,
+			typename std::conditional<isScalar(i), scalarvalueType, vectorvalueType>::type>::type valueType;
+};
+
+// Components of the packed field passed to the residual equations for a cell batch (see numActive): slot s of the group is
+// component component(s), for the size() first slots. A group of one variable has a single slot
+template <unsigned int n_group>
+struct activeComponents{
+	static const unsigned int n_slots = isSparse ? numActive : n_group;
+	unsigned int n_active;
+	unsigned int index[n_group];
+
+	unsigned int component(unsigned int s) const {
+		return isSparse ? index[s] : s;
+	}
+
+	// Number of slots passed in the cell batch: n_slots, or the whole group if the batch is evaluated densely
+	unsigned int size() const {
+		return isSparse ? n_active : n_group;
+	}
+
+	// Select the components from their largest absolute DOF values over the nodes and the lanes of the cell batch (see
+	// activeSelection.h and activePackedTolerance)
+	template <typename evaluatorType>
+	void select(const evaluatorType & var, unsigned int n_dofs){
+		if (!isSparse){
+			return;
+		}
+		double maxValue[n_group];
+		for (unsigned int c=0; c<n_group; c++){
+			maxValue[c] = 0.0;
+		}
+		for (unsigned int k=0; k<n_dofs; k++){
+			activeSelection::addMaxAbs<n_group>(var.get_dof_value(k), maxValue);
+		}
+		n_active = activeSelection::select<n_group>(maxValue, n_slots, activePackedTolerance, index);
+	}
+};
+
+template <>
+struct activeComponents<1>{
+	static const unsigned int n_slots = 1;
+
+	unsigned int component(unsigned int) const {
+		return 0;
+	}
+
+	unsigned int size() const {
+		return 1;
+	}
+
+	template <typename evaluatorType>
+	void select(const evaluatorType &, unsigned int){}
+};
+
+// Number of nodes of a cell for degree p
+constexpr unsigned int nodesPerCell(int dim, int p){
+	return (dim == 1) ? p+1 : ((dim == 2) ? (p+1)*(p+1) : (p+1)*(p+1)*(p+1));
+}
+
+// Call f(var) for the variable chosen at runtime. The variables of the packed group aren't in the LHS (see the constructor)
+template <bool is_packed>
+struct applyEvaluator{
+	template <typename evaluatorType, typename F>
+	static void apply(evaluatorType & var, const F & f){
+		f(var);
+	}
+};
+
+template <>
+struct applyEvaluator<true>{
+	template <typename evaluatorType, typename F>
+	static void apply(evaluatorType &, const F &){}
+};
+
+// One FEEvaluation object per field, for variables i to n-1. The object of variable i refers to the DoFHandler
+// with the index fieldIndex(i) in the MatrixFree object (see buildFields()), and the next object is the one of the
+// variable after its packed group. The value residuals times JxW of a collocated variable are kept in valueResidualJxW
+// until they are added to the DOF values in integrate(), and active holds the components of a packed group passed to the
+// residual equations for the current cell batch. A variable with a recovered Hessian has one more object per direction d,
+// for the projection of its derivative along d (read from recoveredSrc[d])
+template <int dim, unsigned int i, unsigned int n>
+struct evaluatorList{
+	typedef typename evaluator<dim,i>::type evaluatorType;
+	typedef typename evaluator<dim,i>::valueType valueType;
+
+	evaluatorType var;
+	dealii::AlignedVector<valueType> valueResidualJxW;
+	activeComponents<groupSize(i)> active;
+	dealii::AlignedVector<evaluatorType> recovered;
+	std::vector<const vectorType*> recoveredSrc;
+	evaluatorList<dim,i+groupSize(i),n> next;
+
+	evaluatorList(const dealii::MatrixFree<dim,double> & data): var(data, fieldIndex(i)),
+			valueResidualJxW((isCollocated(i) && valueResidual[i]) ? evaluatorType::n_q_points : 0), next(data){
+		if (isRecovered(i)){
+			for (unsigned int d=0; d<dim; d++){
+				recovered.push_back(evaluatorType(data, fieldIndex(i)));
+			}
+		}
+	}
+
+	// Call f(var) with the FEEvaluation object of variable index (for the loops over the variables in runtime order)
+	template <typename F>
+	void apply(const unsigned int index, const F & f){
+		if (index == i){
+			applyEvaluator<isPacked(i)>::apply(var, f);
+		}
+		else {
+			next.apply(index, f);
+		}
+	}
+};
+
+template <int dim, unsigned int n>
+struct evaluatorList<dim,n,n>{
+	evaluatorList(const dealii::MatrixFree<dim,double> &){}
+
+	template <typename F>
+	void apply(const unsigned int, const F &){}
+};
+
+// Entries of the model variable and residual types (which are VectorizedArrays instead of tensors in 1D, see matrixFreePDE.h)
+inline dealii::VectorizedArray<double> & entry(dealii::VectorizedArray<double> & x, unsigned int){return x;}
+inline dealii::VectorizedArray<double> & entry(dealii::VectorizedArray<double> & x, unsigned int, unsigned int){return x;}
+inline dealii::VectorizedArray<double> & entry(dealii::VectorizedArray<double> & x, unsigned int, unsigned int, unsigned int){return x;}
+inline const dealii::VectorizedArray<double> & entry(const dealii::VectorizedArray<double> & x, unsigned int){return x;}
+inline const dealii::VectorizedArray<double> & entry(const dealii::VectorizedArray<double> & x, unsigned int, unsigned int){return x;}
+
+template <int dim>
+inline dealii::VectorizedArray<double> & entry(dealii::Tensor<1,dim,dealii::VectorizedArray<double> > & x, unsigned int i){return x[i];}
+template <int dim>
+inline dealii::VectorizedArray<double> & entry(dealii::Tensor<2,dim,dealii::VectorizedArray<double> > & x, unsigned int i, unsigned int j){return x[i][j];}
+template <int dim>
+inline dealii::VectorizedArray<double> & entry(dealii::Tensor<3,dim,dealii::VectorizedArray<double> > & x, unsigned int i, unsigned int j, unsigned int k){return x[i][j][k];}
+template <int dim>
+inline const dealii::VectorizedArray<double> & entry(const dealii::Tensor<1,dim,dealii::VectorizedArray<double> > & x, unsigned int i){return x[i];}
+template <int dim>
+inline const dealii::VectorizedArray<double> & entry(const dealii::Tensor<2,dim,dealii::VectorizedArray<double> > & x, unsigned int i, unsigned int j){return x[i][j];}
+
+// Derivative along d of component c of a vector FEEvaluation gradient (a tensor of rank 1 for the single component in 1D)
+template <int dim>
+inline const dealii::VectorizedArray<double> & componentDerivative(const dealii::Tensor<2,dim,dealii::VectorizedArray<double> > & x, unsigned int c, unsigned int d){return x[c][d];}
+template <int dim>
+inline const dealii::VectorizedArray<double> & componentDerivative(const dealii::Tensor<1,dim,dealii::VectorizedArray<double> > & x, unsigned int, unsigned int d){return x[d];}
+
+// Access to the model variable slots of scalar and vector FEEvaluation objects
+template <bool is_scalar>
+struct fieldAccess;
+
+template <>
+struct fieldAccess<true>{
+	template <typename evaluatorType, int dim>
+	static void get(const evaluatorType & var, modelVariable<dim> & modelVar, unsigned int q, bool value, bool gradient, bool hessian){
+		if (value){
+			modelVar.scalarValue = var.get_value(q);
+		}
+		if (gradient){
+			modelVar.scalarGrad = var.get_gradient(q);
+		}
+		if (hessian){
+			modelVar.scalarHess = var.get_hessian(q);
+		}
+	}
+
+	template <typename evaluatorType, int dim>
+	static void submit(evaluatorType & var, const modelResidual<dim> & modelRes, unsigned int q, bool value, bool gradient){
+		if (value){
+			var.submit_value(modelRes.scalarValueResidual,q);
+		}
+		if (gradient){
+			var.submit_gradient(modelRes.scalarGradResidual,q);
+		}
+	}
+
+	// Value at a quadrature point of a collocated variable (the DOF value of the node at the quadrature point)
+	template <typename evaluatorType, int dim>
+	static void getDofValue(const evaluatorType & var, modelVariable<dim> & modelVar, unsigned int q){
+		modelVar.scalarValue = var.get_dof_value(q);
+	}
+
+	template <int dim>
+	static const scalarvalueType & valueResidual(const modelResidual<dim> & modelRes){
+		return modelRes.scalarValueResidual;
+	}
+
+	// Whether the residuals give a zero update: value residual equal to the value and no gradient residual
+	template <int dim>
+	static bool zeroUpdate(const modelVariable<dim> & modelVar, const modelResidual<dim> & modelRes, bool value, bool gradient, double tol){
+		return (!value || withinTolerance(modelRes.scalarValueResidual - modelVar.scalarValue, tol))
+				&& (!gradient || withinTolerance(modelRes.scalarGradResidual, tol));
+	}
+
+	// Submit the derivative along d of var as the value of recovered (for the projection of the derivative, see isRecovered)
+	template <typename evaluatorType>
+	static void submitDerivative(const evaluatorType & var, evaluatorType & recovered, unsigned int q, unsigned int d){
+		recovered.submit_value(var.get_gradient(q)[d], q);
+	}
+
+	// Recovered Hessian (see isRecovered): symmetrized gradients of the projected derivatives along each direction
+	template <typename evaluatorType, int dim>
+	static void getRecoveredHessian(const dealii::AlignedVector<evaluatorType> & recovered, modelVariable<dim> & modelVar, unsigned int q){
+		typedef decltype(recovered[0].get_gradient(q)) gradientType;
+		gradientType gradients[dim];
+		for (unsigned int d=0; d<dim; d++){
+			gradients[d] = recovered[d].get_gradient(q);
+		}
+		for (unsigned int d=0; d<dim; d++){
+			for (unsigned int e=0; e<dim; e++){
+				entry(modelVar.scalarHess, d, e) = constV(0.5)*(gradients[d][e] + gradients[e][d]);
+			}
+		}
+	}
+};
+
+template <>
+struct fieldAccess<false>{
+	template <typename evaluatorType, int dim>
+	static void get(const evaluatorType & var, modelVariable<dim> & modelVar, unsigned int q, bool value, bool gradient, bool hessian){
+		if (value){
+			modelVar.vectorValue = var.get_value(q);
+		}
+		if (gradient){
+			modelVar.vectorGrad = var.get_gradient(q);
+		}
+		if (hessian){
+			modelVar.vectorHess = var.get_hessian(q);
+		}
+	}
+
+	template <typename evaluatorType, int dim>
+	static void submit(evaluatorType & var, const modelResidual<dim> & modelRes, unsigned int q, bool value, bool gradient){
+		if (value){
+			var.submit_value(modelRes.vectorValueResidual,q);
+		}
+		if (gradient){
+			var.submit_gradient(modelRes.vectorGradResidual,q);
+		}
+	}
+
+	template <typename evaluatorType, int dim>
+	static void getDofValue(const evaluatorType & var, modelVariable<dim> & modelVar, unsigned int q){
+		modelVar.vectorValue = var.get_dof_value(q);
+	}
+
+	template <int dim>
+	static const vectorvalueType & valueResidual(const modelResidual<dim> & modelRes){
+		return modelRes.vectorValueResidual;
+	}
+
+	template <int dim>
+	static bool zeroUpdate(const modelVariable<dim> & modelVar, const modelResidual<dim> & modelRes, bool value, bool gradient, double tol){
+		return (!value || withinTolerance(modelRes.vectorValueResidual - modelVar.vectorValue, tol))
+				&& (!gradient || withinTolerance(modelRes.vectorGradResidual, tol));
+	}
+
+	template <typename evaluatorType>
+	static void submitDerivative(const evaluatorType & var, evaluatorType & recovered, unsigned int q, unsigned int d){
+		const auto gradient = var.get_gradient(q);
+		vectorvalueType derivative;
+		for (unsigned int c=0; c<problemDIM; c++){
+			entry(derivative, c) = componentDerivative(gradient, c, d);
+		}
+		recovered.submit_value(derivative, q);
+	}
+
+	template <typename evaluatorType, int dim>
+	static void getRecoveredHessian(const dealii::AlignedVector<evaluatorType> & recovered, modelVariable<dim> & modelVar, unsigned int q){
+		typedef decltype(recovered[0].get_gradient(q)) gradientType;
+		gradientType gradients[dim];
+		for (unsigned int d=0; d<dim; d++){
+			gradients[d] = recovered[d].get_gradient(q);
+		}
+		for (unsigned int c=0; c<dim; c++){
+			for (unsigned int d=0; d<dim; d++){
+				for (unsigned int e=0; e<dim; e++){
+					entry(modelVar.vectorHess, c, d, e) = constV(0.5)*(componentDerivative(gradients[d], c, e) + componentDerivative(gradients[e], c, d));
+				}
+			}
+		}
+	}
+};
+
+// Access to the model variables of a group of variables (see groupSize) in the slots of its FEEvaluation object, starting
+// from the model variable (and residual) of the first variable of the group. Slot s of a packed group is the component
+// active.component(s) (see numActive), and the number of slots of the cell batch is stored in the numActive member of the
+// model variable of the first variable of the group. A group of one variable is a field of its own
+template <unsigned int n_group, bool is_scalar>
+struct groupAccess{
+	typedef activeComponents<n_group> activeType;
+
+	template <typename evaluatorType, int dim>
+	static void get(const evaluatorType & var, modelVariable<dim> * modelVars, unsigned int q, bool value, bool gradient, bool hessian,
+			const activeType & active){
+		modelVars[0].numActive = active.size();
+		if (value){
+			const auto values = var.get_value(q);
+			for (unsigned int s=0; s<active.size(); s++){
+				modelVars[s].scalarValue = values[active.component(s)];
+			}
+		}
+		if (gradient){
+			const auto gradients = var.get_gradient(q);
+			for (unsigned int s=0; s<active.size(); s++){
+				for (unsigned int d=0; d<dim; d++){
+					entry(modelVars[s].scalarGrad, d) = gradients[active.component(s)][d];
+				}
+			}
+		}
+		if (hessian){
+			const auto hessians = var.get_hessian(q);
+			for (unsigned int s=0; s<active.size(); s++){
+				for (unsigned int d=0; d<dim; d++){
+					for (unsigned int e=0; e<dim; e++){
+						entry(modelVars[s].scalarHess, d, e) = hessians[active.component(s)][d][e];
+					}
+				}
+			}
+		}
+	}
+
+	// The components outside of the slots get a zero gradient residual
+	template <typename evaluatorType, int dim>
+	static void submit(evaluatorType & var, const modelResidual<dim> * modelRes, unsigned int q, bool value, bool gradient,
+			const activeType & active){
+		if (value){
+			var.submit_value(valueResidual(var, modelRes, q, false, active), q);
+		}
+		if (gradient){
+			dealii::Tensor<1,n_group,dealii::Tensor<1,dim,dealii::VectorizedArray<double> > > gradients;
+			for (unsigned int s=0; s<active.size(); s++){
+				for (unsigned int d=0; d<dim; d++){
+					gradients[active.component(s)][d] = entry(modelRes[s].scalarGradResidual, d);
+				}
+			}
+			var.submit_gradient(gradients, q);
+		}
+	}
+
+	template <typename evaluatorType, int dim>
+	static void getDofValue(const evaluatorType & var, modelVariable<dim> * modelVars, unsigned int q, const activeType & active){
+		const auto values = var.get_dof_value(q);
+		for (unsigned int s=0; s<active.size(); s++){
+			modelVars[s].scalarValue = values[active.component(s)];
+		}
+	}
+
+	// Value residuals of the components: the residuals of the slots, and the current values (at the quadrature point, or the
+	// DOF values if collocated) of the components outside of the slots
+	template <typename evaluatorType, int dim>
+	static dealii::Tensor<1,n_group,dealii::VectorizedArray<double> > valueResidual(const evaluatorType & var, const modelResidual<dim> * modelRes,
+			unsigned int q, bool collocated, const activeType & active){
+		dealii::Tensor<1,n_group,dealii::VectorizedArray<double> > values;
+		if (isSparse){
+			values = collocated ? var.get_dof_value(q) : var.get_value(q);
+		}
+		for (unsigned int s=0; s<active.size(); s++){
+			values[active.component(s)] = modelRes[s].scalarValueResidual;
+		}
+		return values;
+	}
+
+	// The variables of the packed group are PARABOLIC, so their Hessians aren't recovered
+	template <typename evaluatorType>
+	static void submitDerivative(const evaluatorType &, evaluatorType &, unsigned int, unsigned int){}
+
+	template <typename evaluatorType, int dim>
+	static void getRecoveredHessian(const dealii::AlignedVector<evaluatorType> &, modelVariable<dim> *, unsigned int){}
+
+	template <int dim>
+	static bool zeroUpdate(const modelVariable<dim> * modelVars, const modelResidual<dim> * modelRes, bool value, bool gradient, double tol){
+		for (unsigned int s=0; s<modelVars[0].numActive; s++){
+			if (!fieldAccess<true>::zeroUpdate(modelVars[s], modelRes[s], value, gradient, tol)){
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+template <bool is_scalar>
+struct groupAccess<1,is_scalar>{
+	typedef fieldAccess<is_scalar> access;
+	typedef activeComponents<1> activeType;
+
+	template <typename evaluatorType, int dim>
+	static void get(const evaluatorType & var, modelVariable<dim> * modelVars, unsigned int q, bool value, bool gradient, bool hessian,
+			const activeType &){
+		access::get(var, modelVars[0], q, value, gradient, hessian);
+	}
+
+	template <typename evaluatorType, int dim>
+	static void submit(evaluatorType & var, const modelResidual<dim> * modelRes, unsigned int q, bool value, bool gradient,
+			const activeType &){
+		access::submit(var, modelRes[0], q, value, gradient);
+	}
+
+	template <typename evaluatorType, int dim>
+	static void getDofValue(const evaluatorType & var, modelVariable<dim> * modelVars, unsigned int q, const activeType &){
+		access::getDofValue(var, modelVars[0], q);
+	}
+
+	template <typename evaluatorType, int dim>
+	static auto valueResidual(const evaluatorType &, const modelResidual<dim> * modelRes, unsigned int, bool,
+			const activeType &) -> decltype(access::valueResidual(modelRes[0])){
+		return access::valueResidual(modelRes[0]);
+	}
+
+	template <typename evaluatorType>
+	static void submitDerivative(const evaluatorType & var, evaluatorType & recovered, unsigned int q, unsigned int d){
+		access::submitDerivative(var, recovered, q, d);
+	}
+
+	template <typename evaluatorType, int dim>
+	static void getRecoveredHessian(const dealii::AlignedVector<evaluatorType> & recovered, modelVariable<dim> * modelVars, unsigned int q){
+		access::getRecoveredHessian(recovered, modelVars[0], q);
+	}
+
+	template <int dim>
+	static bool zeroUpdate(const modelVariable<dim> * modelVars, const modelResidual<dim> * modelRes, bool value, bool gradient, double tol){
+		return access::zeroUpdate(modelVars[0], modelRes[0], value, gradient, tol);
+	}
+};
+
+// Operations on the FEEvaluation object of a variable chosen at runtime (see evaluatorList::apply), used by the
+// LHS, where the solved field is only known at runtime
+
+// Reinitialize the evaluator for a cell, read the DOFs of field and evaluate it
+struct evaluateField{
+	unsigned int cell;
+	const vectorType * field;
+	bool value, gradient, hessian;
+
+	evaluateField(unsigned int _cell, const vectorType & _field, bool _value, bool _gradient, bool _hessian):
+		cell(_cell), field(&_field), value(_value), gradient(_gradient), hessian(_hessian){}
+
+	template <typename evaluatorType>
+	void operator()(evaluatorType & var) const{
+		var.reinit(cell);
+		var.read_dof_values_plain(*field);
+		var.evaluate(value, gradient, hessian);
+	}
+};
+
+// Fill a model variable at a quadrature point
+template <int dim>
+struct getField{
+	unsigned int q;
+	modelVariable<dim> * modelVar;
+	bool value, gradient, hessian;
+
+	getField(unsigned int _q, modelVariable<dim> & _modelVar, bool _value, bool _gradient, bool _hessian):
+		q(_q), modelVar(&_modelVar), value(_value), gradient(_gradient), hessian(_hessian){}
+
+	template <typename evaluatorType>
+	void operator()(evaluatorType & var) const{
+		fieldAccess<evaluatorType::n_components == 1>::get(var, *modelVar, q, value, gradient, hessian);
+	}
+};
+
+// Submit a residual at a quadrature point
+template <int dim>
+struct submitField{
+	unsigned int q;
+	const modelResidual<dim> * modelRes;
+	bool value, gradient;
+
+	submitField(unsigned int _q, const modelResidual<dim> & _modelRes, bool _value, bool _gradient):
+		q(_q), modelRes(&_modelRes), value(_value), gradient(_gradient){}
+
+	template <typename evaluatorType>
+	void operator()(evaluatorType & var) const{
+		fieldAccess<evaluatorType::n_components == 1>::submit(var, *modelRes, q, value, gradient);
+	}
+};
+
+// Integrate the submitted residual and add it to dst
+struct integrateField{
+	vectorType * dst;
+	bool value, gradient;
+
+	integrateField(vectorType & _dst, bool _value, bool _gradient): dst(&_dst), value(_value), gradient(_gradient){}
+
+	template <typename evaluatorType>
+	void operator()(evaluatorType & var) const{
+		var.integrate(value, gradient);
+		var.distribute_local_to_global(*dst);
+	}
+};
+
+// Location of a quadrature point
+template <int dim>
+struct getQuadraturePoint{
+	unsigned int q;
+	dealii::Point<dim, dealii::VectorizedArray<double> > * point;
+
+	getQuadraturePoint(unsigned int _q, dealii::Point<dim, dealii::VectorizedArray<double> > & _point): q(_q), point(&_point){}
+
+	template <typename evaluatorType>
+	void operator()(evaluatorType & var) const{
+		*point = var.quadrature_point(q);
+	}
+};
+
+// Per-variable kernels, unrolled from variable i to variable n-1. Each variable is stored in the field (and DoFHandler)
+// fieldIndex(i), see buildFields(), and the variables of the packed group are handled together with the first one
+template <int dim, unsigned int i, unsigned int n>
+struct variableKernel{
+	typedef groupAccess<groupSize(i),isScalar(i)> access;
+	typedef evaluatorList<dim,i,n> listType;
+	static const unsigned int f = fieldIndex(i);
+	static const unsigned int nextVar = i+groupSize(i);
+
+	// Reinitialize the evaluators for a cell, read the DOFs and evaluate the values, gradients and Hessians (the values
+	// of a collocated variable are the DOF values, so only the gradients and Hessians are evaluated). The components of a
+	// sparse packed group passed to the residual equations are selected from the DOF values
+	static void evaluate(listType & vars, const unsigned int cell, const std::vector<vectorType*> & src){
+		if (isEvaluated(i) || isIntegrated(i)){
+			vars.var.reinit(cell);
+			if (isEvaluated(i)){
+				vars.var.read_dof_values_plain(*src[f]);
+				vars.active.select(vars.var, nodesPerCell(dim, degree(i)));
+				if (!isCollocated(i)){
+					vars.var.evaluate(needValue[i], needGradient[i], evaluatedHessian(i));
+				}
+				else if (needGradient[i] || evaluatedHessian(i)){
+					vars.var.evaluate(false, needGradient[i], evaluatedHessian(i));
+				}
+			}
+			if (isRecovered(i)){
+				for (unsigned int d=0; d<dim; d++){
+					vars.recovered[d].reinit(cell);
+					vars.recovered[d].read_dof_values_plain(*vars.recoveredSrc[d]);
+					vars.recovered[d].evaluate(false, true, false);
+				}
+			}
+		}
+		variableKernel<dim,nextVar,n>::evaluate(vars.next, cell, src);
+	}
+
+	// Fill modelVarList at a quadrature point
+	static void get(listType & vars, const unsigned int q, std::vector<modelVariable<dim> > & modelVarList){
+		if (isEvaluated(i)){
+			access::get(vars.var, &modelVarList[i], q, needValue[i] && !isCollocated(i), needGradient[i], evaluatedHessian(i), vars.active);
+			if (needValue[i] && isCollocated(i)){
+				access::getDofValue(vars.var, &modelVarList[i], q, vars.active);
+			}
+			if (isRecovered(i)){
+				access::getRecoveredHessian(vars.recovered, &modelVarList[i], q);
+			}
+		}
+		variableKernel<dim,nextVar,n>::get(vars.next, q, modelVarList);
+	}
+
+	// Submit the residuals at a quadrature point. JxW (see fillJxW) is only used for the value residuals of the collocated
+	// variables (see anyCollocatedValueResidual). Only the residuals of the field rhsField are submitted if it is not negative
+	static void submit(listType & vars, const unsigned int q, const std::vector<modelResidual<dim> > & modelResidualsList,
+			const dealii::AlignedVector<dealii::VectorizedArray<double> > & JxW, const int rhsField){
+		if (isIntegrated(i) && ((rhsField < 0) || (rhsField == (int)f))){
+			access::submit(vars.var, &modelResidualsList[i], q, valueResidual[i] && !isCollocated(i), gradientResidual[i], vars.active);
+			if (valueResidual[i] && isCollocated(i)){
+				vars.valueResidualJxW[q] = access::valueResidual(vars.var, &modelResidualsList[i], q, true, vars.active)*JxW[q];
+			}
+		}
+		variableKernel<dim,nextVar,n>::submit(vars.next, q, modelResidualsList, JxW, rhsField);
+	}
+
+	// Integrate the submitted residuals and add them to the residual vectors. The value residuals of a collocated variable
+	// are added to the DOF values from the gradient residuals (no integration of the values)
+	static void integrate(listType & vars, std::vector<vectorType*> & dst, const int rhsField){
+		if (isIntegrated(i) && ((rhsField < 0) || (rhsField == (int)f))){
+			if (!isCollocated(i) || !valueResidual[i]){
+				vars.var.integrate(valueResidual[i], gradientResidual[i]);
+			}
+			else if (gradientResidual[i]){
+				vars.var.integrate(false, true);
+				for (unsigned int q=0; q<vars.var.n_q_points; ++q){
+					vars.var.submit_dof_value(vars.var.get_dof_value(q) + vars.valueResidualJxW[q], q);
+				}
+			}
+			else {
+				for (unsigned int q=0; q<vars.var.n_q_points; ++q){
+					vars.var.submit_dof_value(vars.valueResidualJxW[q], q);
+				}
+			}
+			vars.var.distribute_local_to_global(*dst[f]);
+		}
+		variableKernel<dim,nextVar,n>::integrate(vars.next, dst, rhsField);
+	}
+
+	// JxW values and quadrature point locations of the cell, from the first variable initialized by evaluate()
+	// (all the variables have the same quadrature)
+	static void fillJxW(listType & vars, dealii::AlignedVector<dealii::VectorizedArray<double> > & JxW){
+		if (isEvaluated(i) || isIntegrated(i)){
+			vars.var.fill_JxW_values(JxW);
+		}
+		else {
+			variableKernel<dim,nextVar,n>::fillJxW(vars.next, JxW);
+		}
+	}
+
+	static dealii::Point<dim, dealii::VectorizedArray<double> > quadraturePoint(listType & vars, const unsigned int q){
+		if (isEvaluated(i) || isIntegrated(i)){
+			return vars.var.quadrature_point(q);
+		}
+		return variableKernel<dim,nextVar,n>::quadraturePoint(vars.next, q);
+	}
+
+	// Whether the residuals at a quadrature point (in modelResidualsList) give a zero update of all the variables (see activeSetSkipping).
+	// The value residual can only be compared with the value if the value is evaluated
+	static bool zeroUpdate(const std::vector<modelVariable<dim> > & modelVarList,
+			const std::vector<modelResidual<dim> > & modelResidualsList, double tol){
+		if (isIntegrated(i)){
+			if (valueResidual[i] && !needValue[i]){
+				return false;
+			}
+			if (!access::zeroUpdate(&modelVarList[i], &modelResidualsList[i], valueResidual[i], gradientResidual[i], tol)){
+				return false;
+			}
+		}
+		return variableKernel<dim,nextVar,n>::zeroUpdate(modelVarList, modelResidualsList, tol);
+	}
+
+	// Reduced kernel of a cell with a zero update: the residual is the mass matrix times the current values, so only the
+	// values are evaluated and integrated
+	static void integrateMass(listType & vars, const unsigned int cell, std::vector<vectorType*> & dst, const std::vector<vectorType*> & src){
+		if (valueResidual[i]){
+			vars.var.reinit(cell);
+			vars.var.read_dof_values_plain(*src[f]);
+			vars.var.evaluate(true, false, false);
+			for (unsigned int q=0; q<vars.var.n_q_points; ++q){
+				vars.var.submit_value(vars.var.get_value(q), q);
+			}
+			vars.var.integrate(true, false);
+			vars.var.distribute_local_to_global(*dst[f]);
+		}
+		variableKernel<dim,nextVar,n>::integrateMass(vars.next, cell, dst, src);
+	}
+
+	// Set the vectors of the projected derivatives read by the variables with a recovered Hessian (recovered[i][d] for
+	// direction d)
+	static void setRecoveredSources(listType & vars, const std::vector<std::vector<vectorType> > & recovered){
+		vars.recoveredSrc.clear();
+		for (unsigned int d=0; d<recovered[i].size(); d++){
+			vars.recoveredSrc.push_back(&recovered[i][d]);
+		}
+		variableKernel<dim,nextVar,n>::setRecoveredSources(vars.next, recovered);
+	}
+
+	// Right-hand sides of the L2 projections of the derivatives of the variables with a recovered Hessian in a cell (the
+	// integrals of the test functions times the derivative along d, added to dst[i][d])
+	static void projectDerivatives(listType & vars, const unsigned int cell, std::vector<std::vector<vectorType> > & dst,
+			const std::vector<vectorType*> & src){
+		if (isRecovered(i)){
+			vars.var.reinit(cell);
+			vars.var.read_dof_values_plain(*src[f]);
+			vars.var.evaluate(false, true, false);
+			for (unsigned int d=0; d<dim; d++){
+				vars.recovered[d].reinit(cell);
+				for (unsigned int q=0; q<vars.var.n_q_points; ++q){
+					access::submitDerivative(vars.var, vars.recovered[d], q, d);
+				}
+				vars.recovered[d].integrate(true, false);
+				vars.recovered[d].distribute_local_to_global(dst[i][d]);
+			}
+		}
+		variableKernel<dim,nextVar,n>::projectDerivatives(vars.next, cell, dst, src);
+	}
+};
+
+// End of the recursion
+template <int dim, unsigned int n>
+struct variableKernel<dim,n,n>{
+	typedef evaluatorList<dim,n,n> listType;
+
+	static void evaluate(listType &, const unsigned int, const std::vector<vectorType*> &){}
+	static void get(listType &, const unsigned int, std::vector<modelVariable<dim> > &){}
+	static void submit(listType &, const unsigned int, const std::vector<modelResidual<dim> > &,
+			const dealii::AlignedVector<dealii::VectorizedArray<double> > &, const int){}
+	static void integrate(listType &, std::vector<vectorType*> &, const int){}
+	static void fillJxW(listType &, dealii::AlignedVector<dealii::VectorizedArray<double> > &){}
+	static dealii::Point<dim, dealii::VectorizedArray<double> > quadraturePoint(listType &, const unsigned int){
+		return dealii::Point<dim, dealii::VectorizedArray<double> >();
+	}
+	static bool zeroUpdate(const std::vector<modelVariable<dim> > &, const std::vector<modelResidual<dim> > &, double){return true;}
+	static void integrateMass(listType &, const unsigned int, std::vector<vectorType*> &, const std::vector<vectorType*> &){}
+	static void setRecoveredSources(listType &, const std::vector<std::vector<vectorType> > &){}
+	static void projectDerivatives(listType &, const unsigned int, std::vector<std::vector<vectorType> > &, const std::vector<vectorType*> &){}
+};
+
+// =====================================================================
+// STRUCTURED GRID KERNELS
+// =====================================================================
+// Per-variable kernels of the structured grid execution of the RHS (see structuredGridRHS and structuredGrid.h).
+// The lanes of a cell batch are consecutive cells along x of the grid, the nodes of lane l are read from and added to
+// the node arrays of the grid at base[l] plus the offsets of the nodes of a cell. The quadrature points are the nodes,
+// so the evaluation and the integration are the 1D derivative matrix (and its transpose) applied along each direction.
+// A variable of the packed group is read from and added to its component of the packed field
+
+// Number of nodes (and quadrature points) of a cell
+template <int dim>
+struct structuredCell{
+	static const unsigned int n_nodes_1d = finiteElementDegree+1;
+	static const unsigned int n_nodes = (dim == 1) ? n_nodes_1d : ((dim == 2) ? n_nodes_1d*n_nodes_1d : n_nodes_1d*n_nodes_1d*n_nodes_1d);
+};
+
+// Derivative along direction d of the nodal values of a cell: out = D in/h
+template <int dim>
+inline void structuredDerivative(const structuredGridLayout<dim> & grid, const dealii::VectorizedArray<double> * in,
+		dealii::VectorizedArray<double> * out, const unsigned int d){
+	const unsigned int n1 = structuredCell<dim>::n_nodes_1d;
+	unsigned int stride = 1;
+	for (unsigned int e=0; e<d; e++){
+		stride *= n1;
+	}
+	for (unsigned int q=0; q<structuredCell<dim>::n_nodes; q++){
+		const unsigned int a = (q/stride)%n1;
+		const unsigned int first = q - a*stride;
+		dealii::VectorizedArray<double> sum = grid.derivative1D[a*n1]*in[first];
+		for (unsigned int k=1; k<n1; k++){
+			sum += grid.derivative1D[a*n1+k]*in[first+k*stride];
+		}
+		out[q] = sum*grid.invCellSize[d];
+	}
+}
+
+// Transpose of structuredDerivative (without the 1/h factor), added to out
+template <int dim>
+inline void structuredDerivativeTranspose(const structuredGridLayout<dim> & grid, const dealii::VectorizedArray<double> * in,
+		dealii::VectorizedArray<double> * out, const unsigned int d){
+	const unsigned int n1 = structuredCell<dim>::n_nodes_1d;
+	unsigned int stride = 1;
+	for (unsigned int e=0; e<d; e++){
+		stride *= n1;
+	}
+	for (unsigned int q=0; q<structuredCell<dim>::n_nodes; q++){
+		const unsigned int a = (q/stride)%n1;
+		const unsigned int first = q - a*stride;
+		for (unsigned int k=0; k<n1; k++){
+			out[q] += grid.derivative1D[k*n1+a]*in[first+k*stride];
+		}
+	}
+}
+
+// Values, derivatives and residuals of variable i at the nodes of a cell batch
+template <int dim, unsigned int i>
+struct structuredData{
+	static const unsigned int n_components = isScalar(i) ? 1 : dim;
+	static const unsigned int n_nodes = structuredCell<dim>::n_nodes;
+	static const unsigned int hess_dim = needHessian[i] ? dim : 1;
+
+	dealii::VectorizedArray<double> value[n_components][n_nodes];
+	dealii::VectorizedArray<double> gradient[n_components][dim][n_nodes];
+	dealii::VectorizedArray<double> hessian[n_components][hess_dim][hess_dim][n_nodes];
+	dealii::VectorizedArray<double> valueResidual[n_components][n_nodes];
+	dealii::VectorizedArray<double> gradientResidual[n_components][dim][n_nodes];
+};
+
+template <int dim, unsigned int i, unsigned int n>
+struct structuredDataList{
+	structuredData<dim,i> data;
+	structuredDataList<dim,i+1,n> next;
+};
+
+template <int dim, unsigned int n>
+struct structuredDataList<dim,n,n>{
+};
+
+template <int dim, unsigned int i, unsigned int n>
+struct structuredKernel{
+	typedef structuredDataList<dim,i,n> listType;
+	typedef structuredData<dim,i> dataType;
+
+	// Read the nodal values of the cell batch (n_lanes lanes, consecutive cells along x if contiguous) and evaluate the
+	// gradients and Hessians
+	static void evaluate(listType & list, const structuredGridLayout<dim> & grid, const unsigned int * base, const bool contiguous){
+		if (isEvaluated(i)){
+			dataType & data = list.data;
+			const unsigned int n_lanes = dealii::VectorizedArray<double>::n_array_elements;
+			for (unsigned int c=0; c<dataType::n_components; c++){
+				const double * values = &grid.nodeValues[fieldIndex(i)][(fieldComponent(i)+c)*grid.nGridNodes];
+				for (unsigned int q=0; q<dataType::n_nodes; q++){
+					const unsigned int offset = grid.cellNodeOffset[q];
+					if (contiguous && (finiteElementDegree == 1)){
+						data.value[c][q].load(values+base[0]+offset);
+					}
+					else {
+						for (unsigned int l=0; l<n_lanes; l++){
+							data.value[c][q][l] = values[base[l]+offset];
+						}
+					}
+				}
+				if (needGradient[i] || needHessian[i]){
+					for (unsigned int d=0; d<dim; d++){
+						structuredDerivative(grid, data.value[c], data.gradient[c][d], d);
+					}
+				}
+				if (needHessian[i]){
+					for (unsigned int d=0; d<dataType::hess_dim; d++){
+						for (unsigned int e=d; e<dataType::hess_dim; e++){
+							structuredDerivative(grid, data.gradient[c][d], data.hessian[c][d][e], e);
+							if (e != d){
+								for (unsigned int q=0; q<dataType::n_nodes; q++){
+									data.hessian[c][e][d][q] = data.hessian[c][d][e][q];
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+		structuredKernel<dim,i+1,n>::evaluate(list.next, grid, base, contiguous);
+	}
+
+	// Fill modelVarList at a quadrature point
+	static void get(listType & list, const unsigned int q, std::vector<modelVariable<dim> > & modelVarList){
+		if (isEvaluated(i)){
+			const dataType & data = list.data;
+			modelVariable<dim> & modelVar = modelVarList[i];
+			for (unsigned int c=0; c<dataType::n_components; c++){
+				if (isScalar(i)){
+					if (needValue[i]){
+						modelVar.scalarValue = data.value[0][q];
+					}
+					if (needGradient[i]){
+						for (unsigned int d=0; d<dim; d++){
+							entry(modelVar.scalarGrad, d) = data.gradient[0][d][q];
+						}
+					}
+					if (needHessian[i]){
+						for (unsigned int d=0; d<dataType::hess_dim; d++){
+							for (unsigned int e=0; e<dataType::hess_dim; e++){
+								entry(modelVar.scalarHess, d, e) = data.hessian[0][d][e][q];
+							}
+						}
+					}
+				}
+				else {
+					if (needValue[i]){
+						entry(modelVar.vectorValue, c) = data.value[c][q];
+					}
+					if (needGradient[i]){
+						for (unsigned int d=0; d<dim; d++){
+							entry(modelVar.vectorGrad, c, d) = data.gradient[c][d][q];
+						}
+					}
+					if (needHessian[i]){
+						for (unsigned int d=0; d<dataType::hess_dim; d++){
+							for (unsigned int e=0; e<dataType::hess_dim; e++){
+								entry(modelVar.vectorHess, c, d, e) = data.hessian[c][d][e][q];
+							}
+						}
+					}
+				}
+			}
+		}
+		structuredKernel<dim,i+1,n>::get(list.next, q, modelVarList);
+	}
+
+	// Store the residuals at a quadrature point
+	static void submit(listType & list, const unsigned int q, const std::vector<modelResidual<dim> > & modelResidualsList){
+		if (isIntegrated(i)){
+			dataType & data = list.data;
+			const modelResidual<dim> & modelRes = modelResidualsList[i];
+			for (unsigned int c=0; c<dataType::n_components; c++){
+				if (valueResidual[i]){
+					data.valueResidual[c][q] = isScalar(i) ? modelRes.scalarValueResidual : entry(modelRes.vectorValueResidual, c);
+				}
+				if (gradientResidual[i]){
+					for (unsigned int d=0; d<dim; d++){
+						data.gradientResidual[c][d][q] = isScalar(i) ? entry(modelRes.scalarGradResidual, d) : entry(modelRes.vectorGradResidual, c, d);
+					}
+				}
+			}
+		}
+		structuredKernel<dim,i+1,n>::submit(list.next, q, modelResidualsList);
+	}
+
+	// Integrate the residuals and add them to the node residuals of the grid, for the lanes in use
+	static void integrate(listType & list, structuredGridLayout<dim> & grid, const unsigned int * base, const bool * laneInUse){
+		if (isIntegrated(i)){
+			dataType & data = list.data;
+			const unsigned int n_lanes = dealii::VectorizedArray<double>::n_array_elements;
+			dealii::VectorizedArray<double> integrated[dataType::n_nodes], weighted[dataType::n_nodes];
+			for (unsigned int c=0; c<dataType::n_components; c++){
+				for (unsigned int q=0; q<dataType::n_nodes; q++){
+					integrated[q] = valueResidual[i] ? data.valueResidual[c][q]*grid.cellNodeJxW[q] : dealii::make_vectorized_array(0.0);
+				}
+				if (gradientResidual[i]){
+					for (unsigned int d=0; d<dim; d++){
+						const double factor = grid.invCellSize[d];
+						for (unsigned int q=0; q<dataType::n_nodes; q++){
+							weighted[q] = data.gradientResidual[c][d][q]*(grid.cellNodeJxW[q]*factor);
+						}
+						structuredDerivativeTranspose(grid, weighted, integrated, d);
+					}
+				}
+				double * residuals = &grid.nodeResiduals[fieldIndex(i)][(fieldComponent(i)+c)*grid.nGridNodes];
+				for (unsigned int l=0; l<n_lanes; l++){
+					if (laneInUse[l]){
+						for (unsigned int q=0; q<dataType::n_nodes; q++){
+							residuals[base[l]+grid.cellNodeOffset[q]] += integrated[q][l];
+						}
+					}
+				}
+			}
+		}
+		structuredKernel<dim,i+1,n>::integrate(list.next, grid, base, laneInUse);
+	}
+};
+
+// End of the recursion
+template <int dim, unsigned int n>
+struct structuredKernel<dim,n,n>{
+	typedef structuredDataList<dim,n,n> listType;
+
+	static void evaluate(listType &, const structuredGridLayout<dim> &, const unsigned int *, const bool){}
+	static void get(listType &, const unsigned int, std::vector<modelVariable<dim> > &){}
+	static void submit(listType &, const unsigned int, const std::vector<modelResidual<dim> > &){}
+	static void integrate(listType &, structuredGridLayout<dim> &, const unsigned int *, const bool *){}
+};
+
+}
@@ -0,0 +1,392 @@
+//grains of the order parameters and their reassignment to other order parameters (grain remapping)
+
+#ifndef GRAINREMAPPING_COUPLED_H
+#define GRAINREMAPPING_COUPLED_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+#include <deal.II/base/conditional_ostream.h>
+
+// A grain is a connected region of the cells where an order parameter is above a threshold at one of the nodes of the
+// cell (which includes the diffuse interface of the grain down to the threshold). Each processor labels the connected
+// regions of its locally owned cells (the fragments, two cells being connected if they share a node), and the fragments
+// of all the processors are merged into grains where they share a node on the boundary between the processors. The
+// grains are represented by their bounding box.
+//
+// Two grains of the same order parameter that come closer than the buffer distance would merge as they grow, so the
+// smaller one is moved to the order parameter with the farthest grains: its values are added to that order parameter and
+// removed from its own, at the nodes of its cells. The order parameters only have to outnumber the grains that are near
+// each other, rather than all the grains.
+
+template <int dim>
+struct grainInfo{
+  /*Order parameter (index in the list of order parameters of the remapping) and volume of the grain.*/
+  unsigned int var;
+  double volume;
+  /*Bounding box of the cells of the grain.*/
+  dealii::Point<dim> lower, upper;
+
+  /*Distance between the bounding boxes of two grains (zero if they overlap).*/
+  double distance(const grainInfo<dim> &other) const {
+    double distanceSqr=0.0;
+    for (unsigned int d=0; d<dim; d++){
+      const double gap=std::max(0.0, std::max(lower[d]-other.upper[d], other.lower[d]-upper[d]));
+      distanceSqr+=gap*gap;
+    }
+    return std::sqrt(distanceSqr);
+  }
+};
+
+template <int dim>
+class grainRemapper
+{
+ public:
+  typedef typename dealii::DoFHandler<dim>::active_cell_iterator cellIterator;
+
+  /*Find the grains of the order parameters. Order parameter v is the component components[v] of the (ghosted) vector
+   *vectors[v] on dofHandlers[v] (several order parameters can be components of the same packed field).*/
+  void findGrains(const std::vector<const dealii::DoFHandler<dim>*> &dofHandlers,
+		  const std::vector<vectorType*> &vectors,
+		  const std::vector<unsigned int> &components,
+		  double threshold);
+
+  /*Move the grains closer than bufferDistance to a grain of the same order parameter to the order parameter with the
+   *farthest grains (from the last findGrains). Returns the number of grains moved. The ghost values of the vectors are
+   *to be updated afterwards.*/
+  unsigned int remap(const std::vector<const dealii::DoFHandler<dim>*> &dofHandlers,
+		     std::vector<vectorType*> &vectors,
+		     const std::vector<unsigned int> &components,
+		     double bufferDistance,
+		     dealii::ConditionalOStream &pcout);
+
+  /*Grains found by the last findGrains (the same on all the processors).*/
+  std::vector<grainInfo<dim> > grains;
+
+ private:
+  /*Connected region of the locally owned cells of an order parameter, and the grain it belongs to.*/
+  struct fragment{
+    grainInfo<dim> info;
+    std::vector<cellIterator> cells;
+    /*Nodes of the fragment shared with cells of other processors, sorted.*/
+    std::vector<dealii::types::global_dof_index> interfaceDofs;
+    unsigned int grain;
+  };
+  std::vector<fragment> localFragments;
+
+  static unsigned int findRoot(std::vector<unsigned int> &parent, unsigned int i){
+    while (parent[i]!=i){
+      parent[i]=parent[parent[i]];
+      i=parent[i];
+    }
+    return i;
+  }
+
+  static void join(std::vector<unsigned int> &parent, unsigned int i, unsigned int j){
+    i=findRoot(parent, i);
+    j=findRoot(parent, j);
+    if (i!=j){
+      parent[std::max(i,j)]=std::min(i,j);
+    }
+  }
+};
+
+template <int dim>
+void grainRemapper<dim>::findGrains(const std::vector<const dealii::DoFHandler<dim>*> &dofHandlers,
+				    const std::vector<vectorType*> &vectors,
+				    const std::vector<unsigned int> &components,
+				    double threshold){
+  localFragments.clear();
+  grains.clear();
+
+  //fragments of each order parameter on this processor
+  for (unsigned int v=0; v<dofHandlers.size(); v++){
+    const dealii::FiniteElement<dim> &fe=dofHandlers[v]->get_fe();
+    const unsigned int nodesPerCell=fe.base_element(0).dofs_per_cell;
+    std::vector<dealii::types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
+
+    //nodes of the cells of other processors
+    std::vector<dealii::types::global_dof_index> ghostDofs;
+    typename dealii::DoFHandler<dim>::active_cell_iterator cell=dofHandlers[v]->begin_active(), endc=dofHandlers[v]->end();
+    for (; cell!=endc; ++cell){
+      if (cell->is_ghost()){
+	cell->get_dof_indices(local_dof_indices);
+	for (unsigned int k=0; k<nodesPerCell; k++){
+	  ghostDofs.push_back(local_dof_indices[fe.component_to_system_index(components[v],k)]);
+	}
+      }
+    }
+    std::sort(ghostDofs.begin(), ghostDofs.end());
+    ghostDofs.erase(std::unique(ghostDofs.begin(), ghostDofs.end()), ghostDofs.end());
+
+    //cells above the threshold, joined with the cells of the same nodes
+    std::vector<cellIterator> cells;
+    std::vector<std::vector<dealii::types::global_dof_index> > cellDofs;
+    std::vector<unsigned int> parent;
+    std::map<dealii::types::global_dof_index, unsigned int> nodeCell;
+    for (cell=dofHandlers[v]->begin_active(); cell!=endc; ++cell){
+      if (!cell->is_locally_owned()) continue;
+      cell->get_dof_indices(local_dof_indices);
+      std::vector<dealii::types::global_dof_index> nodes(nodesPerCell);
+      bool inGrain=false;
+      for (unsigned int k=0; k<nodesPerCell; k++){
+	nodes[k]=local_dof_indices[fe.component_to_system_index(components[v],k)];
+	inGrain=inGrain || ((*vectors[v])(nodes[k])>threshold);
+      }
+      if (!inGrain) continue;
+      const unsigned int c=cells.size();
+      cells.push_back(cell);
+      cellDofs.push_back(nodes);
+      parent.push_back(c);
+      for (unsigned int k=0; k<nodesPerCell; k++){
+	typename std::map<dealii::types::global_dof_index, unsigned int>::iterator it=nodeCell.find(nodes[k]);
+	if (it==nodeCell.end()){
+	  nodeCell[nodes[k]]=c;
+	}
+	else{
+	  join(parent, c, it->second);
+	}
+      }
+    }
+
+    //one fragment per connected region
+    std::map<unsigned int, unsigned int> rootFragment;
+    for (unsigned int c=0; c<cells.size(); c++){
+      const unsigned int root=findRoot(parent, c);
+      if (rootFragment.find(root)==rootFragment.end()){
+	rootFragment[root]=localFragments.size();
+	fragment newFragment;
+	newFragment.info.var=v;
+	newFragment.info.volume=0.0;
+	for (unsigned int d=0; d<dim; d++){
+	  newFragment.info.lower[d]=std::numeric_limits<double>::max();
+	  newFragment.info.upper[d]=-std::numeric_limits<double>::max();
+	}
+	localFragments.push_back(newFragment);
+      }
+      fragment &thisFragment=localFragments[rootFragment[root]];
+      thisFragment.cells.push_back(cells[c]);
+      thisFragment.info.volume+=cells[c]->measure();
+      for (unsigned int i=0; i<dealii::GeometryInfo<dim>::vertices_per_cell; i++){
+	for (unsigned int d=0; d<dim; d++){
+	  thisFragment.info.lower[d]=std::min(thisFragment.info.lower[d], cells[c]->vertex(i)[d]);
+	  thisFragment.info.upper[d]=std::max(thisFragment.info.upper[d], cells[c]->vertex(i)[d]);
+	}
+      }
+      for (unsigned int k=0; k<nodesPerCell; k++){
+	if (std::binary_search(ghostDofs.begin(), ghostDofs.end(), cellDofs[c][k])){
+	  thisFragment.interfaceDofs.push_back(cellDofs[c][k]);
+	}
+      }
+    }
+  }
+  for (unsigned int f=0; f<localFragments.size(); f++){
+    std::vector<dealii::types::global_dof_index> &dofs=localFragments[f].interfaceDofs;
+    std::sort(dofs.begin(), dofs.end());
+    dofs.erase(std::unique(dofs.begin(), dofs.end()), dofs.end());
+  }
+
+  //send the fragments of all the processors to all the processors: order parameter, volume, bounding box, number of
+  //interface nodes and interface nodes of each fragment
+  std::vector<double> localData;
+  for (unsigned int f=0; f<localFragments.size(); f++){
+    const fragment &thisFragment=localFragments[f];
+    localData.push_back(thisFragment.info.var);
+    localData.push_back(thisFragment.info.volume);
+    for (unsigned int d=0; d<dim; d++) localData.push_back(thisFragment.info.lower[d]);
+    for (unsigned int d=0; d<dim; d++) localData.push_back(thisFragment.info.upper[d]);
+    localData.push_back(thisFragment.interfaceDofs.size());
+    for (unsigned int k=0; k<thisFragment.interfaceDofs.size(); k++) localData.push_back(thisFragment.interfaceDofs[k]);
+  }
+  const int numProcs=dealii::Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD);
+  const int thisProc=dealii::Utilities::MPI::this_mpi_process(MPI_COMM_WORLD);
+  int localSize=localData.size();
+  std::vector<int> sizes(numProcs), offsets(numProcs, 0);
+  MPI_Allgather(&localSize, 1, MPI_INT, &sizes[0], 1, MPI_INT, MPI_COMM_WORLD);
+  for (int proc=1; proc<numProcs; proc++){
+    offsets[proc]=offsets[proc-1]+sizes[proc-1];
+  }
+  std::vector<double> globalData(std::max(offsets[numProcs-1]+sizes[numProcs-1], 1));
+  MPI_Allgatherv(localData.empty() ? NULL : &localData[0], localSize, MPI_DOUBLE, &globalData[0], &sizes[0], &offsets[0], MPI_DOUBLE, MPI_COMM_WORLD);
+
+  //join the fragments of the same order parameter that share an interface node (in the same order on all the processors)
+  std::vector<grainInfo<dim> > fragments;
+  std::vector<unsigned int> parent;
+  std::map<std::pair<unsigned int, dealii::types::global_dof_index>, unsigned int> nodeFragment;
+  unsigned int firstLocalFragment=0;
+  for (int proc=0; proc<numProcs; proc++){
+    if (proc==thisProc){
+      firstLocalFragment=fragments.size();
+    }
+    unsigned int pos=offsets[proc];
+    while (pos<(unsigned int)(offsets[proc]+sizes[proc])){
+      grainInfo<dim> info;
+      info.var=(unsigned int)globalData[pos++];
+      info.volume=globalData[pos++];
+      for (unsigned int d=0; d<dim; d++) info.lower[d]=globalData[pos++];
+      for (unsigned int d=0; d<dim; d++) info.upper[d]=globalData[pos++];
+      const unsigned int f=fragments.size();
+      fragments.push_back(info);
+      parent.push_back(f);
+      const unsigned int nInterface=(unsigned int)globalData[pos++];
+      for (unsigned int k=0; k<nInterface; k++){
+	const std::pair<unsigned int, dealii::types::global_dof_index> node(info.var, (dealii::types::global_dof_index)globalData[pos++]);
+	typename std::map<std::pair<unsigned int, dealii::types::global_dof_index>, unsigned int>::iterator it=nodeFragment.find(node);
+	if (it==nodeFragment.end()){
+	  nodeFragment[node]=f;
+	}
+	else{
+	  join(parent, f, it->second);
+	}
+      }
+    }
+  }
+
+  //grains (numbered in the order of their first fragment)
+  std::map<unsigned int, unsigned int> rootGrain;
+  std::vector<unsigned int> fragmentGrain(fragments.size());
+  for (unsigned int f=0; f<fragments.size(); f++){
+    const unsigned int root=findRoot(parent, f);
+    if (rootGrain.find(root)==rootGrain.end()){
+      rootGrain[root]=grains.size();
+      grains.push_back(fragments[f]);
+    }
+    else{
+      grainInfo<dim> &grain=grains[rootGrain[root]];
+      grain.volume+=fragments[f].volume;
+      for (unsigned int d=0; d<dim; d++){
+	grain.lower[d]=std::min(grain.lower[d], fragments[f].lower[d]);
+	grain.upper[d]=std::max(grain.upper[d], fragments[f].upper[d]);
+      }
+    }
+    fragmentGrain[f]=rootGrain[root];
+  }
+  for (unsigned int f=0; f<localFragments.size(); f++){
+    localFragments[f].grain=fragmentGrain[firstLocalFragment+f];
+  }
+}
+
+template <int dim>
+unsigned int grainRemapper<dim>::remap(const std::vector<const dealii::DoFHandler<dim>*> &dofHandlers,
+				       std::vector<vectorType*> &vectors,
+				       const std::vector<unsigned int> &components,
+				       double bufferDistance,
+				       dealii::ConditionalOStream &pcout){
+  const unsigned int nGrains=grains.size();
+  const unsigned int nVars=dofHandlers.size();
+
+  //the smaller grain of each pair of grains of the same order parameter closer than the buffer distance is moved
+  std::vector<bool> tooClose(nGrains, false);
+  for (unsigned int a=0; a<nGrains; a++){
+    for (unsigned int b=a+1; b<nGrains; b++){
+      if ((grains[a].var==grains[b].var) && (grains[a].distance(grains[b])<bufferDistance)){
+	tooClose[(grains[b].volume<=grains[a].volume) ? b : a]=true;
+      }
+    }
+  }
+
+  //new order parameter of each grain, chosen in the order of the grains (the same on all the processors)
+  std::vector<unsigned int> newVar(nGrains);
+  for (unsigned int g=0; g<nGrains; g++){
+    newVar[g]=grains[g].var;
+  }
+  unsigned int nMoved=0, nUnresolved=0;
+  for (unsigned int g=0; g<nGrains; g++){
+    if (!tooClose[g]) continue;
+    //distance to the nearest other grain of each order parameter
+    std::vector<double> nearest(nVars, std::numeric_limits<double>::max());
+    for (unsigned int h=0; h<nGrains; h++){
+      if (h!=g){
+	nearest[newVar[h]]=std::min(nearest[newVar[h]], grains[g].distance(grains[h]));
+      }
+    }
+    unsigned int target=newVar[g];
+    for (unsigned int v=0; v<nVars; v++){
+      if (nearest[v]>nearest[target]){
+	target=v;
+      }
+    }
+    if (nearest[target]<bufferDistance){
+      nUnresolved++;
+    }
+    if (target!=newVar[g]){
+      newVar[g]=target;
+      nMoved++;
+    }
+  }
+
+  //mark the nodes of the cells of the moved grains (owned by this processor) with their new order parameter, in the
+  //ghosted layout of the order parameters. The marks are summed on the processors that own the nodes, which may have no
+  //cell of the grain there. The marks of a node agree, since a node is in a single grain of an order parameter
+  if (nMoved>0){
+    std::vector<vectorType> moveTarget(nVars), moveCount(nVars);
+    for (unsigned int v=0; v<nVars; v++){
+      moveTarget[v].reinit(*vectors[v]);
+      moveCount[v].reinit(*vectors[v]);
+    }
+    for (unsigned int f=0; f<localFragments.size(); f++){
+      const unsigned int g=localFragments[f].grain;
+      const unsigned int from=grains[g].var, to=newVar[g];
+      if (from==to) continue;
+      const dealii::FiniteElement<dim> &feFrom=dofHandlers[from]->get_fe();
+      const unsigned int nodesPerCell=feFrom.base_element(0).dofs_per_cell;
+      std::vector<dealii::types::global_dof_index> dofsFrom(feFrom.dofs_per_cell);
+      for (unsigned int c=0; c<localFragments[f].cells.size(); c++){
+	localFragments[f].cells[c]->get_dof_indices(dofsFrom);
+	for (unsigned int k=0; k<nodesPerCell; k++){
+	  const dealii::types::global_dof_index dofFrom=dofsFrom[feFrom.component_to_system_index(components[from],k)];
+	  moveTarget[from](dofFrom)=to+1.0;
+	  moveCount[from](dofFrom)=1.0;
+	}
+      }
+    }
+    for (unsigned int v=0; v<nVars; v++){
+      moveTarget[v].compress(dealii::VectorOperation::add);
+      moveCount[v].compress(dealii::VectorOperation::add);
+    }
+
+    //move the values at the marked nodes owned by this processor (the DoFs of the order parameters at a node have the
+    //same owner)
+    for (unsigned int from=0; from<nVars; from++){
+      const dealii::FiniteElement<dim> &feFrom=dofHandlers[from]->get_fe();
+      const unsigned int nodesPerCell=feFrom.base_element(0).dofs_per_cell;
+      std::vector<dealii::types::global_dof_index> dofsFrom(feFrom.dofs_per_cell), dofsTo;
+      cellIterator cellFrom=dofHandlers[from]->begin_active(), endc=dofHandlers[from]->end();
+      for (; cellFrom!=endc; ++cellFrom){
+	if (!cellFrom->is_locally_owned()) continue;
+	cellFrom->get_dof_indices(dofsFrom);
+	for (unsigned int k=0; k<nodesPerCell; k++){
+	  const dealii::types::global_dof_index dofFrom=dofsFrom[feFrom.component_to_system_index(components[from],k)];
+	  if (!vectors[from]->in_local_range(dofFrom) || (moveCount[from](dofFrom)==0.0)) continue;
+	  const unsigned int to=(unsigned int)(moveTarget[from](dofFrom)/moveCount[from](dofFrom)+0.5)-1;
+	  const dealii::FiniteElement<dim> &feTo=dofHandlers[to]->get_fe();
+	  const cellIterator cellTo(&cellFrom->get_triangulation(), cellFrom->level(), cellFrom->index(), dofHandlers[to]);
+	  dofsTo.resize(feTo.dofs_per_cell);
+	  cellTo->get_dof_indices(dofsTo);
+	  const dealii::types::global_dof_index dofTo=dofsTo[feTo.component_to_system_index(components[to],k)];
+	  if (vectors[to]->in_local_range(dofTo)){
+	    (*vectors[to])(dofTo)+=(*vectors[from])(dofFrom);
+	    (*vectors[from])(dofFrom)=0.0;
+	  }
+	  //each node is moved once
+	  moveCount[from](dofFrom)=0.0;
+	}
+      }
+    }
+  }
+
+  for (unsigned int g=0; g<nGrains; g++){
+    grains[g].var=newVar[g];
+  }
+
+  char buffer[200];
+  sprintf(buffer, "grain remapping: %u grains on %u order parameters, %u grains moved", nGrains, nVars, nMoved);
+  pcout << buffer;
+  if (nUnresolved>0){
+    sprintf(buffer, " (%u grains with no order parameter free within the buffer distance)", nUnresolved);
+    pcout << buffer;
+  }
+  pcout << "\n";
+  return nMoved;
+}
+
+#endif
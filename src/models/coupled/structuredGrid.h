@@ -0,0 +1,258 @@
+//structured grid layout of the fields on uniform meshes, used by the structured grid execution of the RHS
+
+#ifndef STRUCTUREDGRID_COUPLED_H
+#define STRUCTUREDGRID_COUPLED_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/conditional_ostream.h>
+
+// Without adaptivity, the mesh of subdivided_hyper_rectangle and refine_global is made of identical
+// axis-aligned cells, so the Jacobian is the same constant diagonal matrix on every cell. The cells
+// owned by this processor are laid out on the lexicographic grid of their bounding box, and the
+// values of the fields are copied (gather) into one array per field and component with the nodes of
+// the grid in lexicographic order. A cell kernel then reaches the nodes of a cell by direct indexing
+// (the node of the cell corner plus a fixed offset), with no DoF indices and no mapping data, and
+// adds its residuals to arrays of the same layout, which are added to the residual vectors (scatter).
+//
+// The nodes of the elements are the Gauss-Lobatto points of the quadrature (see init.cc), so the
+// values at the quadrature points are the nodal values and the derivatives are products with the 1D
+// derivative matrix of the Lagrange polynomials at these points (see structuredKernel in
+// generalized_model_layout.h). This is the same operator as FEEvaluation on the cells of the mesh.
+
+template <int dim>
+class structuredGridLayout
+{
+ public:
+  structuredGridLayout(): isInitialized(false){}
+
+  /*Map the DoFs of the fields (all of the same degree) onto the grid of the locally owned cells. Returns false if the
+   *mesh is not uniform.*/
+  bool reinit(const std::vector<const dealii::DoFHandler<dim>*> &dofHandlers,
+	      const std::vector<vectorType*> &vectors,
+	      dealii::ConditionalOStream &pcout);
+
+  /*Copy the (ghosted) field vectors to nodeValues and clear nodeResiduals.*/
+  void gather(const std::vector<vectorType*> &src);
+
+  /*Add nodeResiduals to the residual vectors (including their ghost entries, to be compressed).*/
+  void scatter(std::vector<vectorType*> &dst) const;
+
+  bool initialized() const { return isInitialized; }
+
+  /*Element degree, number of cells and nodes of the grid in each direction, strides of the nodes.*/
+  unsigned int degree, nCells[dim], nNodes[dim], nodeStride[dim], nGridNodes;
+  /*Cell size and location of the first node of the grid.*/
+  double cellSize[dim], invCellSize[dim], origin[dim];
+  /*Whether each cell of the grid (lexicographic order) is locally owned.*/
+  std::vector<unsigned char> cellOwned;
+  /*Offset of each node of a cell (lexicographic order) from the first node of the cell, and its quadrature weight
+   *times the (constant) Jacobian determinant.*/
+  std::vector<unsigned int> cellNodeOffset;
+  std::vector<double> cellNodeJxW;
+  /*1D Gauss-Lobatto points on [0,1] and derivative matrix, derivative(q,k) = l_k'(x_q), stored as q*(degree+1)+k.*/
+  std::vector<double> points1D, derivative1D;
+  /*Values and residuals of each field at the nodes, component c of field f at node n at [f][c*nGridNodes+n].*/
+  std::vector<std::vector<double> > nodeValues, nodeResiduals;
+
+ private:
+  bool isInitialized;
+  /*Local vector index of each node and component of each field (numbers::invalid_unsigned_int for the nodes of the
+   *bounding box outside of the locally owned cells).*/
+  std::vector<std::vector<unsigned int> > nodeLocalIndex;
+};
+
+template <int dim>
+bool structuredGridLayout<dim>::reinit(const std::vector<const dealii::DoFHandler<dim>*> &dofHandlers,
+				       const std::vector<vectorType*> &vectors,
+				       dealii::ConditionalOStream &pcout){
+  isInitialized=false;
+  degree=dofHandlers[0]->get_fe().degree;
+  for (unsigned int f=0; f<dofHandlers.size(); f++){
+    if (dofHandlers[f]->get_fe().degree!=degree){
+      pcout << "\nstructured grid: all the fields need the same degree, the RHS is evaluated with the matrix free cell loop\n";
+      return false;
+    }
+  }
+  const unsigned int n1=degree+1;
+
+  //cell size (from all the processors) and bounding box of the locally owned cells
+  double lower[dim], upper[dim];
+  bool hasCells=false;
+  for (unsigned int d=0; d<dim; d++){
+    cellSize[d]=0.0;
+    lower[d]=std::numeric_limits<double>::max();
+    upper[d]=-std::numeric_limits<double>::max();
+  }
+  typename dealii::DoFHandler<dim>::active_cell_iterator cell=dofHandlers[0]->begin_active(), endc=dofHandlers[0]->end();
+  for (; cell!=endc; ++cell){
+    if (cell->is_locally_owned()){
+      hasCells=true;
+      for (unsigned int d=0; d<dim; d++){
+	cellSize[d]=std::max(cellSize[d], cell->vertex(dealii::GeometryInfo<dim>::vertices_per_cell-1)[d]-cell->vertex(0)[d]);
+	lower[d]=std::min(lower[d], cell->vertex(0)[d]);
+	upper[d]=std::max(upper[d], cell->vertex(dealii::GeometryInfo<dim>::vertices_per_cell-1)[d]);
+      }
+    }
+  }
+  unsigned int nonUniformCells=0;
+  for (unsigned int d=0; d<dim; d++){
+    cellSize[d]=dealii::Utilities::MPI::max(cellSize[d], MPI_COMM_WORLD);
+    invCellSize[d]=1.0/cellSize[d];
+  }
+  for (cell=dofHandlers[0]->begin_active(); cell!=endc; ++cell){
+    if (cell->is_locally_owned()){
+      for (unsigned int d=0; d<dim; d++){
+	if (std::abs(cell->vertex(dealii::GeometryInfo<dim>::vertices_per_cell-1)[d]-cell->vertex(0)[d]-cellSize[d])>1.0e-8*cellSize[d]){
+	  nonUniformCells++;
+	  break;
+	}
+      }
+    }
+  }
+  if (dealii::Utilities::MPI::sum(nonUniformCells, MPI_COMM_WORLD)>0){
+    pcout << "\nstructured grid: the mesh is not uniform, the RHS is evaluated with the matrix free cell loop\n";
+    return false;
+  }
+
+  //grid of the bounding box
+  unsigned int nBoxCells=1;
+  nGridNodes=1;
+  for (unsigned int d=0; d<dim; d++){
+    origin[d]=hasCells ? lower[d] : 0.0;
+    nCells[d]=hasCells ? (unsigned int)((upper[d]-lower[d])/cellSize[d]+0.5) : 0;
+    nNodes[d]=nCells[d]*degree+1;
+    nodeStride[d]=nGridNodes;
+    nBoxCells*=nCells[d];
+    nGridNodes*=nNodes[d];
+  }
+  cellOwned.assign(nBoxCells, 0);
+
+  //1D Gauss-Lobatto points and derivative matrix of the Lagrange polynomials at these points (barycentric form)
+  dealii::QGaussLobatto<1> quadrature1D(n1);
+  points1D.resize(n1);
+  std::vector<double> weights1D(n1), barycentric(n1, 1.0);
+  for (unsigned int k=0; k<n1; k++){
+    points1D[k]=quadrature1D.point(k)[0];
+    weights1D[k]=quadrature1D.weight(k);
+  }
+  for (unsigned int k=0; k<n1; k++){
+    for (unsigned int j=0; j<n1; j++){
+      if (j!=k) barycentric[k]/=(points1D[k]-points1D[j]);
+    }
+  }
+  derivative1D.assign(n1*n1, 0.0);
+  for (unsigned int q=0; q<n1; q++){
+    for (unsigned int k=0; k<n1; k++){
+      if (k!=q){
+	derivative1D[q*n1+k]=barycentric[k]/barycentric[q]/(points1D[q]-points1D[k]);
+	derivative1D[q*n1+q]-=derivative1D[q*n1+k];
+      }
+    }
+  }
+
+  //offsets and JxW values of the nodes of a cell
+  unsigned int nodesPerCell=1;
+  double jacobian=1.0;
+  for (unsigned int d=0; d<dim; d++){
+    nodesPerCell*=n1;
+    jacobian*=cellSize[d];
+  }
+  cellNodeOffset.resize(nodesPerCell);
+  cellNodeJxW.resize(nodesPerCell);
+  for (unsigned int q=0; q<nodesPerCell; q++){
+    cellNodeOffset[q]=0;
+    cellNodeJxW[q]=jacobian;
+    unsigned int remainder=q;
+    for (unsigned int d=0; d<dim; d++){
+      cellNodeOffset[q]+=(remainder%n1)*nodeStride[d];
+      cellNodeJxW[q]*=weights1D[remainder%n1];
+      remainder/=n1;
+    }
+  }
+
+  //map the DoFs of the locally owned cells to the nodes
+  nodeLocalIndex.resize(dofHandlers.size());
+  nodeValues.resize(dofHandlers.size());
+  nodeResiduals.resize(dofHandlers.size());
+  for (unsigned int f=0; f<dofHandlers.size(); f++){
+    const dealii::FiniteElement<dim> &fe=dofHandlers[f]->get_fe();
+    const unsigned int nComponents=fe.n_components();
+    nodeLocalIndex[f].assign(nComponents*nGridNodes, dealii::numbers::invalid_unsigned_int);
+    nodeValues[f].assign(nComponents*nGridNodes, 0.0);
+    nodeResiduals[f].assign(nComponents*nGridNodes, 0.0);
+
+    //node of each DoF of a cell relative to the first node of the cell
+    std::vector<unsigned int> dofOffset(fe.dofs_per_cell, 0);
+    for (unsigned int i=0; i<fe.dofs_per_cell; i++){
+      const dealii::Point<dim> unitPoint=fe.unit_support_point(i);
+      for (unsigned int d=0; d<dim; d++){
+	unsigned int index=0;
+	for (unsigned int k=1; k<n1; k++){
+	  if (std::abs(points1D[k]-unitPoint[d])<std::abs(points1D[index]-unitPoint[d])) index=k;
+	}
+	dofOffset[i]+=index*nodeStride[d];
+      }
+    }
+
+    const dealii::Utilities::MPI::Partitioner &partitioner=*vectors[f]->get_partitioner();
+    std::vector<dealii::types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
+    for (cell=dofHandlers[f]->begin_active(), endc=dofHandlers[f]->end(); cell!=endc; ++cell){
+      if (!cell->is_locally_owned()) continue;
+      unsigned int cellIndex=0, cellStride=1, firstNode=0;
+      for (unsigned int d=0; d<dim; d++){
+	const unsigned int index=(unsigned int)((cell->vertex(0)[d]-origin[d])/cellSize[d]+0.5);
+	cellIndex+=index*cellStride;
+	cellStride*=nCells[d];
+	firstNode+=index*degree*nodeStride[d];
+      }
+      cellOwned[cellIndex]=1;
+      cell->get_dof_indices(local_dof_indices);
+      for (unsigned int i=0; i<fe.dofs_per_cell; i++){
+	const unsigned int component=fe.system_to_component_index(i).first;
+	nodeLocalIndex[f][component*nGridNodes+firstNode+dofOffset[i]]=partitioner.global_to_local(local_dof_indices[i]);
+      }
+    }
+  }
+
+  isInitialized=true;
+  char buffer[200];
+  sprintf(buffer, "structured grid: uniform cells of size %g", cellSize[0]);
+  pcout << buffer;
+  for (unsigned int d=1; d<dim; d++){
+    sprintf(buffer, "x%g", cellSize[d]);
+    pcout << buffer;
+  }
+  pcout << ", the RHS is evaluated on the structured grid of the locally owned cells\n";
+  return true;
+}
+
+template <int dim>
+void structuredGridLayout<dim>::gather(const std::vector<vectorType*> &src){
+  for (unsigned int f=0; f<nodeValues.size(); f++){
+    const std::vector<unsigned int> &localIndex=nodeLocalIndex[f];
+    std::vector<double> &values=nodeValues[f];
+    for (unsigned int n=0; n<localIndex.size(); n++){
+      if (localIndex[n]!=dealii::numbers::invalid_unsigned_int){
+	values[n]=src[f]->local_element(localIndex[n]);
+      }
+    }
+    std::fill(nodeResiduals[f].begin(), nodeResiduals[f].end(), 0.0);
+  }
+}
+
+template <int dim>
+void structuredGridLayout<dim>::scatter(std::vector<vectorType*> &dst) const{
+  for (unsigned int f=0; f<nodeResiduals.size(); f++){
+    const std::vector<unsigned int> &localIndex=nodeLocalIndex[f];
+    const std::vector<double> &residuals=nodeResiduals[f];
+    for (unsigned int n=0; n<localIndex.size(); n++){
+      if (localIndex[n]!=dealii::numbers::invalid_unsigned_int){
+	dst[f]->local_element(localIndex[n])+=residuals[n];
+      }
+    }
+  }
+}
+
+#endif
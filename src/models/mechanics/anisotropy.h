@@ -15,6 +15,7 @@
 
 //3D models:
 //ISOTROPIC - 2 constants [E, nu], where E-modulus and nu-poisson's ratio
+//CUBIC - 3 constants [C11 C12 C44]
 //TRANSVERSE- 5 constants [C11 C33 C44 C12 C13]
 //ORTHOTROPIC- 9 constants [C11 C22 C33 C44 C55 C66 C12 C13 C23]
 //ANISOTROPIC- 21 constants [C11 C22 C33 C44 C55 C66 C12 C13 C14 C15
@@ -22,12 +23,13 @@
 
 //2D models:
 //ISOTROPIC- (Plane Strain) 2 constants [E, nu]
+//CUBIC- (Plane Strain) 3 constants [C11 C12 C44]
 //ANISOTROPIC- 6 constants [C11 C22 C33 C12 C13 C23]
 
 //1D models:
 //ISOTROPIC- 1 constant [E]
 
-enum elasticityModel {ISOTROPIC, TRANSVERSE, ORTHOTROPIC, ANISOTROPIC, ANISOTROPIC2D};
+enum elasticityModel {ISOTROPIC, TRANSVERSE, ORTHOTROPIC, ANISOTROPIC, ANISOTROPIC2D, CUBIC};
 
 template <int dim>
 void getCIJMatrix(elasticityModel model, double constants[], dealii::Table<2, double>& CIJ, dealii::ConditionalOStream& pcout){
@@ -65,6 +67,14 @@ void getCIJMatrix(elasticityModel model, double constants[], dealii::Table<2, do
       CIJ[0][1]=CIJ[1][0]=lambda;
       break;
     }
+    case CUBIC:{
+      pcout << " CUBIC \n";
+      CIJ[0][0]=constants[0]; //C11
+      CIJ[1][1]=constants[0]; //C11
+      CIJ[2][2]=constants[2]; //C44
+      CIJ[0][1]=CIJ[1][0]=constants[1]; //C12
+      break;
+    }
     case ANISOTROPIC:{
       pcout << " ANISOTROPIC \n"; 
       CIJ[0][0]=constants[0]; //C11
@@ -76,7 +86,7 @@ void getCIJMatrix(elasticityModel model, double constants[], dealii::Table<2, do
       break;
     }
     default:{
-      std::cout << "\nelasticityModels: Supported models in 2D - ISOTROPIC/ANISOTROPIC\n"; 
+      std::cout << "\nelasticityModels: Supported models in 2D - ISOTROPIC/CUBIC/ANISOTROPIC\n"; 
       std::cout << "See /src/elasticityModels.h\n";       
       exit(-1);
     }
@@ -102,6 +112,19 @@ void getCIJMatrix(elasticityModel model, double constants[], dealii::Table<2, do
       CIJ[1][2]=CIJ[2][1]=lambda;
       break;
     }
+    case CUBIC:{
+      pcout << " CUBIC \n";
+      CIJ[0][0]=constants[0]; //C11
+      CIJ[1][1]=constants[0]; //C11
+      CIJ[2][2]=constants[0]; //C11
+      CIJ[3][3]=constants[2]; //C44
+      CIJ[4][4]=constants[2]; //C44
+      CIJ[5][5]=constants[2]; //C44
+      CIJ[0][1]=CIJ[1][0]=constants[1]; //C12
+      CIJ[0][2]=CIJ[2][0]=constants[1]; //C12
+      CIJ[1][2]=CIJ[2][1]=constants[1]; //C12
+      break;
+    }
     case TRANSVERSE:{
       pcout << " TRANSVERSE \n"; 
       CIJ[0][0]=constants[0]; //C11
@@ -154,7 +177,7 @@ void getCIJMatrix(elasticityModel model, double constants[], dealii::Table<2, do
       break;
     }
     default:{
-      std::cout << "\nelasticityModels: Supported models in 3D - ISOTROPIC/TRANSVERSE/ORTHOTROPIC/ANISOTROPIC\n"; 
+      std::cout << "\nelasticityModels: Supported models in 3D - ISOTROPIC/CUBIC/TRANSVERSE/ORTHOTROPIC/ANISOTROPIC\n"; 
       std::cout << "See /src/elasticityModels.h\n";       
       exit(-1);
     }
@@ -215,6 +238,14 @@ void getCIJMatrix(elasticityModel model, std::vector<double> constants, dealii::
       CIJ[0][1]=CIJ[1][0]=lambda;
       break;
     }
+    case CUBIC:{
+      pcout << " CUBIC \n";
+      CIJ[0][0]=constants[0]; //C11
+      CIJ[1][1]=constants[0]; //C11
+      CIJ[2][2]=constants[2]; //C44
+      CIJ[0][1]=CIJ[1][0]=constants[1]; //C12
+      break;
+    }
     case ANISOTROPIC:{
       pcout << " ANISOTROPIC \n";
       CIJ[0][0]=constants[0]; //C11
@@ -226,7 +257,7 @@ void getCIJMatrix(elasticityModel model, std::vector<double> constants, dealii::
       break;
     }
     default:{
-      std::cout << "\nelasticityModels: Supported models in 2D - ISOTROPIC/ANISOTROPIC\n";
+      std::cout << "\nelasticityModels: Supported models in 2D - ISOTROPIC/CUBIC/ANISOTROPIC\n";
       std::cout << "See /src/elasticityModels.h\n";
       exit(-1);
     }
@@ -252,6 +283,19 @@ void getCIJMatrix(elasticityModel model, std::vector<double> constants, dealii::
       CIJ[1][2]=CIJ[2][1]=lambda;
       break;
     }
+    case CUBIC:{
+      pcout << " CUBIC \n";
+      CIJ[0][0]=constants[0]; //C11
+      CIJ[1][1]=constants[0]; //C11
+      CIJ[2][2]=constants[0]; //C11
+      CIJ[3][3]=constants[2]; //C44
+      CIJ[4][4]=constants[2]; //C44
+      CIJ[5][5]=constants[2]; //C44
+      CIJ[0][1]=CIJ[1][0]=constants[1]; //C12
+      CIJ[0][2]=CIJ[2][0]=constants[1]; //C12
+      CIJ[1][2]=CIJ[2][1]=constants[1]; //C12
+      break;
+    }
     case TRANSVERSE:{
       pcout << " TRANSVERSE \n";
       CIJ[0][0]=constants[0]; //C11
@@ -304,7 +348,7 @@ void getCIJMatrix(elasticityModel model, std::vector<double> constants, dealii::
       break;
     }
     default:{
-      std::cout << "\nelasticityModels: Supported models in 3D - ISOTROPIC/TRANSVERSE/ORTHOTROPIC/ANISOTROPIC\n";
+      std::cout << "\nelasticityModels: Supported models in 3D - ISOTROPIC/CUBIC/TRANSVERSE/ORTHOTROPIC/ANISOTROPIC\n";
       std::cout << "See /src/elasticityModels.h\n";
       exit(-1);
     }
@@ -57,27 +57,6 @@ if (dim==3){
   R[0][0]=S[0]; R[1][1]=S[1]; R[2][2]=S[2];
   R[1][2]=S[3]; R[0][2]=S[4]; R[0][1]=S[5];
   R[2][1]=S[3]; R[2][0]=S[4]; R[1][0]=S[5];
-
-//    Optimized algorithm that skips the zero entries of CIJ for an orthotropic material and is a few percent faster
-//	  dealii::VectorizedArray<double> S[6], E[6];
-//	  E[0]=strain[0][0]; E[1]=strain[1][1]; E[2]=strain[2][2];
-//	  //In Voigt notation: Engineering shear strain=2*strain
-//	  E[3]=strain[1][2]+strain[2][1];
-//	  E[4]=strain[0][2]+strain[2][0];
-//	  E[5]=strain[0][1]+strain[1][0];
-//	  for (unsigned int i=0; i<3; i++){
-//	    S[i]=0.0;
-//	    for (unsigned int j=0; j<3; j++){
-//	      S[i]+=CIJ(i,j)*E[j];
-//	    }
-//	  }
-//
-//	  for (unsigned int i=3; i<6; i++){
-//		  S[i]=CIJ(i,i)*E[i];
-//	  }
-//	  R[0][0]=S[0]; R[1][1]=S[1]; R[2][2]=S[2];
-//	  R[1][2]=S[3]; R[0][2]=S[4]; R[0][1]=S[5];
-//	  R[2][1]=S[3]; R[2][0]=S[4]; R[1][0]=S[5];
 }
 else if (dim==2){
   dealii::VectorizedArray<double> S[3], E[3];
@@ -268,4 +247,235 @@ else {
 }
 }
 
+// =================================================================================
+// Stiffness specialized on the material symmetry
+// =================================================================================
+// The overloads above multiply the dense Voigt stiffness matrix with the strain vector. For the
+// symmetries of the elasticity models in anisotropy.h most entries of the matrix are zero or
+// repeated, so computeStress<dim,model> below only reads the independent constants:
+//   ISOTROPIC   - lambda (C12) and mu (C44), S = lambda*tr(E)*I + 2*mu*E
+//   CUBIC       - C11, C12 and C44
+//   TRANSVERSE  - C11, C33, C44, C12, C13 and C66=(C11-C12)/2 (3D)
+//   ORTHOTROPIC - the normal block and the diagonal shear entries
+//   ANISOTROPIC - the dense matrix
+// The symmetry is a template parameter, so the kernel has no branches. elasticStiffness<dim> holds
+// the stiffness of one material with its symmetry, and computeStress<dim>(elasticStiffness) selects
+// the kernel once per call. The stiffness of a mixture of two materials (e.g. phase-interpolated with
+// weights 1-h and h) is handled without forming the interpolated matrix: for materials of the same
+// symmetry the kernel interpolates only the constants it reads, otherwise the stresses are blended.
+
+template <int dim>
+class elasticStiffness
+{
+ public:
+	elasticStiffness(): model(ANISOTROPIC){
+		for (unsigned int i=0; i<CIJ_size; i++){
+			for (unsigned int j=0; j<CIJ_size; j++){
+				CIJ[i][j] = 0.0;
+			}
+		}
+	}
+
+	// Stiffness matrix assembled by getCIJMatrix for the elasticity model "_model"
+	elasticStiffness(const elasticityModel _model, const dealii::Tensor<2, 2*dim-1+dim/3, dealii::VectorizedArray<double> > &_CIJ): model(_model){
+		for (unsigned int i=0; i<CIJ_size; i++){
+			for (unsigned int j=0; j<CIJ_size; j++){
+				CIJ[i][j] = _CIJ[i][j][0];
+			}
+		}
+		checkModel();
+	}
+
+	elasticStiffness(const elasticityModel _model, const dealii::Table<2, double> &_CIJ): model(_model){
+		for (unsigned int i=0; i<CIJ_size; i++){
+			for (unsigned int j=0; j<CIJ_size; j++){
+				CIJ[i][j] = _CIJ(i,j);
+			}
+		}
+		checkModel();
+	}
+
+	typedef double value_type;
+	double operator()(const unsigned int i, const unsigned int j) const {return CIJ[i][j];}
+
+	static const unsigned int CIJ_size = 2*dim-1+dim/3;
+	elasticityModel model;
+	double CIJ[2*dim-1+dim/3][2*dim-1+dim/3];
+
+ private:
+	// The 1D and 2D matrices have no structure beyond the isotropic and cubic cases
+	void checkModel(){
+		if ((dim == 1) || ((dim == 2) && (model != ISOTROPIC) && (model != CUBIC))){
+			model = ANISOTROPIC;
+		}
+	}
+};
+
+// Weighted sum w0*C0 + w1*C1 of two stiffnesses, evaluated entry by entry when the kernel reads it
+template <int dim>
+class weightedStiffness
+{
+ public:
+	weightedStiffness(const elasticStiffness<dim> &_C0, const dealii::VectorizedArray<double> &_w0,
+			const elasticStiffness<dim> &_C1, const dealii::VectorizedArray<double> &_w1): C0(_C0), C1(_C1), w0(_w0), w1(_w1){}
+
+	typedef dealii::VectorizedArray<double> value_type;
+	dealii::VectorizedArray<double> operator()(const unsigned int i, const unsigned int j) const {return w0*C0.CIJ[i][j] + w1*C1.CIJ[i][j];}
+
+ private:
+	const elasticStiffness<dim> &C0, &C1;
+	const dealii::VectorizedArray<double> w0, w1;
+};
+
+// Kernel for the stiffness "C" (elasticStiffness or weightedStiffness) of symmetry "model". The strain
+// and stress can be any types with [i][j] access to VectorizedArray entries (arrays or tensors)
+template <int dim, elasticityModel model, typename stiffnessType, typename strainType, typename stressType>
+inline void computeStressSymmetric(const stiffnessType &C, const strainType &strain, stressType &R){
+	typedef typename stiffnessType::value_type valueType;
+	const unsigned int n = 2*dim-1+dim/3;
+
+	// Voigt strain vector, with the engineering shear strains (sized for 3D, so that the branches
+	// for the other dimensions stay in bounds)
+	dealii::VectorizedArray<double> E[6], S[6];
+	if (dim == 3){
+		E[0]=strain[0][0]; E[1]=strain[1][1]; E[2]=strain[2][2];
+		E[3]=strain[1][2]+strain[2][1];
+		E[4]=strain[0][2]+strain[2][0];
+		E[5]=strain[0][1]+strain[1][0];
+	}
+	else if (dim == 2){
+		E[0]=strain[0][0]; E[1]=strain[1][1];
+		E[n-1]=strain[0][1]+strain[1][0];
+	}
+	else {
+		E[0]=strain[0][0];
+	}
+
+	if ((model == ISOTROPIC) || (model == CUBIC)){
+		const valueType C12 = C(0,1), C44 = C(n-1,n-1);
+		// (C11-C12) equals 2*mu for the isotropic material
+		const valueType C11_C12 = (model == ISOTROPIC) ? valueType(2.0*C44) : valueType(C(0,0)-C12);
+		dealii::VectorizedArray<double> trace = E[0];
+		for (unsigned int i=1; i<dim; i++){
+			trace += E[i];
+		}
+		for (unsigned int i=0; i<dim; i++){
+			S[i] = C11_C12*E[i] + C12*trace;
+		}
+		for (unsigned int i=dim; i<n; i++){
+			S[i] = C44*E[i];
+		}
+	}
+	else if ((model == TRANSVERSE) && (dim == 3)){
+		const valueType C11 = C(0,0), C33 = C(2,2), C44 = C(3,3), C12 = C(0,1), C13 = C(0,2), C66 = C(5,5);
+		const dealii::VectorizedArray<double> C13_E2 = C13*E[2];
+		S[0] = C11*E[0] + C12*E[1] + C13_E2;
+		S[1] = C12*E[0] + C11*E[1] + C13_E2;
+		S[2] = C13*(E[0]+E[1]) + C33*E[2];
+		S[3] = C44*E[3];
+		S[4] = C44*E[4];
+		S[5] = C66*E[5];
+	}
+	else if ((model == ORTHOTROPIC) && (dim == 3)){
+		for (unsigned int i=0; i<3; i++){
+			S[i] = C(i,0)*E[0] + C(i,1)*E[1] + C(i,2)*E[2];
+		}
+		for (unsigned int i=3; i<6; i++){
+			S[i] = C(i,i)*E[i];
+		}
+	}
+	else {
+		for (unsigned int i=0; i<n; i++){
+			S[i] = C(i,0)*E[0];
+			for (unsigned int j=1; j<n; j++){
+				S[i] += C(i,j)*E[j];
+			}
+		}
+	}
+
+	if (dim == 3){
+		R[0][0]=S[0]; R[1][1]=S[1]; R[2][2]=S[2];
+		R[1][2]=S[3]; R[0][2]=S[4]; R[0][1]=S[5];
+		R[2][1]=S[3]; R[2][0]=S[4]; R[1][0]=S[5];
+	}
+	else if (dim == 2){
+		R[0][0]=S[0]; R[1][1]=S[1];
+		R[0][1]=S[2]; R[1][0]=S[2];
+	}
+	else {
+		R[0][0]=S[0];
+	}
+}
+
+// Select the kernel for the symmetry of the stiffness
+template <int dim, typename stiffnessType, typename strainType, typename stressType>
+inline void computeStressForModel(const elasticityModel model, const stiffnessType &C, const strainType &strain, stressType &R){
+	// In 1D the stiffness is a single constant
+	switch ((dim == 1) ? ANISOTROPIC : model){
+	case ISOTROPIC:
+		computeStressSymmetric<dim,ISOTROPIC>(C, strain, R);
+		break;
+	case CUBIC:
+		computeStressSymmetric<dim,CUBIC>(C, strain, R);
+		break;
+	case TRANSVERSE:
+		computeStressSymmetric<dim,TRANSVERSE>(C, strain, R);
+		break;
+	case ORTHOTROPIC:
+		computeStressSymmetric<dim,ORTHOTROPIC>(C, strain, R);
+		break;
+	default:
+		computeStressSymmetric<dim,ANISOTROPIC>(C, strain, R);
+	}
+}
+
+// Overloaded function where the stiffness is an elasticStiffness and the strain and stress are vectorized arrays
+template <int dim>
+void computeStress(const elasticStiffness<dim> &C, const dealii::VectorizedArray<double> strain[][dim], dealii::VectorizedArray<double> R[][dim]){
+	computeStressForModel<dim>(C.model, C, strain, R);
+}
+
+// Overloaded function where the stiffness is an elasticStiffness and the strain and stress are tensors
+template <int dim>
+void computeStress(const elasticStiffness<dim> &C, const dealii::Tensor<2, dim, dealii::VectorizedArray<double> > &strain, dealii::Tensor<2, dim, dealii::VectorizedArray<double> > &R){
+	computeStressForModel<dim>(C.model, C, strain, R);
+}
+
+// Stress for the stiffness w0*C0 + w1*C1 (e.g. w0=1-h, w1=h for a phase-interpolated stiffness, or
+// w0=-1, w1=1 for the difference of the stiffnesses), strain and stress as vectorized arrays
+template <int dim>
+void computeStress(const elasticStiffness<dim> &C0, const dealii::VectorizedArray<double> &w0,
+		const elasticStiffness<dim> &C1, const dealii::VectorizedArray<double> &w1,
+		const dealii::VectorizedArray<double> strain[][dim], dealii::VectorizedArray<double> R[][dim]){
+	if (C0.model == C1.model){
+		computeStressForModel<dim>(C0.model, weightedStiffness<dim>(C0, w0, C1, w1), strain, R);
+	}
+	else {
+		dealii::VectorizedArray<double> R1[dim][dim];
+		computeStressForModel<dim>(C0.model, C0, strain, R);
+		computeStressForModel<dim>(C1.model, C1, strain, R1);
+		for (unsigned int i=0; i<dim; i++){
+			for (unsigned int j=0; j<dim; j++){
+				R[i][j] = w0*R[i][j] + w1*R1[i][j];
+			}
+		}
+	}
+}
+
+// Stress for the stiffness w0*C0 + w1*C1, strain and stress as tensors
+template <int dim>
+void computeStress(const elasticStiffness<dim> &C0, const dealii::VectorizedArray<double> &w0,
+		const elasticStiffness<dim> &C1, const dealii::VectorizedArray<double> &w1,
+		const dealii::Tensor<2, dim, dealii::VectorizedArray<double> > &strain, dealii::Tensor<2, dim, dealii::VectorizedArray<double> > &R){
+	if (C0.model == C1.model){
+		computeStressForModel<dim>(C0.model, weightedStiffness<dim>(C0, w0, C1, w1), strain, R);
+	}
+	else {
+		dealii::Tensor<2, dim, dealii::VectorizedArray<double> > R1;
+		computeStressForModel<dim>(C0.model, C0, strain, R);
+		computeStressForModel<dim>(C1.model, C1, strain, R1);
+		R = w0*R + w1*R1;
+	}
+}
+
 #endif
@@ -0,0 +1,696 @@
+//FFT-based (Khachaturyan) Green's function solver for homogeneous linear elasticity
+//on uniform periodic meshes
+
+#ifndef SPECTRALELASTICITY_MECHANICS_H
+#define SPECTRALELASTICITY_MECHANICS_H
+//this source file is temporarily treated as a header file (hence
+//#ifndef's) till library packaging scheme is finalized
+
+#include <complex>
+#include <limits>
+#include <algorithm>
+#include <deal.II/base/table.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/conditional_ostream.h>
+
+// For a homogeneous stiffness C, the displacement u due to a periodic body force f
+// satisfies in Fourier space
+//
+//   K(xi) u(xi) = f(xi),   with the acoustic tensor  K_ik(xi) = C_ijkl xi_j xi_l
+//
+// which is the Khachaturyan solution of the microelasticity problem. The eigenstrain
+// source enters through f = div(C:epsilon0), which is exactly what residualRHS assembles
+// for the mechanics field, so the force is taken from the FE residual vector and lumped
+// to the nodes with the (diagonal) Gauss-Lobatto mass matrix.
+//
+// The nodes of the mesh are mapped onto a structured periodic grid, so the mesh must be
+// uniform (no adaptivity) and the nodes evenly spaced (finiteElementDegree 1 or 2). Nodes
+// on opposite faces of the domain are identified with each other. The wave vectors are
+// replaced by their central-difference modified counterparts 2*sin(xi*h/2)/h, which
+// better match the discrete operator for the high frequencies.
+//
+// The operator applied by vmult(dst,src) is symmetric and positive definite, so it can be
+// used both for a fixed-point (preconditioned Richardson) iteration and as a
+// preconditioner for CG. Dirichlet rows are passed through unchanged.
+//
+// The grid is distributed in slabs of planes normal to the last axis. The residual of each
+// DoF is sent to the rank of its plane, the slab is transformed along the other axes, and
+// then transposed into lines along the last axis (each rank holding the lines through a
+// part of the plane), which are transformed and multiplied with the Green's tensor. The
+// inverse transform goes back the same way.
+
+//FFT of one length, by mixed-radix decimation in time over the prime factors of the length.
+//The roots of unity and the work buffers are computed once
+class mixedRadixFFT
+{
+ public:
+  void reinit(unsigned int _n);
+
+  /*Forward transform (unnormalized, exponent sign -1) in place.*/
+  void forward(std::complex<double> *data);
+
+ private:
+  void transform(const std::complex<double> *in, unsigned int inStride, std::complex<double> *out,
+		 unsigned int factorIndex, unsigned int length, unsigned int rootStep);
+
+  unsigned int n;
+  std::vector<unsigned int> factors;
+  std::vector<std::complex<double> > roots, work, butterfly;
+};
+
+inline void mixedRadixFFT::reinit(unsigned int _n){
+  n=_n;
+  factors.clear();
+  unsigned int remainder=n;
+  for (unsigned int f=2; f*f<=remainder; f++){
+    while (remainder%f==0){
+      factors.push_back(f);
+      remainder/=f;
+    }
+  }
+  if (remainder>1){
+    factors.push_back(remainder);
+  }
+  roots.resize(n);
+  for (unsigned int k=0; k<n; k++){
+    roots[k]=std::polar(1.0, -2.0*dealii::numbers::PI*k/n);
+  }
+  work.resize(n);
+  butterfly.resize(factors.empty() ? 1 : *std::max_element(factors.begin(), factors.end()));
+}
+
+inline void mixedRadixFFT::forward(std::complex<double> *data){
+  if (n<=1) return;
+  std::copy(data, data+n, work.begin());
+  transform(&work[0], 1, data, 0, n, 1);
+}
+
+//transform of the sequence in[j*inStride], j<length, into out (the roots of this length are roots[k*rootStep])
+inline void mixedRadixFFT::transform(const std::complex<double> *in, unsigned int inStride, std::complex<double> *out,
+				     unsigned int factorIndex, unsigned int length, unsigned int rootStep){
+  if (length==1){
+    out[0]=in[0];
+    return;
+  }
+
+  //transform the p decimated subsequences of length m
+  const unsigned int p=factors[factorIndex];
+  const unsigned int m=length/p;
+  for (unsigned int r=0; r<p; r++){
+    transform(in+r*inStride, inStride*p, out+r*m, factorIndex+1, m, rootStep*p);
+  }
+
+  //combine them
+  for (unsigned int k=0; k<m; k++){
+    for (unsigned int r=0; r<p; r++){
+      butterfly[r]=out[r*m+k]*roots[r*k*rootStep];
+    }
+    if (p==2){
+      out[k]=butterfly[0]+butterfly[1];
+      out[m+k]=butterfly[0]-butterfly[1];
+      continue;
+    }
+    for (unsigned int q=0; q<p; q++){
+      std::complex<double> sum(0.0, 0.0);
+      for (unsigned int r=0; r<p; r++){
+	sum+=butterfly[r]*roots[((r*q)%p)*m*rootStep];
+      }
+      out[q*m+k]=sum;
+    }
+  }
+}
+
+//FFT of one length. Lengths with a large prime factor are transformed with Bluestein's algorithm,
+//as a convolution computed with power of two transforms, instead of the O(n*p) direct butterflies
+class fftPlan
+{
+ public:
+  void reinit(unsigned int _n);
+
+  /*Unnormalized transform in place (exponent sign +1 for the inverse transform).*/
+  void transform(std::complex<double> *data, bool inverse);
+
+ private:
+  static const unsigned int maxDirectFactor=32;
+  unsigned int n;
+  bool bluestein;
+  mixedRadixFFT direct, convolution;
+  /*Chirp exp(-i*pi*k^2/n), transform of its conjugate (scaled by the inverse length of the convolution), and the convolution buffer.*/
+  std::vector<std::complex<double> > chirp, chirpTransform, padded;
+};
+
+inline void fftPlan::reinit(unsigned int _n){
+  n=_n;
+  unsigned int largestFactor=1, remainder=n;
+  for (unsigned int f=2; f*f<=remainder; f++){
+    while (remainder%f==0){
+      largestFactor=f;
+      remainder/=f;
+    }
+  }
+  largestFactor=std::max(largestFactor, remainder);
+  bluestein=(largestFactor>maxDirectFactor);
+  if (!bluestein){
+    direct.reinit(n);
+    return;
+  }
+
+  unsigned int m=1;
+  while (m<2*n-1){
+    m*=2;
+  }
+  convolution.reinit(m);
+  chirp.resize(n);
+  for (unsigned int k=0; k<n; k++){
+    chirp[k]=std::polar(1.0, -dealii::numbers::PI*(double)(((unsigned long long)k*k)%(2*n))/n);
+  }
+  chirpTransform.assign(m, std::complex<double>(0.0, 0.0));
+  chirpTransform[0]=std::conj(chirp[0]);
+  for (unsigned int k=1; k<n; k++){
+    chirpTransform[k]=chirpTransform[m-k]=std::conj(chirp[k]);
+  }
+  convolution.forward(&chirpTransform[0]);
+  for (unsigned int k=0; k<m; k++){
+    chirpTransform[k]/=m;
+  }
+  padded.resize(m);
+}
+
+//the inverse transform is the conjugate of the forward transform of the conjugate
+inline void fftPlan::transform(std::complex<double> *data, bool inverse){
+  if (inverse){
+    for (unsigned int k=0; k<n; k++) data[k]=std::conj(data[k]);
+  }
+  if (!bluestein){
+    direct.forward(data);
+  }
+  else{
+    std::fill(padded.begin(), padded.end(), std::complex<double>(0.0, 0.0));
+    for (unsigned int k=0; k<n; k++){
+      padded[k]=data[k]*chirp[k];
+    }
+    convolution.forward(&padded[0]);
+    for (unsigned int k=0; k<padded.size(); k++){
+      padded[k]=std::conj(padded[k]*chirpTransform[k]);
+    }
+    convolution.forward(&padded[0]);
+    for (unsigned int k=0; k<n; k++){
+      data[k]=chirp[k]*std::conj(padded[k]);
+    }
+  }
+  if (inverse){
+    for (unsigned int k=0; k<n; k++) data[k]=std::conj(data[k]);
+  }
+}
+
+template <int dim>
+class spectralElasticitySolver
+{
+ public:
+  spectralElasticitySolver(): isInitialized(false){}
+
+  /*Map the DoFs of the displacement field onto the structured grid and store the reference stiffness (Voigt notation).*/
+  void reinit(const dealii::DoFHandler<dim> &dof_handler,
+	      const dealii::Table<2, double> &_CIJ,
+	      const std::map<dealii::types::global_dof_index, double> &valuesDirichlet,
+	      dealii::ConditionalOStream &pcout);
+
+  /*Apply the lumped Green's operator to the residual vector src.*/
+  void vmult(dealii::parallel::distributed::Vector<double> &dst, const dealii::parallel::distributed::Vector<double> &src) const;
+
+  bool initialized() const { return isInitialized; }
+
+ private:
+  void transformSlab(bool inverse) const;
+  void transformLines(bool inverse) const;
+  void transpose(bool slabToLines) const;
+  void applyGreenOperator() const;
+  unsigned int voigtIndex(unsigned int i, unsigned int j) const;
+
+  bool isInitialized;
+  unsigned int nPoints[dim], nGrid;
+  double spacing[dim];
+  dealii::Table<2, double> CIJ;
+  /*Slab decomposition: rank r owns the planes slabStart[r]<=z<slabStart[r+1] normal to the last axis, and the lines along
+    the last axis through the points lineStart[r]<=p<lineStart[r+1] of a plane (planeSize points).*/
+  unsigned int rank, nProcs, planeSize, slabSize, nLines;
+  std::vector<unsigned int> slabStart, lineStart;
+  /*Local vector index of each locally owned DoF (ordered by the rank of their grid plane) and whether it is a Dirichlet DoF.*/
+  std::vector<unsigned int> dofLocalIndex;
+  std::vector<bool> dofIsDirichlet;
+  /*Position in the slab buffer (component and grid node) of each DoF received from the other ranks.*/
+  std::vector<unsigned int> receivedSlabIndex;
+  std::vector<int> dofSendCounts, dofSendOffsets, dofReceiveCounts, dofReceiveOffsets;
+  /*Counts and offsets (in doubles) of the transpose from the slabs to the lines.*/
+  std::vector<int> slabSendCounts, slabSendOffsets, lineReceiveCounts, lineReceiveOffsets;
+  /*Inverse square root of the lumped mass of each node of the slab (symmetric scaling of the operator).*/
+  std::vector<double> invSqrtMass;
+  /*Green's tensor (inverse acoustic tensor, normalized for the inverse transform) of each point of the local lines.*/
+  std::vector<dealii::Tensor<2, dim, double> > greenTensor;
+  /*Local indices of the Dirichlet DoFs.*/
+  std::vector<unsigned int> dirichletLocalIndex;
+  /*FFT of each axis and the buffers of the slabs, the lines and the exchanges, reused by all the calls.*/
+  mutable std::vector<fftPlan> plans;
+  mutable std::vector<std::complex<double> > slab, lines, lineBuffer, transposeSendBuffer, transposeReceiveBuffer;
+  mutable std::vector<double> dofSendBuffer, dofReceiveBuffer;
+};
+
+//split n items among the ranks (start of each rank, with start[nProcs]=n)
+inline std::vector<unsigned int> spectralPartition(unsigned int n, unsigned int nProcs){
+  std::vector<unsigned int> start(nProcs+1);
+  for (unsigned int r=0; r<=nProcs; r++){
+    start[r]=(unsigned int)(((unsigned long long)n*r)/nProcs);
+  }
+  return start;
+}
+
+template <int dim>
+unsigned int spectralElasticitySolver<dim>::voigtIndex(unsigned int i, unsigned int j) const{
+  if (i==j){
+    return i;
+  }
+  if (dim==2){
+    return 2;
+  }
+  //3D: (1,2)->3, (0,2)->4, (0,1)->5
+  return 6-i-j;
+}
+
+
+template <int dim>
+void spectralElasticitySolver<dim>::reinit(const dealii::DoFHandler<dim> &dof_handler,
+					   const dealii::Table<2, double> &_CIJ,
+					   const std::map<dealii::types::global_dof_index, double> &valuesDirichlet,
+					   dealii::ConditionalOStream &pcout){
+  CIJ=_CIJ;
+  const dealii::FiniteElement<dim> &fe=dof_handler.get_fe();
+  const unsigned int degree=fe.degree;
+  if ((degree<1) || (degree>2) || (fe.n_components()!=dim)){
+    pcout << "\nspectralElasticity: the spectral elasticity backend requires a VECTOR field with finiteElementDegree 1 or 2\n";
+    exit(-1);
+  }
+  const unsigned int lastVertex=dealii::GeometryInfo<dim>::vertices_per_cell-1;
+
+  //cell size and bounding box of the domain
+  double cellSize[dim], minCoordinate[dim], maxCoordinate[dim];
+  for (unsigned int d=0; d<dim; d++){
+    cellSize[d]=0.0;
+    minCoordinate[d]=std::numeric_limits<double>::max();
+    maxCoordinate[d]=-std::numeric_limits<double>::max();
+  }
+  typename dealii::DoFHandler<dim>::active_cell_iterator cell=dof_handler.begin_active(), endc=dof_handler.end();
+  for (; cell!=endc; ++cell){
+    if (cell->is_locally_owned()){
+      for (unsigned int d=0; d<dim; d++){
+	cellSize[d]=std::max(cellSize[d], cell->vertex(lastVertex)[d]-cell->vertex(0)[d]);
+	minCoordinate[d]=std::min(minCoordinate[d], cell->vertex(0)[d]);
+	maxCoordinate[d]=std::max(maxCoordinate[d], cell->vertex(lastVertex)[d]);
+      }
+    }
+  }
+  nGrid=1;
+  for (unsigned int d=0; d<dim; d++){
+    cellSize[d]=dealii::Utilities::MPI::max(cellSize[d], MPI_COMM_WORLD);
+    minCoordinate[d]=dealii::Utilities::MPI::min(minCoordinate[d], MPI_COMM_WORLD);
+    maxCoordinate[d]=dealii::Utilities::MPI::max(maxCoordinate[d], MPI_COMM_WORLD);
+    spacing[d]=cellSize[d]/degree;
+    nPoints[d]=(unsigned int)((maxCoordinate[d]-minCoordinate[d])/spacing[d]+0.5);
+    nGrid*=nPoints[d];
+  }
+
+  //check that the mesh is uniform
+  unsigned int uniform=1;
+  for (cell=dof_handler.begin_active(); cell!=endc; ++cell){
+    if (!cell->is_locally_owned()) continue;
+    for (unsigned int d=0; d<dim; d++){
+      if (std::abs(cell->vertex(lastVertex)[d]-cell->vertex(0)[d]-cellSize[d])>1.0e-8*cellSize[d]){
+	uniform=0;
+      }
+    }
+  }
+  if (dealii::Utilities::MPI::min(uniform, MPI_COMM_WORLD)==0){
+    pcout << "\nspectralElasticity: the spectral elasticity backend requires a uniform mesh\n";
+    exit(-1);
+  }
+
+  //slab decomposition
+  rank=dealii::Utilities::MPI::this_mpi_process(MPI_COMM_WORLD);
+  nProcs=dealii::Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD);
+  const unsigned int nz=nPoints[dim-1];
+  planeSize=nGrid/nz;
+  slabStart=spectralPartition(nz, nProcs);
+  lineStart=spectralPartition(planeSize, nProcs);
+  const unsigned int nPlanes=slabStart[rank+1]-slabStart[rank];
+  slabSize=nPlanes*planeSize;
+  nLines=lineStart[rank+1]-lineStart[rank];
+
+  //map the locally owned DoFs to the grid nodes, grouped by the rank of their plane
+  const dealii::IndexSet &locally_owned_dofs=dof_handler.locally_owned_dofs();
+  std::vector<bool> dofMapped(locally_owned_dofs.n_elements(), false);
+  std::vector<dealii::types::global_dof_index> local_dof_indices(fe.dofs_per_cell);
+  std::vector<std::vector<unsigned int> > rankDofs(nProcs), rankSlabIndex(nProcs);
+  for (cell=dof_handler.begin_active(); cell!=endc; ++cell){
+    if (!cell->is_locally_owned()) continue;
+    cell->get_dof_indices(local_dof_indices);
+    for (unsigned int i=0; i<fe.dofs_per_cell; i++){
+      if (!locally_owned_dofs.is_element(local_dof_indices[i])) continue;
+      const unsigned int localIndex=locally_owned_dofs.index_within_set(local_dof_indices[i]);
+      if (dofMapped[localIndex]) continue;
+      dofMapped[localIndex]=true;
+      const dealii::Point<dim> unitPoint=fe.unit_support_point(i);
+      unsigned int pointIndex=0, stride=1, z=0;
+      for (unsigned int d=0; d<dim; d++){
+	double x=cell->vertex(0)[d]+unitPoint[d]*cellSize[d]-minCoordinate[d];
+	unsigned int index=((unsigned int)(x/spacing[d]+0.5))%nPoints[d];
+	if (d<dim-1){
+	  pointIndex+=index*stride;
+	  stride*=nPoints[d];
+	}
+	else{
+	  z=index;
+	}
+      }
+      const unsigned int destination=std::upper_bound(slabStart.begin(), slabStart.end(), z)-slabStart.begin()-1;
+      const unsigned int destinationSlabSize=(slabStart[destination+1]-slabStart[destination])*planeSize;
+      rankDofs[destination].push_back(localIndex);
+      rankSlabIndex[destination].push_back(fe.system_to_component_index(i).first*destinationSlabSize
+					   +(z-slabStart[destination])*planeSize+pointIndex);
+    }
+  }
+  dofLocalIndex.clear();
+  std::vector<unsigned int> sendSlabIndex;
+  dofSendCounts.assign(nProcs, 0);
+  dofSendOffsets.assign(nProcs, 0);
+  for (unsigned int r=0; r<nProcs; r++){
+    dofSendOffsets[r]=dofLocalIndex.size();
+    dofSendCounts[r]=rankDofs[r].size();
+    dofLocalIndex.insert(dofLocalIndex.end(), rankDofs[r].begin(), rankDofs[r].end());
+    sendSlabIndex.insert(sendSlabIndex.end(), rankSlabIndex[r].begin(), rankSlabIndex[r].end());
+  }
+  dofReceiveCounts.assign(nProcs, 0);
+  dofReceiveOffsets.assign(nProcs, 0);
+  MPI_Alltoall(dofSendCounts.data(), 1, MPI_INT, dofReceiveCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+  for (unsigned int r=1; r<nProcs; r++){
+    dofReceiveOffsets[r]=dofReceiveOffsets[r-1]+dofReceiveCounts[r-1];
+  }
+  receivedSlabIndex.resize(dofReceiveOffsets[nProcs-1]+dofReceiveCounts[nProcs-1]);
+  MPI_Alltoallv(sendSlabIndex.data(), dofSendCounts.data(), dofSendOffsets.data(), MPI_UNSIGNED,
+		receivedSlabIndex.data(), dofReceiveCounts.data(), dofReceiveOffsets.data(), MPI_UNSIGNED, MPI_COMM_WORLD);
+  dofSendBuffer.resize(dofLocalIndex.size());
+  dofReceiveBuffer.resize(receivedSlabIndex.size());
+
+  //counts of the transposes (in doubles, two per complex value)
+  slabSendCounts.assign(nProcs, 0);
+  slabSendOffsets.assign(nProcs, 0);
+  lineReceiveCounts.assign(nProcs, 0);
+  lineReceiveOffsets.assign(nProcs, 0);
+  for (unsigned int r=0; r<nProcs; r++){
+    slabSendCounts[r]=2*dim*nPlanes*(lineStart[r+1]-lineStart[r]);
+    lineReceiveCounts[r]=2*dim*(slabStart[r+1]-slabStart[r])*nLines;
+    if (r>0){
+      slabSendOffsets[r]=slabSendOffsets[r-1]+slabSendCounts[r-1];
+      lineReceiveOffsets[r]=lineReceiveOffsets[r-1]+lineReceiveCounts[r-1];
+    }
+  }
+
+  //lumped mass of the slab nodes: product of the Gauss-Lobatto weights along each axis (the nodes at the
+  //vertices are shared by two cells, also across the periodic boundaries)
+  dealii::QGaussLobatto<1> quadrature1D(degree+1);
+  std::vector<std::pair<double, double> > nodeWeights;
+  for (unsigned int k=0; k<quadrature1D.size(); k++){
+    nodeWeights.push_back(std::make_pair(quadrature1D.point(k)[0], quadrature1D.weight(k)));
+  }
+  std::sort(nodeWeights.begin(), nodeWeights.end());
+  std::vector<double> mass1D[dim];
+  for (unsigned int d=0; d<dim; d++){
+    mass1D[d].resize(nPoints[d]);
+    for (unsigned int i=0; i<nPoints[d]; i++){
+      const unsigned int node=i%degree;
+      mass1D[d][i]=cellSize[d]*((node==0) ? nodeWeights[0].second+nodeWeights[degree].second : nodeWeights[node].second);
+    }
+  }
+  invSqrtMass.resize(slabSize);
+  for (unsigned int n=0; n<slabSize; n++){
+    unsigned int remainder=n%planeSize;
+    double mass=mass1D[dim-1][slabStart[rank]+n/planeSize];
+    for (unsigned int d=0; d<dim-1; d++){
+      mass*=mass1D[d][remainder%nPoints[d]];
+      remainder/=nPoints[d];
+    }
+    invSqrtMass[n]=1.0/std::sqrt(mass);
+  }
+
+  //Green's tensor of the points of the local lines. The acoustic tensor for the zero wave vector is the sum
+  //of the tensors for the longest waves along each axis, which keeps the operator definite for the rigid
+  //body translation mode. The wave vectors are the modified ones of the central differences.
+  dealii::Tensor<2, dim, double> K0;
+  for (unsigned int a=0; a<dim; a++){
+    double xi[dim];
+    for (unsigned int d=0; d<dim; d++){
+      xi[d]=(d==a) ? 2.0*std::sin(dealii::numbers::PI/nPoints[d])/spacing[d] : 0.0;
+    }
+    for (unsigned int i=0; i<dim; i++){
+      for (unsigned int k=0; k<dim; k++){
+	for (unsigned int j=0; j<dim; j++){
+	  for (unsigned int l=0; l<dim; l++){
+	    K0[i][k]+=CIJ(voigtIndex(i,j),voigtIndex(k,l))*xi[j]*xi[l];
+	  }
+	}
+      }
+    }
+  }
+  greenTensor.resize(nLines*nz);
+  for (unsigned int line=0; line<nLines; line++){
+    for (unsigned int z=0; z<nz; z++){
+      double xi[dim];
+      unsigned int remainder=lineStart[rank]+line;
+      bool zeroMode=true;
+      for (unsigned int d=0; d<dim; d++){
+	int index;
+	if (d<dim-1){
+	  index=remainder%nPoints[d];
+	  remainder/=nPoints[d];
+	}
+	else{
+	  index=z;
+	}
+	if (index!=0) zeroMode=false;
+	//signed wave number
+	if (2*index>(int)nPoints[d]) index-=nPoints[d];
+	xi[d]=2.0*std::sin(dealii::numbers::PI*index/nPoints[d])/spacing[d];
+      }
+      dealii::Tensor<2, dim, double> K;
+      if (zeroMode){
+	K=K0;
+      }
+      else{
+	for (unsigned int i=0; i<dim; i++){
+	  for (unsigned int k=0; k<dim; k++){
+	    for (unsigned int j=0; j<dim; j++){
+	      for (unsigned int l=0; l<dim; l++){
+		K[i][k]+=CIJ(voigtIndex(i,j),voigtIndex(k,l))*xi[j]*xi[l];
+	      }
+	    }
+	  }
+	}
+      }
+      //the normalization of the inverse transform is applied here
+      greenTensor[line*nz+z]=dealii::invert(K)/(double)nGrid;
+    }
+  }
+
+  //Dirichlet DoFs
+  dirichletLocalIndex.clear();
+  for (std::map<dealii::types::global_dof_index, double>::const_iterator it=valuesDirichlet.begin(); it!=valuesDirichlet.end(); ++it){
+    if (locally_owned_dofs.is_element(it->first)){
+      dirichletLocalIndex.push_back(locally_owned_dofs.index_within_set(it->first));
+    }
+  }
+  std::sort(dirichletLocalIndex.begin(), dirichletLocalIndex.end());
+  dofIsDirichlet.resize(dofLocalIndex.size());
+  for (unsigned int i=0; i<dofLocalIndex.size(); i++){
+    dofIsDirichlet[i]=std::binary_search(dirichletLocalIndex.begin(), dirichletLocalIndex.end(), dofLocalIndex[i]);
+  }
+
+  //FFT plans and buffers
+  plans.resize(dim);
+  unsigned int maxPoints=0;
+  for (unsigned int d=0; d<dim; d++){
+    plans[d].reinit(nPoints[d]);
+    maxPoints=std::max(maxPoints, nPoints[d]);
+  }
+  slab.resize(dim*slabSize);
+  lines.resize(dim*nLines*nz);
+  lineBuffer.resize(maxPoints);
+  transposeSendBuffer.resize(std::max(slab.size(), lines.size()));
+  transposeReceiveBuffer.resize(std::max(slab.size(), lines.size()));
+  isInitialized=true;
+
+  pcout << "spectral elasticity grid: " << nPoints[0];
+  for (unsigned int d=1; d<dim; d++){
+    pcout << "x" << nPoints[d];
+  }
+  pcout << " nodes, in slabs of planes normal to axis " << dim-1 << "\n";
+}
+
+template <int dim>
+void spectralElasticitySolver<dim>::vmult(dealii::parallel::distributed::Vector<double> &dst, const dealii::parallel::distributed::Vector<double> &src) const{
+  //send the residual of the DoFs to the ranks of their grid planes (Dirichlet rows do not contribute)
+  for (unsigned int i=0; i<dofLocalIndex.size(); i++){
+    dofSendBuffer[i]=dofIsDirichlet[i] ? 0.0 : src.local_element(dofLocalIndex[i]);
+  }
+  MPI_Alltoallv(dofSendBuffer.data(), const_cast<int*>(dofSendCounts.data()), const_cast<int*>(dofSendOffsets.data()), MPI_DOUBLE,
+		dofReceiveBuffer.data(), const_cast<int*>(dofReceiveCounts.data()), const_cast<int*>(dofReceiveOffsets.data()), MPI_DOUBLE, MPI_COMM_WORLD);
+
+  //sum them on the slab (contributions of periodic images are summed) and scale with the lumped mass
+  std::fill(slab.begin(), slab.end(), std::complex<double>(0.0, 0.0));
+  for (unsigned int k=0; k<receivedSlabIndex.size(); k++){
+    slab[receivedSlabIndex[k]]+=dofReceiveBuffer[k];
+  }
+  for (unsigned int c=0; c<dim; c++){
+    for (unsigned int n=0; n<slabSize; n++){
+      slab[c*slabSize+n]*=invSqrtMass[n];
+    }
+  }
+
+  transformSlab(false);
+  transpose(true);
+  transformLines(false);
+  applyGreenOperator();
+  transformLines(true);
+  transpose(false);
+  transformSlab(true);
+
+  //send the displacement back to the DoFs
+  for (unsigned int k=0; k<receivedSlabIndex.size(); k++){
+    dofReceiveBuffer[k]=slab[receivedSlabIndex[k]].real()*invSqrtMass[receivedSlabIndex[k]%slabSize];
+  }
+  MPI_Alltoallv(dofReceiveBuffer.data(), const_cast<int*>(dofReceiveCounts.data()), const_cast<int*>(dofReceiveOffsets.data()), MPI_DOUBLE,
+		dofSendBuffer.data(), const_cast<int*>(dofSendCounts.data()), const_cast<int*>(dofSendOffsets.data()), MPI_DOUBLE, MPI_COMM_WORLD);
+  for (unsigned int i=0; i<dofLocalIndex.size(); i++){
+    dst.local_element(dofLocalIndex[i])=dofSendBuffer[i];
+  }
+  for (unsigned int i=0; i<dirichletLocalIndex.size(); i++){
+    dst.local_element(dirichletLocalIndex[i])=src.local_element(dirichletLocalIndex[i]);
+  }
+}
+
+//transform the planes of the slab along all the axes but the last one
+template <int dim>
+void spectralElasticitySolver<dim>::transformSlab(bool inverse) const{
+  const unsigned int nPlanes=slabStart[rank+1]-slabStart[rank];
+  for (unsigned int c=0; c<dim; c++){
+    for (unsigned int plane=0; plane<nPlanes; plane++){
+      const unsigned int base=c*slabSize+plane*planeSize;
+      unsigned int stride=1;
+      for (unsigned int d=0; d<dim-1; d++){
+	const unsigned int n=nPoints[d];
+	for (unsigned int outer=0; outer<planeSize; outer+=n*stride){
+	  for (unsigned int inner=0; inner<stride; inner++){
+	    std::complex<double> *line=&slab[base+outer+inner];
+	    if (stride==1){
+	      plans[d].transform(line, inverse);
+	      continue;
+	    }
+	    for (unsigned int i=0; i<n; i++){
+	      lineBuffer[i]=line[i*stride];
+	    }
+	    plans[d].transform(&lineBuffer[0], inverse);
+	    for (unsigned int i=0; i<n; i++){
+	      line[i*stride]=lineBuffer[i];
+	    }
+	  }
+	}
+	stride*=n;
+      }
+    }
+  }
+}
+
+//transform the local lines along the last axis
+template <int dim>
+void spectralElasticitySolver<dim>::transformLines(bool inverse) const{
+  const unsigned int nz=nPoints[dim-1];
+  for (unsigned int line=0; line<dim*nLines; line++){
+    plans[dim-1].transform(&lines[line*nz], inverse);
+  }
+}
+
+//redistribute the grid between the slab layout (component, plane, point of the plane) and the line
+//layout (component, line, point of the line)
+template <int dim>
+void spectralElasticitySolver<dim>::transpose(bool slabToLines) const{
+  const unsigned int nz=nPoints[dim-1];
+  const unsigned int nPlanes=slabStart[rank+1]-slabStart[rank];
+  unsigned int k=0;
+  if (slabToLines){
+    for (unsigned int r=0; r<nProcs; r++){
+      for (unsigned int c=0; c<dim; c++){
+	for (unsigned int plane=0; plane<nPlanes; plane++){
+	  for (unsigned int p=lineStart[r]; p<lineStart[r+1]; p++){
+	    transposeSendBuffer[k++]=slab[c*slabSize+plane*planeSize+p];
+	  }
+	}
+      }
+    }
+    MPI_Alltoallv(transposeSendBuffer.data(), const_cast<int*>(slabSendCounts.data()), const_cast<int*>(slabSendOffsets.data()), MPI_DOUBLE,
+		  transposeReceiveBuffer.data(), const_cast<int*>(lineReceiveCounts.data()), const_cast<int*>(lineReceiveOffsets.data()), MPI_DOUBLE, MPI_COMM_WORLD);
+    k=0;
+    for (unsigned int r=0; r<nProcs; r++){
+      for (unsigned int c=0; c<dim; c++){
+	for (unsigned int z=slabStart[r]; z<slabStart[r+1]; z++){
+	  for (unsigned int line=0; line<nLines; line++){
+	    lines[(c*nLines+line)*nz+z]=transposeReceiveBuffer[k++];
+	  }
+	}
+      }
+    }
+  }
+  else{
+    for (unsigned int r=0; r<nProcs; r++){
+      for (unsigned int c=0; c<dim; c++){
+	for (unsigned int z=slabStart[r]; z<slabStart[r+1]; z++){
+	  for (unsigned int line=0; line<nLines; line++){
+	    transposeSendBuffer[k++]=lines[(c*nLines+line)*nz+z];
+	  }
+	}
+      }
+    }
+    MPI_Alltoallv(transposeSendBuffer.data(), const_cast<int*>(lineReceiveCounts.data()), const_cast<int*>(lineReceiveOffsets.data()), MPI_DOUBLE,
+		  transposeReceiveBuffer.data(), const_cast<int*>(slabSendCounts.data()), const_cast<int*>(slabSendOffsets.data()), MPI_DOUBLE, MPI_COMM_WORLD);
+    k=0;
+    for (unsigned int r=0; r<nProcs; r++){
+      for (unsigned int c=0; c<dim; c++){
+	for (unsigned int plane=0; plane<nPlanes; plane++){
+	  for (unsigned int p=lineStart[r]; p<lineStart[r+1]; p++){
+	    slab[c*slabSize+plane*planeSize+p]=transposeReceiveBuffer[k++];
+	  }
+	}
+      }
+    }
+  }
+}
+
+//multiply the transformed force with the Green's tensor
+template <int dim>
+void spectralElasticitySolver<dim>::applyGreenOperator() const{
+  const unsigned int nz=nPoints[dim-1];
+  std::complex<double> f[dim];
+  for (unsigned int line=0; line<nLines; line++){
+    for (unsigned int z=0; z<nz; z++){
+      const dealii::Tensor<2, dim, double> &G=greenTensor[line*nz+z];
+      for (unsigned int i=0; i<dim; i++){
+	f[i]=lines[(i*nLines+line)*nz+z];
+      }
+      for (unsigned int i=0; i<dim; i++){
+	std::complex<double> u(0.0, 0.0);
+	for (unsigned int k=0; k<dim; k++){
+	  u+=G[i][k]*f[k];
+	}
+	lines[(i*nLines+line)*nz+z]=u;
+      }
+    }
+  }
+}
+
+#endif
@@ -8,6 +8,7 @@
 #define need_hess  {false}
 #define need_val_residual {true}
 #define need_grad_residual {true}
+#define need_q_point_loc false
 
 
 //define Fickian diffusion parameters
@@ -42,7 +43,7 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 }
 
 template <int dim>
-void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value, dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value, dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc, std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 
 }
@@ -9,6 +9,7 @@
 #define need_hess {false}
 #define need_val_residual {false}
 #define need_grad_residual {true}
+#define need_q_point_loc true
 
 #define need_val_LHS {false}
 #define need_grad_LHS {true}
@@ -115,7 +116,7 @@ modelRes.vectorGradResidual = Rux;
 }
 
 template <int dim>
-void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value, dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList, const dealii::VectorizedArray<double> & JxW_value, dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc, std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 
 	//u
 	vectorgradType ux = modelVarList[0].vectorGrad;
@@ -161,14 +162,12 @@ void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>
 	  }
 	}
 
-	assembler_lock.acquire ();
+	// Add the weighted energy densities to their components, only at the points where f_el > 1.0e-10
 	for (unsigned i=0; i<f_el.n_array_elements;i++){
-	  // For some reason, some of the values in this loop
 	  if (f_el[i] > 1.0e-10){
-		  this->energy+=f_el[i]*JxW_value[i];
+		  energyComponents[2][i] += f_el[i]*JxW_value[i];
 	  }
 	}
-	assembler_lock.release ();
 
 
 }
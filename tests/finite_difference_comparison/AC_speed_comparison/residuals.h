@@ -8,6 +8,7 @@
 #define need_hess  {false}
 #define need_val_residual {true}
 #define need_grad_residual {true}
+#define need_q_point_loc false
 
 //define Allen-Cahn parameters
 #define MnV 1.0
@@ -48,7 +49,8 @@ void generalizedProblem<dim>::residualLHS(const std::vector<modelVariable<dim>>
 template <int dim>
 void generalizedProblem<dim>::energyDensity(const std::vector<modelVariable<dim>> & modelVarList,
 											const dealii::VectorizedArray<double> & JxW_value,
-											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc) {
+											dealii::Point<dim, dealii::VectorizedArray<double> > q_point_loc,
+											std::vector<dealii::VectorizedArray<double> > & energyComponents) const {
 	scalarvalueType total_energy_density = constV(0.0);
 
 //n
@@ -68,16 +70,13 @@ for (int i=0; i<dim; i++){
 
 total_energy_density = f_chem + f_grad;
 
-assembler_lock.acquire ();
+// Add the weighted energy densities to their components, only at the points where n > 1.0e-10
 for (unsigned i=0; i<n.n_array_elements;i++){
-  // For some reason, some of the values in this loop
   if (n[i] > 1.0e-10){
-	  this->energy+=total_energy_density[i]*JxW_value[i];
-	  this->energy_components[0]+= f_chem[i]*JxW_value[i];
-	  this->energy_components[1]+= f_grad[i]*JxW_value[i];
+	  energyComponents[0][i] += f_chem[i]*JxW_value[i];
+	  energyComponents[1][i] += f_grad[i]*JxW_value[i];
   }
 }
-assembler_lock.release ();
 }
 
 
@@ -59,7 +59,9 @@
 #define calcEnergy false
 // =================================================================================
 
-
-
-
-
+// =================================================================================
+// Set the flag determining if the RHS is evaluated on the structured grid of the
+// uniform mesh (see structuredGridRHS in defaultValues.h)
+// =================================================================================
+#define structuredGridRHS true
+// =================================================================================
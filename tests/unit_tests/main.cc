@@ -56,7 +56,56 @@ int main(int argc, char **argv)
   unitTest<3,dealii::Table<2, double>> computeStress_tester_3DT;
   pass = computeStress_tester_3DT.test_computeStress();
   tests_passed += pass;
+
+  // Unit tests for the versions of "computeStress" specialized on the material symmetry
+  total_tests++;
+  unitTest<1,double> computeStressSymmetric_tester_1D;
+  pass = computeStressSymmetric_tester_1D.test_computeStressSymmetric();
+  tests_passed += pass;
+
+  total_tests++;
+  unitTest<2,double> computeStressSymmetric_tester_2D;
+  pass = computeStressSymmetric_tester_2D.test_computeStressSymmetric();
+  tests_passed += pass;
+
+  total_tests++;
+  unitTest<3,double> computeStressSymmetric_tester_3D;
+  pass = computeStressSymmetric_tester_3D.test_computeStressSymmetric();
+  tests_passed += pass;
   
+  // Unit tests for the vectorized math functions
+  total_tests++;
+  unitTest<2,double> vectorizedMath_tester;
+  pass = vectorizedMath_tester.test_vectorizedMath();
+  tests_passed += pass;
+
+  // Timing of the vectorized math functions against the lane by lane std:: functions (not counted as a test)
+  vectorizedMath_tester.benchmark_vectorizedMath();
+
+  // Unit tests for the dual numbers
+  total_tests++;
+  unitTest<2,double> dualNumbers_tester;
+  pass = dualNumbers_tester.test_dualNumbers();
+  tests_passed += pass;
+
+  // Unit tests for the random noise
+  total_tests++;
+  unitTest<2,double> randomNoise_tester;
+  pass = randomNoise_tester.test_randomNoise();
+  tests_passed += pass;
+
+  // Unit tests for the selection of the active components of a sparse packed group
+  total_tests++;
+  unitTest<2,double> activeSelection_tester;
+  pass = activeSelection_tester.test_activeSelection();
+  tests_passed += pass;
+
+  // Unit tests for the recovered Hessians (lumped mass matrix of fields of several degrees)
+  total_tests++;
+  unitTest<2,double> recoveredHessian_tester;
+  pass = recoveredHessian_tester.test_recoveredHessian();
+  tests_passed += pass;
+
   // Unit tests for the method "getRHS"
   //unitTest<2,double> getRHS_tester_2D;
   //pass = getRHS_tester_2D.test_getRHS();
@@ -0,0 +1,121 @@
+// Unit test(s) for the selection of the components of a sparse packed group in "activeSelection.h"
+
+template <int dim, typename T>
+bool unitTest<dim,T>::test_activeSelection(){
+
+	std::cout << "\nTesting the selection of the active components..." << std::endl;
+
+	// Ten order parameters with four slots, on the four nodes of the cells of a batch (Q1 in 2D)
+	const unsigned int n_group = 10, n_slots = 4, n_nodes = 4;
+	const double tol = 1.0e-4;
+	typedef dealii::Tensor<1,n_group,dealii::VectorizedArray<double> > nodeValues;
+	const unsigned int n_lanes = dealii::VectorizedArray<double>::n_array_elements;
+	int pass_counter = 0, total_checks = 0;
+
+	// Nodal values of a cell batch with the given value of each component on the first lane, and a small value elsewhere
+	auto batch = [&](const double values[n_group], nodeValues nodes[n_nodes]){
+		for (unsigned int k=0; k<n_nodes; k++){
+			for (unsigned int c=0; c<n_group; c++){
+				for (unsigned int v=0; v<n_lanes; v++){
+					nodes[k][c][v] = ((k == 0) && (v == 0)) ? values[c] : 1.0e-6;
+				}
+			}
+		}
+	};
+	auto select = [&](const nodeValues nodes[n_nodes], unsigned int index[n_group]){
+		double maxValue[n_group];
+		for (unsigned int c=0; c<n_group; c++){
+			maxValue[c] = 0.0;
+		}
+		for (unsigned int k=0; k<n_nodes; k++){
+			activeSelection::addMaxAbs<n_group>(nodes[k], maxValue);
+		}
+		return activeSelection::select<n_group>(maxValue, n_slots, tol, index);
+	};
+	auto isSelected = [&](unsigned int c, const unsigned int index[n_group], unsigned int n_active){
+		for (unsigned int s=0; s<n_active; s++){
+			if (index[s] == c) {return true;}
+		}
+		return false;
+	};
+
+	nodeValues nodes[n_nodes];
+	unsigned int index[n_group];
+
+	// Three grains in the batch: the slots hold the three grains, in the order of the components
+	const double three_grains[n_group] = {0.0, 0.9, 0.0, 0.0, 0.4, 0.0, -0.2, 0.0, 0.0, 0.0};
+	batch(three_grains, nodes);
+	unsigned int n_active = select(nodes, index);
+	bool three_pass = (n_active == n_slots) && isSelected(1, index, n_active) && isSelected(4, index, n_active) && isSelected(6, index, n_active)
+			&& (index[0] < index[1]) && (index[1] < index[2]) && (index[2] < index[3]);
+	std::cout << "  three grains in " << n_active << " slots: " << three_pass << std::endl;
+	total_checks++;
+	if (three_pass) {pass_counter++;}
+
+	// More grains meet in the batch than there are slots (the smallest one still O(1)): the batch is evaluated densely
+	const double six_grains[n_group] = {0.5, 0.0, 0.3, 0.0, 0.6, 0.2, 0.0, 0.4, 0.0, 0.25};
+	batch(six_grains, nodes);
+	n_active = select(nodes, index);
+	bool dense_pass = (n_active == n_group);
+	for (unsigned int s=0; s<n_active; s++){
+		dense_pass = dense_pass && (index[s] == s);
+	}
+	std::cout << "  six grains in " << n_active << " slots (dense): " << dense_pass << std::endl;
+	total_checks++;
+	if (dense_pass) {pass_counter++;}
+
+	// Five grains, one of them just above the tolerance on a single lane of a single node: still evaluated densely
+	const double five_grains[n_group] = {0.5, 0.0, 0.3, 0.0, 0.6, 0.0, 0.0, 0.4, 0.0, 0.0};
+	batch(five_grains, nodes);
+	nodes[n_nodes-1][8][n_lanes-1] = -2.0*tol;
+	n_active = select(nodes, index);
+	std::cout << "  five grains (one of them at one node only) in " << n_active << " slots: " << (n_active == n_group) << std::endl;
+	total_checks++;
+	if (n_active == n_group) {pass_counter++;}
+
+	// Two neighboring batches sharing a node where grain 7 is 0.3: grain 7 is selected in both, whatever the other grains
+	const double left[n_group] = {0.8, 0.0, 0.6, 0.0, 0.0, 0.0, 0.0, 0.3, 0.0, 0.0};
+	const double right[n_group] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.3, 0.0, 0.9};
+	unsigned int index_right[n_group];
+	batch(left, nodes);
+	n_active = select(nodes, index);
+	batch(right, nodes);
+	const unsigned int n_active_right = select(nodes, index_right);
+	const bool shared_pass = isSelected(7, index, n_active) && isSelected(7, index_right, n_active_right);
+	std::cout << "  grain at a shared node selected in both batches: " << shared_pass << std::endl;
+	total_checks++;
+	if (shared_pass) {pass_counter++;}
+
+	// No component above the tolerance is dropped, in batches of random grains
+	unsigned int n_dropped = 0, n_dense = 0;
+	srand(5);
+	for (unsigned int b=0; b<200; b++){
+		double values[n_group];
+		for (unsigned int c=0; c<n_group; c++){
+			values[c] = ((double)rand()/RAND_MAX < 0.4) ? (double)rand()/RAND_MAX : 0.0;
+		}
+		batch(values, nodes);
+		n_active = select(nodes, index);
+		n_dense += (n_active == n_group);
+		for (unsigned int c=0; c<n_group; c++){
+			if ((std::abs(values[c]) > tol) && !isSelected(c, index, n_active)) {n_dropped++;}
+		}
+	}
+	std::cout << "  components above the tolerance dropped in 200 random batches: " << n_dropped << " (" << n_dense << " dense batches)" << std::endl;
+	total_checks++;
+	if (n_dropped == 0) {pass_counter++;}
+
+	// A nan is never dropped
+	const double with_nan[n_group] = {0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	batch(with_nan, nodes);
+	nodes[1][3][0] = std::numeric_limits<double>::quiet_NaN();
+	n_active = select(nodes, index);
+	std::cout << "  nan selected: " << isSelected(3, index, n_active) << std::endl;
+	total_checks++;
+	if (isSelected(3, index, n_active)) {pass_counter++;}
+
+	bool pass = (pass_counter == total_checks);
+	std::cout << "Test result for the selection of the active components: " << pass << std::endl;
+
+	return pass;
+}
@@ -124,3 +124,103 @@ bool unitTest<dim,T>::test_computeStress(){
 
 
 
+
+// Unit test(s) for the versions of "computeStress" specialized on the material symmetry (elasticStiffness),
+// against the product with the full stiffness matrix
+template <int dim, typename T>
+bool unitTest<dim,T>::test_computeStressSymmetric(){
+
+	std::cout << "Testing 'computeStress' for the material symmetries in " << dim << " dimension(s)..." << std::endl;
+
+	const unsigned int CIJ_size = 2*dim-1+dim/3;
+	dealii::ConditionalOStream pcout(std::cout, false);
+	int pass_counter = 0, total_checks = 0;
+
+	// Material models and constants for each dimension (two materials per model, for the interpolation)
+	std::vector<elasticityModel> models;
+	std::vector<std::vector<double> > constants;
+	if (dim == 1){
+		models = {ISOTROPIC, ISOTROPIC};
+		constants = {{2.5}, {4.0}};
+	}
+	else if (dim == 2){
+		models = {ISOTROPIC, ISOTROPIC, CUBIC, CUBIC, ANISOTROPIC, ANISOTROPIC};
+		constants = {{2.0, 0.3}, {3.0, 0.25}, {6.8, 2.5, 4.0}, {5.1, 1.2, 3.3},
+				{6.8, 10.1, 8.8, 2.5, 4.0, 3.7}, {1.2, 9.3, 2.7, 0.5, 1.1, 0.8}};
+	}
+	else {
+		models = {ISOTROPIC, ISOTROPIC, CUBIC, CUBIC, TRANSVERSE, TRANSVERSE, ORTHOTROPIC, ORTHOTROPIC, ANISOTROPIC, ANISOTROPIC};
+		constants = {{2.0, 0.3}, {3.0, 0.25}, {6.8, 2.5, 4.0}, {5.1, 1.2, 3.3},
+				{1.1, 7.7, 6.6, 3.3, 11.6}, {2.2, 5.1, 1.3, 0.7, 1.9},
+				{1.1, 7.7, 6.6, 3.3, 11.6, 19.5, 9.5, 2.1, 5.6}, {2.1, 3.2, 5.6, 1.2, 0.4, 2.5, 1.0, 0.3, 0.7},
+				{1.1, 7.7, 6.6, 3.3, 11.6, 19.5, 9.5, 2.1, 1.5, 9.2, 18.6, 5.6, 4.7, 6.4, 5.9, 15.5, 63.1, 50.0, 92.5, 1.3, 23.2},
+				{2.1, 3.2, 5.6, 1.2, 0.4, 2.5, 1.0, 0.3, 0.2, 0.9, 1.6, 0.6, 0.7, 0.4, 0.9, 1.5, 3.1, 5.0, 2.5, 0.3, 2.2}};
+	}
+
+	std::vector<dealii::Table<2, double> > CIJ(models.size());
+	std::vector<elasticStiffness<dim> > stiffness;
+	for (unsigned int m=0; m<models.size(); m++){
+		CIJ[m].reinit(CIJ_size, CIJ_size);
+		getCIJMatrix<dim>(models[m], &constants[m][0], CIJ[m], pcout);
+		stiffness.push_back(elasticStiffness<dim>(models[m], CIJ[m]));
+	}
+
+	// Non-symmetric displacement gradient, different in each lane
+	dealii::VectorizedArray<double> ux[dim][dim], R[dim][dim], R_ref[dim][dim];
+	for (unsigned int i=0; i<dim; i++){
+		for (unsigned int j=0; j<dim; j++){
+			for (unsigned int v=0; v<dealii::VectorizedArray<double>::n_array_elements; v++){
+				ux[i][j][v] = 1.0 + i + 2.0*j + 0.1*v;
+			}
+		}
+	}
+
+	// Interpolation weights, different in each lane
+	dealii::VectorizedArray<double> w0, w1;
+	for (unsigned int v=0; v<dealii::VectorizedArray<double>::n_array_elements; v++){
+		w1[v] = 0.2 + 0.15*v;
+		w0[v] = 1.0 - w1[v];
+	}
+
+	// Maximum difference of the stresses over the lanes
+	auto stressError = [&]() -> double {
+		double error = 0.0;
+		for (unsigned int i=0; i<dim; i++){
+			for (unsigned int j=0; j<dim; j++){
+				for (unsigned int v=0; v<dealii::VectorizedArray<double>::n_array_elements; v++){
+					error = std::max(error, std::abs(R[i][j][v] - R_ref[i][j][v])/(1.0 + std::abs(R_ref[i][j][v])));
+				}
+			}
+		}
+		return error;
+	};
+
+	for (unsigned int m=0; m<models.size(); m++){
+		// Single material
+		computeStress<dim>(CIJ[m], ux, R_ref);
+		computeStress<dim>(stiffness[m], ux, R);
+		total_checks++;
+		if (stressError() < 1.0e-12) {pass_counter++;}
+
+		// Mixture with the other material of the same model and with the first material (the last one is
+		// of a different model), against the stress for the interpolated matrix
+		for (unsigned int k=0; k<2; k++){
+			const unsigned int m1 = (k == 0) ? (m^1) : 0;
+			dealii::VectorizedArray<double> CIJ_combined[2*dim-1+dim/3][2*dim-1+dim/3];
+			for (unsigned int i=0; i<CIJ_size; i++){
+				for (unsigned int j=0; j<CIJ_size; j++){
+					CIJ_combined[i][j] = w0*CIJ[m](i,j) + w1*CIJ[m1](i,j);
+				}
+			}
+			computeStress<dim>(CIJ_combined, ux, R_ref);
+			computeStress<dim>(stiffness[m], w0, stiffness[m1], w1, ux, R);
+			total_checks++;
+			if (stressError() < 1.0e-12) {pass_counter++;}
+		}
+	}
+
+	bool pass = (pass_counter == total_checks);
+	std::cout << "Test result for 'computeStress' for the material symmetries in " << dim << " dimension(s): " << pass << std::endl;
+
+	return pass;
+}
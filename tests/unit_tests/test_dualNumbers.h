@@ -0,0 +1,93 @@
+// Unit test(s) for the dual numbers in "dualNumbers.h"
+
+// Test function of two variables with all the operations and functions of the dual numbers
+template <typename T>
+T dualNumbersTestFunction(const T &x, const T &y){
+	return exp(x*y) + log(x)/y - 2.0*sqrt(x)*pow(y, 2.5) + pow(x-y, 3) + 1.5/(x+y) - x/3.0;
+}
+
+inline double dualNumbersTestFunction(const double x, const double y){
+	return std::exp(x*y) + std::log(x)/y - 2.0*std::sqrt(x)*std::pow(y, 2.5) + std::pow(x-y, 3) + 1.5/(x+y) - x/3.0;
+}
+
+template <int dim, typename T>
+bool unitTest<dim,T>::test_dualNumbers(){
+
+	std::cout << "\nTesting the dual numbers..." << std::endl;
+
+	typedef dealii::VectorizedArray<double> vdouble;
+	const unsigned int n_lanes = vdouble::n_array_elements;
+	int pass_counter = 0, total_checks = 0;
+	double error;
+
+	// Free energy of the coupled Cahn-Hilliard/Allen-Cahn application against its hand-written derivatives
+	vdouble c, n;
+	for (unsigned int v=0; v<n_lanes; v++){
+		c[v] = 0.05 + 0.2*v;
+		n[v] = 0.9 - 0.25*v;
+	}
+	autoDiff::dual2<2> c_d(c, 0), n_d(n, 1);
+	autoDiff::dual2<2> fa = -1.6704-4.776*c_d+5.1622*c_d*c_d-2.7375*pow(c_d,3)+1.3687*pow(c_d,4);
+	autoDiff::dual2<2> fb = 5.0*c_d*c_d-5.9746*c_d-1.5924;
+	autoDiff::dual2<2> h = 10.0*pow(n_d,3)-15.0*pow(n_d,4)+6.0*pow(n_d,5);
+	autoDiff::dual2<2> f = (1.0-h)*fa + h*fb;
+
+	error = 0.0;
+	for (unsigned int v=0; v<n_lanes; v++){
+		double cv = c[v], nv = n[v];
+		double faV = -1.6704-4.776*cv+5.1622*cv*cv-2.7375*cv*cv*cv+1.3687*cv*cv*cv*cv;
+		double facV = -4.776 + 10.3244*cv - 8.2125*cv*cv + 5.4748*cv*cv*cv;
+		double faccV = 10.3244-16.425*cv+16.4244*cv*cv;
+		double fbV = 5.0*cv*cv-5.9746*cv-1.5924;
+		double fbcV = 10.0*cv-5.9746;
+		double fbccV = 10.0;
+		double hV = 10.0*nv*nv*nv-15.0*nv*nv*nv*nv+6.0*nv*nv*nv*nv*nv;
+		double hnV = 30.0*nv*nv-60.0*nv*nv*nv+30.0*nv*nv*nv*nv;
+		double hnnV = 60.0*nv-180.0*nv*nv+120.0*nv*nv*nv;
+		error = std::max(error, std::abs(f.value[v] - ((1.0-hV)*faV+hV*fbV)));
+		error = std::max(error, std::abs(f.gradient(0)[v] - ((1.0-hV)*facV+hV*fbcV)));
+		error = std::max(error, std::abs(f.gradient(1)[v] - (fbV-faV)*hnV));
+		error = std::max(error, std::abs(f.hessian(0,0)[v] - ((1.0-hV)*faccV+hV*fbccV)));
+		error = std::max(error, std::abs(f.hessian(0,1)[v] - (fbcV-facV)*hnV));
+		error = std::max(error, std::abs(f.hessian(1,0)[v] - (fbcV-facV)*hnV));
+		error = std::max(error, std::abs(f.hessian(1,1)[v] - (fbV-faV)*hnnV));
+	}
+	std::cout << "  free energy, max. error of the derivatives: " << error << std::endl;
+	total_checks++;
+	if (error < 1.0e-12) {pass_counter++;}
+
+	// All the operations, against central finite differences
+	vdouble x, y;
+	for (unsigned int v=0; v<n_lanes; v++){
+		x[v] = 0.7 + 0.3*v;
+		y[v] = 1.3 - 0.2*v;
+	}
+	autoDiff::dual2<2> g = dualNumbersTestFunction(autoDiff::dual2<2>(x, 0), autoDiff::dual2<2>(y, 1));
+	autoDiff::dual<2> g1 = dualNumbersTestFunction(autoDiff::dual<2>(x, 0), autoDiff::dual<2>(y, 1));
+
+	const double step = 1.0e-4;
+	error = 0.0;
+	for (unsigned int v=0; v<n_lanes; v++){
+		auto g_ref = [&](double dx, double dy) -> double {
+			return dualNumbersTestFunction(x[v]+dx, y[v]+dy);
+		};
+		const double scale = 1.0 + std::abs(g.value[v]);
+		error = std::max(error, std::abs(g.value[v] - g_ref(0.0,0.0))/scale);
+		error = std::max(error, std::abs(g1.value[v] - g.value[v])/scale);
+		error = std::max(error, std::abs(g.gradient(0)[v] - (g_ref(step,0.0)-g_ref(-step,0.0))/(2.0*step))/scale);
+		error = std::max(error, std::abs(g.gradient(1)[v] - (g_ref(0.0,step)-g_ref(0.0,-step))/(2.0*step))/scale);
+		error = std::max(error, std::abs(g1.gradient(0)[v] - g.gradient(0)[v])/scale);
+		error = std::max(error, std::abs(g1.gradient(1)[v] - g.gradient(1)[v])/scale);
+		error = std::max(error, std::abs(g.hessian(0,0)[v] - (g_ref(step,0.0)-2.0*g_ref(0.0,0.0)+g_ref(-step,0.0))/(step*step))/scale);
+		error = std::max(error, std::abs(g.hessian(1,1)[v] - (g_ref(0.0,step)-2.0*g_ref(0.0,0.0)+g_ref(0.0,-step))/(step*step))/scale);
+		error = std::max(error, std::abs(g.hessian(0,1)[v] - (g_ref(step,step)-g_ref(step,-step)-g_ref(-step,step)+g_ref(-step,-step))/(4.0*step*step))/scale);
+	}
+	std::cout << "  exp, log, sqrt, pow and division, max. relative error against finite differences: " << error << std::endl;
+	total_checks++;
+	if (error < 1.0e-6) {pass_counter++;}
+
+	bool pass = (pass_counter == total_checks);
+	std::cout << "Test result for the dual numbers: " << pass << std::endl;
+
+	return pass;
+}
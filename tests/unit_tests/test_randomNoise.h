@@ -0,0 +1,111 @@
+// Unit test(s) for the counter-based random noise in "randomNoise.h"
+
+template <int dim, typename T>
+bool unitTest<dim,T>::test_randomNoise(){
+
+	std::cout << "\nTesting the random noise..." << std::endl;
+
+	typedef dealii::VectorizedArray<double> vdouble;
+	const unsigned int n_lanes = randomNoise::n_lanes;
+	int pass_counter = 0, total_checks = 0;
+
+	// Known answers of Philox4x32-10 (from the reference implementation, Random123)
+	const uint32_t known_counters[3][4] = {{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+			{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+	const uint32_t known_keys[3][2] = {{0x00000000, 0x00000000}, {0xffffffff, 0xffffffff}, {0xa4093822, 0x299f31d0}};
+	const uint32_t known_results[3][4] = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+			{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+	for (unsigned int i=0; i<3; i++){
+		uint32_t counter[4][1];
+		for (unsigned int w=0; w<4; w++){
+			counter[w][0] = known_counters[i][w];
+		}
+		randomNoise::philox4x32<1>(counter, known_keys[i][0], known_keys[i][1]);
+		total_checks++;
+		if ((counter[0][0] == known_results[i][0]) && (counter[1][0] == known_results[i][1])
+				&& (counter[2][0] == known_results[i][2]) && (counter[3][0] == known_results[i][3])){
+			pass_counter++;
+		}
+		else {
+			std::cout << "  Philox4x32-10 known answer " << i << " failed" << std::endl;
+		}
+	}
+
+	// The noise at a point doesn't depend on the lane of the point or on the other points of the batch, and changes
+	// with the step and the stream
+	const double resolution[2] = {1.0e-6, 1.0e-6};
+	dealii::Point<2,vdouble> points, shifted_points;
+	for (unsigned int v=0; v<n_lanes; v++){
+		points[0][v] = 0.25*v;
+		points[1][v] = 0.5;
+		shifted_points[0][v] = 0.25*((v+1)%n_lanes);
+		shifted_points[1][v] = 0.5;
+	}
+	const vdouble noise = randomNoise::gaussian<2>(points, resolution, 10, 0, 1);
+	const vdouble shifted_noise = randomNoise::gaussian<2>(shifted_points, resolution, 10, 0, 1);
+	const vdouble next_step_noise = randomNoise::gaussian<2>(points, resolution, 11, 0, 1);
+	const vdouble other_stream_noise = randomNoise::gaussian<2>(points, resolution, 10, 1, 1);
+	bool same = true, different = true;
+	for (unsigned int v=0; v<n_lanes; v++){
+		same = same && (shifted_noise[v] == noise[(v+1)%n_lanes]);
+		different = different && (next_step_noise[v] != noise[v]) && (other_stream_noise[v] != noise[v]);
+	}
+	std::cout << "  same noise for the same point in another lane: " << same << ", new noise for another step or stream: " << different << std::endl;
+	total_checks++;
+	if (same && different) {pass_counter++;}
+
+	// Moments of the noise on a grid of points
+	const unsigned int n_points = 400;
+	double mean = 0.0, variance = 0.0, fourth_moment = 0.0;
+	for (unsigned int i=0; i<n_points; i++){
+		for (unsigned int j=0; j<n_points; j+=n_lanes){
+			dealii::Point<2,vdouble> p;
+			for (unsigned int v=0; v<n_lanes; v++){
+				p[0][v] = (double)i/n_points;
+				p[1][v] = (double)(j+v)/n_points;
+			}
+			const vdouble x = randomNoise::gaussian<2>(p, resolution, 3, 0, 1);
+			for (unsigned int v=0; v<n_lanes; v++){
+				mean += x[v];
+				variance += x[v]*x[v];
+				fourth_moment += x[v]*x[v]*x[v]*x[v];
+			}
+		}
+	}
+	const double n_samples = (double)n_points*n_points;
+	mean /= n_samples;
+	variance = variance/n_samples - mean*mean;
+	fourth_moment /= n_samples;
+	std::cout << "  mean: " << mean << ", variance: " << variance << ", fourth moment: " << fourth_moment << " (" << n_samples << " samples)" << std::endl;
+	total_checks++;
+	if ((std::abs(mean) < 0.02) && (std::abs(variance-1.0) < 0.02) && (std::abs(fourth_moment-3.0) < 0.1)) {pass_counter++;}
+
+	// Noise of the DOFs: the same for the same DOF, new for another DOF (also in the high word of the index), step or
+	// stream, and with the moments of a standard normal distribution
+	const double dof_noise = randomNoise::gaussianDof(12345, 10, 0, 1);
+	bool dof_same = (randomNoise::gaussianDof(12345, 10, 0, 1) == dof_noise);
+	bool dof_different = (randomNoise::gaussianDof(12346, 10, 0, 1) != dof_noise) && (randomNoise::gaussianDof(12345, 11, 0, 1) != dof_noise)
+			&& (randomNoise::gaussianDof(12345, 10, 1, 1) != dof_noise);
+	if (sizeof(dealii::types::global_dof_index) > 4){
+		const dealii::types::global_dof_index high_word = (dealii::types::global_dof_index)1 << (4*sizeof(dealii::types::global_dof_index));
+		dof_different = dof_different && (randomNoise::gaussianDof(12345+high_word, 10, 0, 1) != dof_noise);
+	}
+	double dof_mean = 0.0, dof_variance = 0.0;
+	const unsigned int n_dofs = 160000;
+	for (unsigned int dof=0; dof<n_dofs; dof++){
+		const double x = randomNoise::gaussianDof(dof, 3, 0, 1);
+		dof_mean += x;
+		dof_variance += x*x;
+	}
+	dof_mean /= n_dofs;
+	dof_variance = dof_variance/n_dofs - dof_mean*dof_mean;
+	std::cout << "  noise of the DOFs: same for the same DOF: " << dof_same << ", new for another DOF, step or stream: " << dof_different
+			<< ", mean: " << dof_mean << ", variance: " << dof_variance << std::endl;
+	total_checks++;
+	if (dof_same && dof_different && (std::abs(dof_mean) < 0.02) && (std::abs(dof_variance-1.0) < 0.02)) {pass_counter++;}
+
+	bool pass = (pass_counter == total_checks);
+	std::cout << "Test result for the random noise: " << pass << std::endl;
+
+	return pass;
+}
@@ -0,0 +1,107 @@
+// Unit test(s) for the recovered Hessians (see recoveredHessians): the lumped mass matrix of "computeLumpedInvM" for
+// fields of several degrees, used for the L2 projections of the derivatives of a quadratic field
+
+// Quadratic field u = x^2 + 3xy + 2y^2 (Hessian {{2,3},{3,4}})
+template <int dim>
+class quadraticField : public Function<dim>
+{
+ public:
+  double value (const Point<dim> &p, const unsigned int component = 0) const {
+	  return p[0]*p[0] + 3.0*p[0]*p[1] + 2.0*p[1]*p[1];
+  }
+};
+
+template <int dim, typename T>
+bool unitTest<dim,T>::test_recoveredHessian(){
+
+	std::cout << "\nTesting the recovered Hessian of a quadratic field..." << std::endl;
+
+	const double exact_hessian[2][2] = {{2.0, 3.0}, {3.0, 4.0}};
+	int pass_counter = 0, total_checks = 0;
+
+	parallel::distributed::Triangulation<2> triangulation (MPI_COMM_WORLD);
+	GridGenerator::subdivided_hyper_cube (triangulation, 8, 0.0, 1.0);
+
+	// Fields of degree 1 and 2 (a field of a lower degree than finiteElementDegree gets the lumped mass matrix of its degree)
+	for (unsigned int degree=1; degree<=2; degree++){
+		FESystem<2> fe (FE_Q<2>(QGaussLobatto<1>(degree+1)),1);
+		DoFHandler<2> dof_handler (triangulation);
+		dof_handler.distribute_dofs (fe);
+		IndexSet locally_relevant_dofs;
+		DoFTools::extract_locally_relevant_dofs (dof_handler, locally_relevant_dofs);
+		ConstraintMatrix constraints;
+		constraints.reinit (locally_relevant_dofs);
+		DoFTools::make_hanging_node_constraints (dof_handler, constraints);
+		constraints.close ();
+
+		vectorType u, invM, recovered[2];
+		u.reinit (dof_handler.locally_owned_dofs(), locally_relevant_dofs, MPI_COMM_WORLD);
+		invM.reinit (u);
+		VectorTools::interpolate (dof_handler, quadraticField<2>(), u);
+		u.update_ghost_values ();
+
+		computeLumpedInvM<2>(dof_handler, constraints, invM);
+
+		// L2 projections of the derivatives: the integrals of the test functions times the derivatives, times the inverse lumped mass matrix
+		QGauss<2> quadrature (degree+1);
+		FEValues<2> fe_values (fe, quadrature, update_values | update_gradients | update_JxW_values);
+		std::vector<Tensor<1,2> > gradients (quadrature.size());
+		Vector<double> cell_rhs (fe.dofs_per_cell);
+		std::vector<types::global_dof_index> local_dof_indices (fe.dofs_per_cell);
+		for (unsigned int d=0; d<2; d++){
+			recovered[d].reinit (u);
+			recovered[d] = 0.0;
+			typename DoFHandler<2>::active_cell_iterator cell=dof_handler.begin_active(), endc=dof_handler.end();
+			for (; cell!=endc; ++cell){
+				if (cell->is_locally_owned()){
+					fe_values.reinit (cell);
+					fe_values.get_function_gradients (u, gradients);
+					for (unsigned int i=0; i<fe.dofs_per_cell; i++){
+						cell_rhs(i) = 0.0;
+						for (unsigned int q=0; q<quadrature.size(); q++){
+							cell_rhs(i) += fe_values.shape_value(i,q)*gradients[q][d]*fe_values.JxW(q);
+						}
+					}
+					cell->get_dof_indices (local_dof_indices);
+					constraints.distribute_local_to_global (cell_rhs, local_dof_indices, recovered[d]);
+				}
+			}
+			recovered[d].compress (VectorOperation::add);
+			recovered[d].scale (invM);
+			constraints.distribute (recovered[d]);
+			recovered[d].update_ghost_values ();
+		}
+
+		// Recovered Hessian (the symmetrized gradient of the projections) at the centers of the cells away from the boundary,
+		// where the projections of degree 1 are exact (for degree 2, they are exact everywhere)
+		QGauss<2> center (1);
+		FEValues<2> fe_values_center (fe, center, update_gradients | update_quadrature_points);
+		std::vector<Tensor<1,2> > recovered_gradients[2];
+		double max_error = 0.0;
+		typename DoFHandler<2>::active_cell_iterator cell=dof_handler.begin_active(), endc=dof_handler.end();
+		for (; cell!=endc; ++cell){
+			if (cell->is_locally_owned() && !cell->at_boundary()){
+				fe_values_center.reinit (cell);
+				for (unsigned int d=0; d<2; d++){
+					recovered_gradients[d].resize (1);
+					fe_values_center.get_function_gradients (recovered[d], recovered_gradients[d]);
+				}
+				for (unsigned int d=0; d<2; d++){
+					for (unsigned int e=0; e<2; e++){
+						const double hessian = 0.5*(recovered_gradients[d][0][e] + recovered_gradients[e][0][d]);
+						max_error = std::max(max_error, std::abs(hessian - exact_hessian[d][e]));
+					}
+				}
+			}
+		}
+		max_error = Utilities::MPI::max (max_error, MPI_COMM_WORLD);
+		std::cout << "  degree " << degree << ": largest error of the recovered Hessian " << max_error << std::endl;
+		total_checks++;
+		if (max_error < 1.0e-10) {pass_counter++;}
+	}
+
+	bool pass = (pass_counter == total_checks);
+	std::cout << "Test result for the recovered Hessian: " << pass << std::endl;
+
+	return pass;
+}
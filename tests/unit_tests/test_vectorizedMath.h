@@ -0,0 +1,139 @@
+// Unit test(s) for the vectorized math functions in "vectorizedMath.h"
+
+// Maximum relative error of a vectorized function against the std:: function, over n_points
+// arguments spread evenly over [x_min,x_max] (or logarithmically, for log_spacing)
+template <typename VectorizedFunction, typename ScalarFunction>
+double vectorizedMathError(VectorizedFunction f, ScalarFunction f_ref, double x_min, double x_max, bool log_spacing){
+	const unsigned int n_lanes = dealii::VectorizedArray<double>::n_array_elements;
+	const unsigned int n_points = 10000;
+	double max_error = 0.0;
+	for (unsigned int i=0; i<n_points; i+=n_lanes){
+		dealii::VectorizedArray<double> x;
+		for (unsigned int v=0; v<n_lanes; v++){
+			double t = x_min + (x_max-x_min)*(i+v)/(n_points-1);
+			x[v] = log_spacing ? std::exp(t) : t;
+		}
+		dealii::VectorizedArray<double> y = f(x);
+		for (unsigned int v=0; v<n_lanes; v++){
+			double y_ref = f_ref(x[v]);
+			double error = std::abs(y[v]-y_ref);
+			if (y_ref != 0.0){
+				error /= std::abs(y_ref);
+			}
+			max_error = std::max(max_error, error);
+		}
+	}
+	return max_error;
+}
+
+template <int dim, typename T>
+bool unitTest<dim,T>::test_vectorizedMath(){
+
+	std::cout << "\nTesting the vectorized math functions..." << std::endl;
+
+	typedef dealii::VectorizedArray<double> vdouble;
+	const double tol_double = 1.0e-13;
+	const double tol_single = 1.0e-6;
+	int pass_counter = 0, total_checks = 0;
+	double error;
+	char buffer[100];
+
+	#define checkVectorizedMath(name, f, f_ref, x_min, x_max, log_spacing, tol) \
+		error = vectorizedMathError(f, f_ref, x_min, x_max, log_spacing); \
+		sprintf(buffer, "  %-22s max. relative error: %10.3e\n", name, error); \
+		std::cout << buffer; \
+		total_checks++; \
+		if (error < tol) {pass_counter++;}
+
+	checkVectorizedMath("exp", [](const vdouble &x){return vectorizedMath::exp(x);}, [](double x){return std::exp(x);}, -700.0, 700.0, false, tol_double);
+	checkVectorizedMath("exp (single)", [](const vdouble &x){return vectorizedMath::exp<vectorizedMath::SINGLE_ACCURACY>(x);}, [](double x){return std::exp(x);}, -700.0, 700.0, false, tol_single);
+	checkVectorizedMath("expm1", [](const vdouble &x){return vectorizedMath::expm1(x);}, [](double x){return std::expm1(x);}, -1.0, 1.0, false, tol_double);
+	checkVectorizedMath("log", [](const vdouble &x){return vectorizedMath::log(x);}, [](double x){return std::log(x);}, -700.0, 700.0, true, tol_double);
+	checkVectorizedMath("log (single)", [](const vdouble &x){return vectorizedMath::log<vectorizedMath::SINGLE_ACCURACY>(x);}, [](double x){return std::log(x);}, -700.0, 700.0, true, tol_single);
+	checkVectorizedMath("log (near 1)", [](const vdouble &x){return vectorizedMath::log(x);}, [](double x){return std::log(x);}, 0.5, 1.5, false, tol_double);
+	checkVectorizedMath("tanh", [](const vdouble &x){return vectorizedMath::tanh(x);}, [](double x){return std::tanh(x);}, -20.0, 20.0, false, tol_double);
+	checkVectorizedMath("tanh (near 0)", [](const vdouble &x){return vectorizedMath::tanh(x);}, [](double x){return std::tanh(x);}, -1.0e-4, 1.0e-4, false, tol_double);
+	checkVectorizedMath("tanh (single)", [](const vdouble &x){return vectorizedMath::tanh<vectorizedMath::SINGLE_ACCURACY>(x);}, [](double x){return std::tanh(x);}, -20.0, 20.0, false, tol_single);
+	checkVectorizedMath("pow", [](const vdouble &x){return vectorizedMath::pow(x, 2.7);}, [](double x){return std::pow(x, 2.7);}, -50.0, 50.0, true, tol_double);
+	checkVectorizedMath("invsqrt", [](const vdouble &x){return vectorizedMath::invsqrt(x);}, [](double x){return 1.0/std::sqrt(x);}, -600.0, 600.0, true, tol_double);
+	checkVectorizedMath("invsqrt (single)", [](const vdouble &x){return vectorizedMath::invsqrt<vectorizedMath::SINGLE_ACCURACY>(x);}, [](double x){return 1.0/std::sqrt(x);}, -600.0, 600.0, true, tol_single);
+
+	#undef checkVectorizedMath
+
+	// Limits
+	vdouble zero;
+	zero = 0.0;
+	total_checks++;
+	if ((vectorizedMath::exp(zero-800.0)[0] == 0.0) && (vectorizedMath::exp(zero+800.0)[0] == std::numeric_limits<double>::infinity())
+			&& (vectorizedMath::log(zero)[0] == -std::numeric_limits<double>::infinity()) && (vectorizedMath::tanh(zero)[0] == 0.0)){
+		pass_counter++;
+	}
+
+	bool pass = (pass_counter == total_checks);
+	std::cout << "Test result for the vectorized math functions: " << pass << std::endl;
+
+	return pass;
+}
+
+// Microbenchmark of the vectorized math functions against the std:: overloads for VectorizedArray
+// (which call the scalar functions lane by lane)
+template <typename VectorizedFunction>
+double vectorizedMathTiming(VectorizedFunction f, const std::vector<dealii::VectorizedArray<double> > &x, double &checksum){
+	const unsigned int n_repeats = 200;
+	dealii::Timer timer;
+	timer.start();
+	dealii::VectorizedArray<double> sum;
+	sum = 0.0;
+	for (unsigned int r=0; r<n_repeats; r++){
+		for (unsigned int i=0; i<x.size(); i++){
+			sum = sum + f(x[i]);
+		}
+	}
+	timer.stop();
+	// The checksum keeps the compiler from removing the loops
+	checksum += sum[0];
+	return timer.wall_time();
+}
+
+template <int dim, typename T>
+void unitTest<dim,T>::benchmark_vectorizedMath(){
+
+	std::cout << "\nTiming the vectorized math functions against the std:: functions..." << std::endl;
+
+	typedef dealii::VectorizedArray<double> vdouble;
+	const unsigned int n_lanes = vdouble::n_array_elements;
+
+	// Arguments in (0.1,2.1), in the range of typical order parameters and concentrations
+	std::vector<vdouble> x(10000);
+	for (unsigned int i=0; i<x.size(); i++){
+		for (unsigned int v=0; v<n_lanes; v++){
+			x[i][v] = 0.1 + 2.0*((i*n_lanes+v)%1000)/1000.0;
+		}
+	}
+
+	double checksum = 0.0;
+	char buffer[150];
+
+	#define timeVectorizedMath(name, f, f_ref) \
+		{ \
+		double time_ref = vectorizedMathTiming(f_ref, x, checksum); \
+		double time = vectorizedMathTiming(f, x, checksum); \
+		sprintf(buffer, "  %-18s std:: %8.4f s, vectorizedMath:: %8.4f s, speedup: %5.2f\n", name, time_ref, time, time_ref/time); \
+		std::cout << buffer; \
+		}
+
+	timeVectorizedMath("exp", [](const vdouble &x){return vectorizedMath::exp(x);}, [](const vdouble &x){return std::exp(x);});
+	timeVectorizedMath("exp (single)", [](const vdouble &x){return vectorizedMath::exp<vectorizedMath::SINGLE_ACCURACY>(x);}, [](const vdouble &x){return std::exp(x);});
+	timeVectorizedMath("log", [](const vdouble &x){return vectorizedMath::log(x);}, [](const vdouble &x){return std::log(x);});
+	timeVectorizedMath("log (single)", [](const vdouble &x){return vectorizedMath::log<vectorizedMath::SINGLE_ACCURACY>(x);}, [](const vdouble &x){return std::log(x);});
+	timeVectorizedMath("tanh", [](const vdouble &x){return vectorizedMath::tanh(x);}, [](const vdouble &x){
+		vdouble y;
+		for (unsigned int v=0; v<vdouble::n_array_elements; v++){y[v] = std::tanh(x[v]);}
+		return y;});
+	timeVectorizedMath("pow", [](const vdouble &x){return vectorizedMath::pow(x, 2.7);}, [](const vdouble &x){return std::pow(x, 2.7);});
+	timeVectorizedMath("invsqrt (single)", [](const vdouble &x){return vectorizedMath::invsqrt<vectorizedMath::SINGLE_ACCURACY>(x);}, [](const vdouble &x){return 1.0/std::sqrt(x);});
+
+	#undef timeVectorizedMath
+
+	std::cout << "  (checksum " << checksum << ")" << std::endl;
+}
@@ -28,8 +28,15 @@ class unitTest
   bool test_computeStress();
   void assignCIJSize(dealii::VectorizedArray<double> CIJ[2*dim-1+dim/3][2*dim-1+dim/3]);
   void assignCIJSize(dealii::Table<2, double> &CIJ);
+  bool test_computeStressSymmetric();
   bool test_getRHS();
   bool test_computeRHS();
+  bool test_vectorizedMath();
+  void benchmark_vectorizedMath();
+  bool test_dualNumbers();
+  bool test_randomNoise();
+  bool test_activeSelection();
+  bool test_recoveredHessian();
 };
 
 
@@ -37,4 +44,9 @@ class unitTest
 #include "test_outputResults.h"
 #include "test_computeStress.h"
 #include "test_getRHS.h"
+#include "test_vectorizedMath.h"
+#include "test_dualNumbers.h"
+#include "test_randomNoise.h"
+#include "test_activeSelection.h"
+#include "test_recoveredHessian.h"
 //#include "test_computeRHS.h"